@@ -91,8 +91,19 @@ typedef void ** PPvoid_t;
 
 #ifndef _WORD_T
 #define _WORD_T
+#ifdef _WIN64   // LLP64:  long stays 32 bits, so spell out the 64-bit word.
+typedef unsigned long long Word_t, * PWord_t;
+#else
 typedef unsigned long    Word_t, * PWord_t;  // expect 32-bit or 64-bit words.
 #endif
+#endif
+
+// Select the 64-bit layout and tables whenever Word_t is 64 bits; the build
+// may also define JU_64BIT explicitly.
+
+#if !defined(JU_64BIT) && (defined(_WIN64) || defined(__LP64__))
+#define JU_64BIT
+#endif
 
 #ifndef NULL
 #define NULL 0
@@ -148,6 +159,15 @@ typedef enum            // uint8_t -- but C does not support this type of enum.
         JU_ERRNO_NOTJUDYSL      = 7,    // PArray is not to a JudySL array.
         JU_ERRNO_UNSORTED       = 12,   // see above.
 
+// Problems with a JudyLSave() or JudyLLoad() stream:
+//
+// JU_ERRNO_IO means the callers write function did not accept every byte.
+// JU_ERRNO_BADSTREAM means the stream passed to JudyLLoad() was not written by
+// JudyLSave() for this word size, or was cut short.
+
+        JU_ERRNO_IO             = 13,
+        JU_ERRNO_BADSTREAM      = 14,
+
 // Errors below this point are not recoverable; further tries to access the
 // Judy array might result in EFAULT and a core dump:
 //
@@ -201,8 +221,8 @@ typedef struct J_UDY_ERROR_STRUCT
 // warning.
 
 #define   JERR (-1)                     /* functions returning int or Word_t */
-#define  PJERR ((Pvoid_t)  (~0UL))      /* mainly for use here, see below    */
-#define PPJERR ((PPvoid_t) (~0UL))      /* functions that return PPvoid_t    */
+#define  PJERR ((Pvoid_t)  (~(Word_t) 0))      /* mainly for use here, see below    */
+#define PPJERR ((PPvoid_t) (~(Word_t) 0))      /* functions that return PPvoid_t    */
 
 // Convenience macro for when detailed error information (PJError_t) is not
 // desired by the caller; a purposely short name:
@@ -257,6 +277,9 @@ extern Word_t   JudyLCount(      Pcvoid_t  PArray, Word_t    Index1,
 extern PPvoid_t JudyLByCount(    Pcvoid_t  PArray, Word_t    Count,
                                                    Word_t *  PIndex, P_JE);
 extern Word_t   JudyLFreeArray(  PPvoid_t PPArray,                   P_JE);
+extern Word_t   JudyLFreeArrayAsync(   PPvoid_t PPArray, Word_t Threads, P_JE);
+extern Word_t   JudyLFreeArrayParallel(PPvoid_t PPArray, Word_t Threads, P_JE);
+extern void     JudyLFreeArrayWait(void);
 extern Word_t   JudyLMemUsed(    Pcvoid_t  PArray);
 extern Word_t   JudyLMemActive(  Pcvoid_t  PArray);
 extern PPvoid_t JudyLFirst(      Pcvoid_t  PArray, Word_t * PIndex,  P_JE);
@@ -268,6 +291,66 @@ extern int      JudyLNextEmpty(  Pcvoid_t  PArray, Word_t * PIndex,  P_JE);
 extern int      JudyLLastEmpty(  Pcvoid_t  PArray, Word_t * PIndex,  P_JE);
 extern int      JudyLPrevEmpty(  Pcvoid_t  PArray, Word_t * PIndex,  P_JE);
 
+// JudyL cursor:  remembers the path to the last Index returned, so that
+// stepping to its neighbour need not descend again from the root.  The path
+// is discarded automatically when the array is modified.  Treat the fields as
+// private; a zero-filled cursor is the same as one passed to JudyLCursorInit().
+
+#define cJLC_MAXDEPTH 8                 // branch levels in a 64-bit array.
+
+typedef struct J_UDYL_CURSOR
+{
+        Pcvoid_t jlc_PArray;            // array the path belongs to, or NULL.
+        Word_t   jlc_ModCount;          // jpm_ModCount when path was taken.
+        Word_t   jlc_Index;             // Index last returned.
+        int      jlc_Depth;             // branches in jlc_PjpHist[].
+        Pvoid_t  jlc_PjpHist[cJLC_MAXDEPTH]; // branch JPs, root first.
+        int      jlc_OffHist[cJLC_MAXDEPTH]; // offset or digit in each.
+        Pvoid_t  jlc_PjpLeaf;           // leaf or immediate JP, NULL if LEAFW.
+        int      jlc_Offset;            // offset or digit in the leaf.
+} JudyLCursor_t, * PJudyLCursor_t;
+
+extern void     JudyLCursorInit( PJudyLCursor_t PCursor);
+extern PPvoid_t JudyLCursorFirst(PJudyLCursor_t PCursor, Pcvoid_t PArray,
+                                                   Word_t * PIndex,  P_JE);
+extern PPvoid_t JudyLCursorNext( PJudyLCursor_t PCursor, Pcvoid_t PArray,
+                                                   Word_t * PIndex,  P_JE);
+extern PPvoid_t JudyLCursorLast( PJudyLCursor_t PCursor, Pcvoid_t PArray,
+                                                   Word_t * PIndex,  P_JE);
+extern PPvoid_t JudyLCursorPrev( PJudyLCursor_t PCursor, Pcvoid_t PArray,
+                                                   Word_t * PIndex,  P_JE);
+
+// JudyL serialization:  JudyLSave() passes the array to Write in key order, as
+// a compact stream of delta-encoded keys and values, and returns the number of
+// bytes written.  JudyLLoad() rebuilds an array from such a stream into an
+// empty *PPArray, and returns its population.  Write must return the number of
+// bytes it accepted; Read returns the number of bytes it read, 0 at the end.
+
+typedef Word_t (*JudyLWrite_t)(const void * PBuf, Word_t Bytes, void * PContext);
+typedef Word_t (*JudyLRead_t)(void * PBuf, Word_t Bytes, void * PContext);
+
+extern Word_t   JudyLSave(       Pcvoid_t  PArray, JudyLWrite_t Write,
+                                                   void * PContext,  P_JE);
+extern Word_t   JudyLLoad(       PPvoid_t PPArray, JudyLRead_t Read,
+                                                   void * PContext,  P_JE);
+
+// JudyL lookup path:  JudyLPath() records the memory JudyLGet() reads to find
+// Index, one entry per node, root first, and returns the number of entries.
+// Meant for benchmarks which flush a lookup's cache lines, or check how many
+// of them are still cached.
+
+#define cJLP_MAXNODES 24                // JPM, 2 per bitmap branch, 2 for leaf.
+
+typedef struct J_UDYL_PATH
+{
+        Word_t   jlp_Count;                     // nodes recorded.
+        Pcvoid_t jlp_Addr [cJLP_MAXNODES];      // first byte read in each.
+        Word_t   jlp_Bytes[cJLP_MAXNODES];      // bytes read from there on.
+} JudyLPath_t, * PJudyLPath_t;
+
+extern Word_t   JudyLPath(       Pcvoid_t  PArray, Word_t Index,
+                                                   PJudyLPath_t PPath);
+
 // ****************************************************************************
 // JUDYSL FUNCTIONS:
 
@@ -299,6 +382,15 @@ extern const char *JudyLMallocSizes;
 #if INTEGER_MAP_USE_DLMALLOC
 void* dlmalloc(size_t);
 void  dlfree(void*);
+#endif
+
+#if INTEGER_MAP_JUDY_SLAB_ALLOCATOR
+// Size-class slab allocator in JudyMalloc.c, backed by dlmalloc or malloc:
+extern Word_t JudyMalloc(Word_t);               // words reqd => words allocd.
+extern Word_t JudyMallocVirtual(Word_t);        // words reqd => words allocd.
+extern void   JudyFree(Pvoid_t, Word_t);        // free, size in words.
+extern void   JudyFreeVirtual(Pvoid_t, Word_t); // free, size in words.
+#elif INTEGER_MAP_USE_DLMALLOC
 void* dlmemalign(size_t, size_t);
 #define JudyMalloc(size) dlmalloc((size) * sizeof(Word_t))
 #define JudyMallocVirtual(size) dlmalloc((size) * sizeof(Word_t))
@@ -599,10 +691,32 @@ extern void   JudyFreeVirtual(Pvoid_t, Word_t); // free, size in words.
         J_2C(Rc,    PArray,   Index1,  Index2, JudyLCount,   "JudyLCount")
 #define JLBC(PV,    PArray,   Count,   Index)                           \
         J_2P(PV,    PArray,   Count, &(Index), JudyLByCount, "JudyLByCount")
+#define JLCF(PV,    Cursor,   PArray,  Index)                           \
+        J_2P(PV, (&(Cursor)), PArray, &(Index), JudyLCursorFirst,       \
+                                                  "JudyLCursorFirst")
+#define JLCN(PV,    Cursor,   PArray,  Index)                           \
+        J_2P(PV, (&(Cursor)), PArray, &(Index), JudyLCursorNext,        \
+                                                  "JudyLCursorNext")
+#define JLCL(PV,    Cursor,   PArray,  Index)                           \
+        J_2P(PV, (&(Cursor)), PArray, &(Index), JudyLCursorLast,        \
+                                                  "JudyLCursorLast")
+#define JLCP(PV,    Cursor,   PArray,  Index)                           \
+        J_2P(PV, (&(Cursor)), PArray, &(Index), JudyLCursorPrev,        \
+                                                  "JudyLCursorPrev")
 #define JLFA(Rc,    PArray)                                             \
         J_0I(Rc, (&(PArray)), JudyLFreeArray, "JudyLFreeArray")
+#define JLFAA(Rc,   PArray,   Threads)                                  \
+        J_1I(Rc, (&(PArray)), Threads, JudyLFreeArrayAsync,             \
+                                                  "JudyLFreeArrayAsync")
+#define JLFAP(Rc,   PArray,   Threads)                                  \
+        J_1I(Rc, (&(PArray)), Threads, JudyLFreeArrayParallel,          \
+                                                  "JudyLFreeArrayParallel")
 #define JLMU(Rc,    PArray)                                             \
         (Rc) = JudyLMemUsed(PArray)
+#define JLSV(Rc,    PArray,   Write,   Context)                         \
+        J_2I(Rc,    PArray,   Write, Context, JudyLSave, "JudyLSave")
+#define JLLD(Rc,    PArray,   Read,    Context)                         \
+        J_2I(Rc, (&(PArray)), Read, Context, JudyLLoad, "JudyLLoad")
 
 #define JHSI(PV,    PArray,   PIndex,   Count)                          \
         J_2P(PV, (&(PArray)), PIndex,   Count, JudyHSIns, "JudyHSIns")
@@ -29,7 +29,175 @@
 // JUDY INCLUDE FILES
 #include "Judy.h"
 
-#if !INTEGER_MAP_USE_DLMALLOC
+#if INTEGER_MAP_JUDY_SLAB_ALLOCATOR
+
+// ****************************************************************************
+// J U D Y   S L A B   A L L O C A T O R
+//
+// Judy allocates a small, fixed set of object sizes, in words (see the
+// *PopToWords tables in JudyLTables.c), and JudyFree() is always told the size
+// of the object being freed.  So objects up to cJU_SLABMAXWORDS words are
+// carved out of cJU_SLABBYTES pages with one free list per exact word count,
+// and need no per-object header.  Larger objects (uncompressed branches, the
+// JPM) go straight to the backing allocator.
+//
+// Pages come from dlmalloc when INTEGER_MAP_USE_DLMALLOC is set, so they show
+// up in the MEMORY experiment, otherwise from malloc().  They are kept on the
+// free lists as objects are freed, and all of them are handed back once the
+// last slab object is freed (typically by JudyLFreeArray()).
+//
+// Note:  Objects are only word-aligned.  Not thread-safe.
+
+#if !INTEGER_MAP_JUDY_FREE_METHOD(SYNC)
+#error:  The slab allocator is not thread-safe; use INTEGER_MAP_JUDY_FREE_METHOD SYNC.
+#endif
+
+#if INTEGER_MAP_USE_DLMALLOC
+#define SLAB_BACKING_MALLOC(Bytes) dlmalloc(Bytes)
+#define SLAB_BACKING_FREE(Ptr)     dlfree(Ptr)
+#else
+#define SLAB_BACKING_MALLOC(Bytes) malloc(Bytes)
+#define SLAB_BACKING_FREE(Ptr)     free(Ptr)
+#endif
+
+#define cJU_SLABMAXWORDS 64
+#define cJU_SLABBYTES    4096
+
+// Each page starts with a link to the next page, so they can all be released:
+
+typedef struct J__UDY_SLAB_PAGE
+{
+        struct J__UDY_SLAB_PAGE * jsp_Next;
+} jsp_t, * Pjsp_t;
+
+static Pvoid_t j__uSlabFreeList[cJU_SLABMAXWORDS + 1]; // by object words.
+static Pjsp_t  j__uSlabPages = (Pjsp_t) NULL;          // all pages.
+static Word_t  j__uSlabLiveObjects = 0;                // allocated, not freed.
+
+
+// ****************************************************************************
+// __ J U D Y   S L A B   R E F I L L
+//
+// Allocate a page and thread all of its Words-sized objects onto the free
+// list.  Return 0 if out of memory.
+
+static int j__udySlabRefill(
+	Word_t Words)
+{
+	Word_t  Bytes = Words * sizeof(Word_t);
+	Pjsp_t  Page;
+	uint8_t *Obj;
+	uint8_t *End;
+
+	Page = (Pjsp_t) SLAB_BACKING_MALLOC(cJU_SLABBYTES);
+	if (Page == (Pjsp_t) NULL) return(0);
+
+	Page->jsp_Next = j__uSlabPages;
+	j__uSlabPages  = Page;
+
+	Obj = (uint8_t *) (Page + 1);
+	End = (uint8_t *) Page + cJU_SLABBYTES - Bytes;
+
+	for (; Obj <= End; Obj += Bytes)
+	{
+	    *(Pvoid_t *) Obj = j__uSlabFreeList[Words];
+	    j__uSlabFreeList[Words] = (Pvoid_t) Obj;
+	}
+	return(1);
+
+} // j__udySlabRefill()
+
+
+// ****************************************************************************
+// __ J U D Y   S L A B   R E L E A S E
+//
+// Hand every page back to the backing allocator.  Only valid when no slab
+// objects are live.
+
+static void j__udySlabRelease(void)
+{
+	Word_t Words;
+
+	while (j__uSlabPages != (Pjsp_t) NULL)
+	{
+	    Pjsp_t Next = j__uSlabPages->jsp_Next;
+	    SLAB_BACKING_FREE(j__uSlabPages);
+	    j__uSlabPages = Next;
+	}
+	for (Words = 0; Words <= cJU_SLABMAXWORDS; ++Words)
+	    j__uSlabFreeList[Words] = (Pvoid_t) NULL;
+
+} // j__udySlabRelease()
+
+
+// ****************************************************************************
+// J U D Y   M A L L O C
+
+Word_t JudyMalloc(
+	Word_t Words)
+{
+	Pvoid_t Obj;
+
+	if (Words > cJU_SLABMAXWORDS)
+	    return((Word_t) SLAB_BACKING_MALLOC(Words * sizeof(Word_t)));
+
+	if (j__uSlabFreeList[Words] == (Pvoid_t) NULL)
+	{
+	    if (! j__udySlabRefill(Words)) return(0);
+	}
+
+	Obj = j__uSlabFreeList[Words];
+	j__uSlabFreeList[Words] = *(Pvoid_t *) Obj;
+	++j__uSlabLiveObjects;
+	return((Word_t) Obj);
+
+} // JudyMalloc()
+
+
+// ****************************************************************************
+// J U D Y   F R E E
+
+void JudyFree(
+	void * PWord,
+	Word_t Words)
+{
+	if (Words > cJU_SLABMAXWORDS)
+	{
+	    SLAB_BACKING_FREE(PWord);
+	    return;
+	}
+
+	*(Pvoid_t *) PWord = j__uSlabFreeList[Words];
+	j__uSlabFreeList[Words] = (Pvoid_t) PWord;
+
+	if (--j__uSlabLiveObjects == 0) j__udySlabRelease();
+
+} // JudyFree()
+
+
+// ****************************************************************************
+// J U D Y   M A L L O C   V I R T U A L
+
+Word_t JudyMallocVirtual(
+	Word_t Words)
+{
+	return(JudyMalloc(Words));
+
+} // JudyMallocVirtual()
+
+
+// ****************************************************************************
+// J U D Y   F R E E   V I R T U A L
+
+void JudyFreeVirtual(
+	void * PWord,
+	Word_t Words)
+{
+        JudyFree(PWord, Words);
+
+} // JudyFreeVirtual()
+
+#elif !INTEGER_MAP_USE_DLMALLOC
 
 // ****************************************************************************
 // J U D Y   M A L L O C
@@ -88,4 +256,4 @@ void JudyFreeVirtual(
 
 } // JudyFreeVirtual()
 
-#endif // INTEGER_MAP_USE_DLMALLOC_FOR_JUDY
\ No newline at end of file
+#endif // INTEGER_MAP_JUDY_SLAB_ALLOCATOR
\ No newline at end of file
@@ -371,6 +371,7 @@ typedef struct J_UDYL_POPULATION_AND_MEMORY
 /* 8 */ char       je_Errno;            // one of the enums in Judy.h.
 /* 8/9  */ int     je_ErrID;            // often an internal source line number.
 /* 9/10 */ Word_t  jpm_TotalMemWords;   // words allocated in array.
+/* 10/11 */ Word_t jpm_ModCount;        // bumped by each insert or delete.
 } jLpm_t, *PjLpm_t;
 
 
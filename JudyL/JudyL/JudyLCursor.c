@@ -0,0 +1,840 @@
+// @(#) JudyLCursor.c
+//
+// JudyLCursorFirst(), JudyLCursorNext(), JudyLCursorLast() and
+// JudyLCursorPrev():  the same results as JudyLFirst(), JudyLNext(),
+// JudyLLast() and JudyLPrev(), but the caller passes a JudyLCursor_t which
+// remembers the path to the Index last returned.
+//
+// JudyLNext() and JudyLPrev() start again from the root pointer on every
+// call, so a full scan of an array costs one complete descent per Index.  A
+// cursor instead keeps the stack of branch JPs it walked through, with the
+// offset taken in each, plus the leaf or immediate JP that holds the current
+// Index.  Stepping to the neighbouring Index usually just moves within that
+// leaf; at the end of the leaf, the cursor backs up only as far as the
+// nearest branch which has another JP in the scan direction.
+//
+// The path is only trusted while the array is unmodified.  Every insert and
+// delete of an Index bumps jpm_ModCount in the JPM, and the cursor compares
+// it with the count saved when the path was taken.  Root-level LEAFW arrays
+// have no JPM, but they also have no path to lose:  the cursor just checks
+// that the saved offset in the leaf still holds the Index last returned.
+// Whenever the cursor is stale, or the caller passes some other Index, the
+// call falls back to the regular JudyL*() function and then takes a fresh
+// path to its result.
+//
+// A cursor may be shared between arrays (it notices PArray changing), and a
+// zero-filled cursor is the same as one passed to JudyLCursorInit().
+
+#define JUDYL
+
+#include "JudyL.h"
+
+#include "JudyPrivate1L.h"
+
+
+// ****************************************************************************
+// JP TYPE CLASSIFICATION
+//
+// These rely on each group of JP types being in sequential order; see the
+// enum in JudyL.h.
+
+#define JLC_ISBRANCHL(Type) \
+        (((Type) >= cJU_JPBRANCH_L2) && ((Type) <= cJU_JPBRANCH_L))
+#define JLC_ISBRANCHB(Type) \
+        (((Type) >= cJU_JPBRANCH_B2) && ((Type) <= cJU_JPBRANCH_B))
+#define JLC_ISBRANCHU(Type) \
+        (((Type) >= cJU_JPBRANCH_U2) && ((Type) <= cJU_JPBRANCH_U))
+#define JLC_ISLEAFL(Type) \
+        (((Type) >= cJU_JPLEAF1) && ((Type) < cJU_JPLEAF_B1))
+#define JLC_ISIMMED(Type) \
+        (((Type) >= cJU_JPIMMED_1_01) && ((Type) < cJU_JPIMMED_CAP))
+
+// State (number of undecoded bytes, including the one decoded here) of each
+// type of branch; the root branches (BRANCH_L, _B, _U) are at cJU_ROOTSTATE:
+
+#define JLC_BRANCHSTATE(Type,FirstType) ((int) ((Type) - (FirstType)) + 2)
+
+// Copy Dcd bytes from a JP to the Index under construction.  There are none
+// to copy at or above cJU_ROOTSTATE - 1, and JU_SETDCD() must not be used
+// with cJU_ROOTSTATE:
+
+#define JLC_SETDCD(Index,Pjp,State)                     \
+        if ((State) < cJU_ROOTSTATE - 1) JU_SETDCD(Index, Pjp, State)
+
+
+// ****************************************************************************
+// __ J U D Y   L   C U R S O R   I M M E D
+//
+// Return the Pop1 of an immediate JP type and set its Index Size.
+
+FUNCTION static int j__udyLCursorImmed(uint8_t Type, int * PIndexSize)
+{
+        if (Type < cJU_JPIMMED_1_02)            // cJU_JPIMMED_*_01:
+        {
+            *PIndexSize = Type - cJU_JPIMMED_1_01 + 1;
+            return(1);
+        }
+#ifdef JU_64BIT
+        if (Type <= cJU_JPIMMED_1_07)
+        {
+            *PIndexSize = 1;
+            return(Type - cJU_JPIMMED_1_02 + 2);
+        }
+        if (Type <= cJU_JPIMMED_2_03)
+        {
+            *PIndexSize = 2;
+            return(Type - cJU_JPIMMED_2_02 + 2);
+        }
+        *PIndexSize = 3;                        // cJU_JPIMMED_3_02.
+        return(2);
+#else
+        *PIndexSize = 1;                        // cJU_JPIMMED_1_02, _1_03.
+        return(Type - cJU_JPIMMED_1_02 + 2);
+#endif
+
+} // j__udyLCursorImmed()
+
+
+// ****************************************************************************
+// __ J U D Y   L   C U R S O R   L E A F   I N D E X
+//
+// Return the Offset'th IndexSize-byte Index from a linear leaf or immediate.
+
+FUNCTION static Word_t j__udyLCursorLeafIndex(
+        uint8_t * PLeaf,
+        int       IndexSize,
+        int       Offset)
+{
+        Word_t    Index;
+
+        switch (IndexSize)
+        {
+        case 1: return(PLeaf[Offset]);
+        case 2: return(((uint16_t *) PLeaf)[Offset]);
+        case 3: JU_COPY3_PINDEX_TO_LONG(Index, PLeaf + (3 * Offset));
+                return(Index);
+#ifdef JU_64BIT
+        case 4: return(((uint32_t *) PLeaf)[Offset]);
+        case 5: JU_COPY5_PINDEX_TO_LONG(Index, PLeaf + (5 * Offset));
+                return(Index);
+        case 6: JU_COPY6_PINDEX_TO_LONG(Index, PLeaf + (6 * Offset));
+                return(Index);
+        case 7: JU_COPY7_PINDEX_TO_LONG(Index, PLeaf + (7 * Offset));
+                return(Index);
+#endif
+        }
+        assert(FALSE);
+        return(0);
+
+} // j__udyLCursorLeafIndex()
+
+
+// ****************************************************************************
+// __ J U D Y   L   C U R S O R   L E A F   V A L U E S
+//
+// Return the value area of a linear leaf.
+
+FUNCTION static Pjv_t j__udyLCursorLeafValues(
+        Pjll_t    Pjll,
+        int       IndexSize,
+        Word_t    Pop1)
+{
+        switch (IndexSize)
+        {
+        case 1: return(JL_LEAF1VALUEAREA(Pjll, Pop1));
+        case 2: return(JL_LEAF2VALUEAREA(Pjll, Pop1));
+        case 3: return(JL_LEAF3VALUEAREA(Pjll, Pop1));
+#ifdef JU_64BIT
+        case 4: return(JL_LEAF4VALUEAREA(Pjll, Pop1));
+        case 5: return(JL_LEAF5VALUEAREA(Pjll, Pop1));
+        case 6: return(JL_LEAF6VALUEAREA(Pjll, Pop1));
+        case 7: return(JL_LEAF7VALUEAREA(Pjll, Pop1));
+#endif
+        }
+        assert(FALSE);
+        return((Pjv_t) NULL);
+
+} // j__udyLCursorLeafValues()
+
+
+// ****************************************************************************
+// __ J U D Y   L   C U R S O R   E N T R Y
+//
+// Make the Offset'th Index of the leaf or immediate at Pjp the current Index:
+// replace its least bytes in jlc_Index, and return its value area.  For a
+// bitmap leaf, Offset is the Index's digit rather than a position.
+
+FUNCTION static PPvoid_t j__udyLCursorEntry(
+        PJudyLCursor_t Pjc,
+        Pjp_t          Pjp,
+        int            Offset)
+{
+        uint8_t        Type = JU_JPTYPE(Pjp);
+        int            IndexSize;
+        int            Pop1;
+
+        Pjc->jlc_PjpLeaf = (Pvoid_t) Pjp;
+        Pjc->jlc_Offset  = Offset;
+
+        if (JLC_ISLEAFL(Type))
+        {
+            Pjll_t Pjll = P_JLL(Pjp->jp_Addr);
+
+            IndexSize = JL_LEAFINDEXSIZE(Type);
+            Pop1      = JU_JPLEAF_POP0(Pjp) + 1;
+            Pjc->jlc_Index = (Pjc->jlc_Index & ~JU_LEASTBYTESMASK(IndexSize))
+                  | j__udyLCursorLeafIndex((uint8_t *) Pjll, IndexSize, Offset);
+            return((PPvoid_t) (j__udyLCursorLeafValues(Pjll, IndexSize, Pop1)
+                               + Offset));
+        }
+
+        if (Type == cJU_JPLEAF_B1)
+        {
+            Pjlb_t    Pjlb   = P_JLB(Pjp->jp_Addr);
+            int       subexp = Offset / cJU_BITSPERSUBEXPL;
+            BITMAPL_t bitmap = JU_JLB_BITMAP(Pjlb, subexp);
+
+            JU_SETDIGIT1(Pjc->jlc_Index, Offset);
+            return((PPvoid_t) (P_JV(JL_JLB_PVALUE(Pjlb, subexp))
+                + j__udyCountBitsL(bitmap
+                                 & JU_MASKLOWEREXC(JU_BITPOSMASKL(Offset)))));
+        }
+
+        assert(JLC_ISIMMED(Type));
+        Pop1 = j__udyLCursorImmed(Type, &IndexSize);
+
+        if (Pop1 == 1)                  // least bytes are in jp_DcdPopO:
+        {
+            JU_SETDIGITS(Pjc->jlc_Index, JU_JPDCDPOP0(Pjp), IndexSize);
+            return((PPvoid_t) (&(Pjp->jp_Addr)));
+        }
+
+        Pjc->jlc_Index = (Pjc->jlc_Index & ~JU_LEASTBYTESMASK(IndexSize))
+             | j__udyLCursorLeafIndex(Pjp->jp_LIndex, IndexSize, Offset);
+        return((PPvoid_t) (P_JV(Pjp->jp_Addr) + Offset));
+
+} // j__udyLCursorEntry()
+
+
+// ****************************************************************************
+// __ J U D Y   L   C U R S O R   B I T M A P   N E X T
+//
+// Return the first set digit after (Forward) or before (! Forward) Digit in a
+// bitmap of NumSubexp subexpanses of SubexpBits bits each, or -1 if none.
+// Digit may be -1 or 256 to search the whole bitmap.  Bitmaps are read through
+// GETBITMAP so one routine serves both bitmap branches and bitmap leaves.
+
+#define JLC_BITMAPNEXT(Result,GETBITMAP,Pobj,SubexpBits,NumSubexp,Digit,Forward) \
+        {                                                               \
+            int    subexp_ = ((Digit) + ((Forward) ? 1 : -1));          \
+            int    bit_;                                                \
+            Word_t bitmap_;                                             \
+                                                                        \
+            (Result) = -1;                                              \
+            if ((subexp_ >= 0) && (subexp_ < (int) ((SubexpBits) * (NumSubexp)))) \
+            {                                                           \
+                bit_    = subexp_ % (SubexpBits);                       \
+                subexp_ = subexp_ / (SubexpBits);                       \
+                bitmap_ = (Word_t) GETBITMAP(Pobj, subexp_);            \
+                bitmap_ &= (Forward) ? ~((((Word_t) 1) << bit_) - 1)    \
+                                     : ((((Word_t) 2) << bit_) - 1);    \
+                for (;;)                                                \
+                {                                                       \
+                    if (bitmap_)                                        \
+                    {                                                   \
+                        bit_ = (Forward) ? 0 : (SubexpBits) - 1;        \
+                        while (! (bitmap_ & (((Word_t) 1) << bit_)))    \
+                            bit_ += (Forward) ? 1 : -1;                 \
+                        (Result) = subexp_ * (SubexpBits) + bit_;       \
+                        break;                                          \
+                    }                                                   \
+                    subexp_ += (Forward) ? 1 : -1;                      \
+                    if ((subexp_ < 0) || (subexp_ >= (int) (NumSubexp))) break; \
+                    bitmap_ = (Word_t) GETBITMAP(Pobj, subexp_);        \
+                }                                                       \
+            }                                                           \
+        }
+
+
+// ****************************************************************************
+// __ J U D Y   L   C U R S O R   L I M I T
+//
+// Descend from Pjp to the lowest (Forward) or highest (! Forward) Index below
+// it, pushing each branch passed through onto the cursor's path, and make that
+// Index current.  The digits above Pjp must already be in jlc_Index.
+
+FUNCTION static PPvoid_t j__udyLCursorLimit(
+        PJudyLCursor_t Pjc,
+        Pjp_t          Pjp,
+        int            Forward)
+{
+        for (;;)
+        {
+            uint8_t Type = JU_JPTYPE(Pjp);
+            int     state, offset, digit;
+
+            if (Pjc->jlc_Depth >= cJLC_MAXDEPTH) return(PPJERR);
+
+            if (JLC_ISBRANCHL(Type))
+            {
+                Pjbl_t Pjbl = P_JBL(Pjp->jp_Addr);
+
+                state = JLC_BRANCHSTATE(Type, cJU_JPBRANCH_L2);
+                JLC_SETDCD(Pjc->jlc_Index, Pjp, state);
+
+                if (Pjbl->jbl_NumJPs == 0) return(PPJERR);
+                offset = Forward ? 0 : Pjbl->jbl_NumJPs - 1;
+
+                Pjc->jlc_PjpHist[Pjc->jlc_Depth]   = (Pvoid_t) Pjp;
+                Pjc->jlc_OffHist[Pjc->jlc_Depth++] = offset;
+                JU_SETDIGIT(Pjc->jlc_Index, Pjbl->jbl_Expanse[offset], state);
+                Pjp = Pjbl->jbl_jp + offset;
+                continue;
+            }
+
+            if (JLC_ISBRANCHB(Type))
+            {
+                Pjbb_t Pjbb = P_JBB(Pjp->jp_Addr);
+                int    subexp;
+
+                state = JLC_BRANCHSTATE(Type, cJU_JPBRANCH_B2);
+                JLC_SETDCD(Pjc->jlc_Index, Pjp, state);
+
+                JLC_BITMAPNEXT(digit, JU_JBB_BITMAP, Pjbb, cJU_BITSPERSUBEXPB,
+                               cJU_NUMSUBEXPB, Forward ? -1 : cJU_BITSPERBITMAP,
+                               Forward);
+                if (digit < 0) return(PPJERR);
+
+                subexp = digit / cJU_BITSPERSUBEXPB;
+                Pjc->jlc_PjpHist[Pjc->jlc_Depth]   = (Pvoid_t) Pjp;
+                Pjc->jlc_OffHist[Pjc->jlc_Depth++] = digit;
+                JU_SETDIGIT(Pjc->jlc_Index, digit, state);
+                Pjp = P_JP(JU_JBB_PJP(Pjbb, subexp))
+                    + j__udyCountBitsB(JU_JBB_BITMAP(Pjbb, subexp)
+                             & JU_MASKLOWEREXC(JU_BITPOSMASKB(digit)));
+                continue;
+            }
+
+            if (JLC_ISBRANCHU(Type))
+            {
+                Pjbu_t Pjbu = P_JBU(Pjp->jp_Addr);
+
+                state = JLC_BRANCHSTATE(Type, cJU_JPBRANCH_U2);
+                JLC_SETDCD(Pjc->jlc_Index, Pjp, state);
+
+                for (digit = Forward ? 0 : cJU_BRANCHUNUMJPS - 1;
+                     (digit >= 0) && (digit < cJU_BRANCHUNUMJPS);
+                     digit += Forward ? 1 : -1)
+                {
+                    if (JU_JPTYPE(Pjbu->jbu_jp + digit) > cJU_JPNULLMAX) break;
+                }
+                if ((digit < 0) || (digit >= cJU_BRANCHUNUMJPS)) return(PPJERR);
+
+                Pjc->jlc_PjpHist[Pjc->jlc_Depth]   = (Pvoid_t) Pjp;
+                Pjc->jlc_OffHist[Pjc->jlc_Depth++] = digit;
+                JU_SETDIGIT(Pjc->jlc_Index, digit, state);
+                Pjp = Pjbu->jbu_jp + digit;
+                continue;
+            }
+
+            if (JLC_ISLEAFL(Type))
+            {
+                JLC_SETDCD(Pjc->jlc_Index, Pjp, JL_LEAFINDEXSIZE(Type));
+                return(j__udyLCursorEntry(Pjc, Pjp,
+                                          Forward ? 0 : JU_JPLEAF_POP0(Pjp)));
+            }
+
+            if (Type == cJU_JPLEAF_B1)
+            {
+                Pjlb_t Pjlb = P_JLB(Pjp->jp_Addr);
+
+                JU_SETDCD(Pjc->jlc_Index, Pjp, 1);
+                JLC_BITMAPNEXT(digit, JU_JLB_BITMAP, Pjlb, cJU_BITSPERSUBEXPL,
+                               cJU_NUMSUBEXPL, Forward ? -1 : cJU_BITSPERBITMAP,
+                               Forward);
+                if (digit < 0) return(PPJERR);
+                return(j__udyLCursorEntry(Pjc, Pjp, digit));
+            }
+
+            if (JLC_ISIMMED(Type))
+            {
+                int IndexSize;
+                int Pop1 = j__udyLCursorImmed(Type, &IndexSize);
+                return(j__udyLCursorEntry(Pjc, Pjp, Forward ? 0 : Pop1 - 1));
+            }
+
+            return(PPJERR);             // null or unknown JP type.
+        }
+
+} // j__udyLCursorLimit()
+
+
+// ****************************************************************************
+// __ J U D Y   L   C U R S O R   S T E P
+//
+// Move a valid cursor to the next (Forward) or previous Index.  Return its
+// value area, or NULL if there is none.
+
+FUNCTION static PPvoid_t j__udyLCursorStep(
+        PJudyLCursor_t Pjc,
+        int            Forward)
+{
+        Pjp_t          Pjp = (Pjp_t) Pjc->jlc_PjpLeaf;
+        uint8_t        Type;
+        int            offset, digit, state;
+
+// ROOT-LEVEL LEAF:
+
+        if (Pjp == (Pjp_t) NULL)
+        {
+            Pjlw_t Pjlw = P_JLW(Pjc->jlc_PArray);
+            Word_t pop1 = Pjlw[0] + 1;
+
+            offset = Pjc->jlc_Offset + (Forward ? 1 : -1);
+            if ((offset < 0) || (offset >= (int) pop1)) return((PPvoid_t) NULL);
+
+            Pjc->jlc_Offset = offset;
+            Pjc->jlc_Index  = Pjlw[offset + 1];
+            return((PPvoid_t) (JL_LEAFWVALUEAREA(Pjlw, pop1) + offset));
+        }
+
+// WITHIN THE CURRENT LEAF OR IMMEDIATE:
+
+        Type = JU_JPTYPE(Pjp);
+
+        if (Type == cJU_JPLEAF_B1)
+        {
+            JLC_BITMAPNEXT(digit, JU_JLB_BITMAP, P_JLB(Pjp->jp_Addr),
+                           cJU_BITSPERSUBEXPL, cJU_NUMSUBEXPL,
+                           Pjc->jlc_Offset, Forward);
+            if (digit >= 0) return(j__udyLCursorEntry(Pjc, Pjp, digit));
+        }
+        else
+        {
+            int IndexSize;
+            int pop1 = JLC_ISLEAFL(Type) ? JU_JPLEAF_POP0(Pjp) + 1
+                                         : j__udyLCursorImmed(Type, &IndexSize);
+
+            offset = Pjc->jlc_Offset + (Forward ? 1 : -1);
+            if ((offset >= 0) && (offset < pop1))
+                return(j__udyLCursorEntry(Pjc, Pjp, offset));
+        }
+
+// BACK UP TO THE NEAREST BRANCH WITH ANOTHER JP IN THE SCAN DIRECTION:
+
+        while (Pjc->jlc_Depth > 0)
+        {
+            Pjp    = (Pjp_t) Pjc->jlc_PjpHist[Pjc->jlc_Depth - 1];
+            offset = Pjc->jlc_OffHist[Pjc->jlc_Depth - 1];
+            Type   = JU_JPTYPE(Pjp);
+
+            if (JLC_ISBRANCHL(Type))
+            {
+                Pjbl_t Pjbl = P_JBL(Pjp->jp_Addr);
+
+                offset += Forward ? 1 : -1;
+                if ((offset >= 0) && (offset < Pjbl->jbl_NumJPs))
+                {
+                    state = JLC_BRANCHSTATE(Type, cJU_JPBRANCH_L2);
+                    Pjc->jlc_OffHist[Pjc->jlc_Depth - 1] = offset;
+                    JU_SETDIGIT(Pjc->jlc_Index, Pjbl->jbl_Expanse[offset], state);
+                    return(j__udyLCursorLimit(Pjc, Pjbl->jbl_jp + offset, Forward));
+                }
+            }
+            else if (JLC_ISBRANCHB(Type))
+            {
+                Pjbb_t Pjbb = P_JBB(Pjp->jp_Addr);
+
+                JLC_BITMAPNEXT(digit, JU_JBB_BITMAP, Pjbb, cJU_BITSPERSUBEXPB,
+                               cJU_NUMSUBEXPB, offset, Forward);
+                if (digit >= 0)
+                {
+                    int subexp = digit / cJU_BITSPERSUBEXPB;
+
+                    state = JLC_BRANCHSTATE(Type, cJU_JPBRANCH_B2);
+                    Pjc->jlc_OffHist[Pjc->jlc_Depth - 1] = digit;
+                    JU_SETDIGIT(Pjc->jlc_Index, digit, state);
+                    return(j__udyLCursorLimit(Pjc, P_JP(JU_JBB_PJP(Pjbb, subexp))
+                        + j__udyCountBitsB(JU_JBB_BITMAP(Pjbb, subexp)
+                                 & JU_MASKLOWEREXC(JU_BITPOSMASKB(digit))),
+                        Forward));
+                }
+            }
+            else
+            {
+                Pjbu_t Pjbu = P_JBU(Pjp->jp_Addr);
+
+                assert(JLC_ISBRANCHU(Type));
+                for (digit = offset + (Forward ? 1 : -1);
+                     (digit >= 0) && (digit < cJU_BRANCHUNUMJPS);
+                     digit += Forward ? 1 : -1)
+                {
+                    if (JU_JPTYPE(Pjbu->jbu_jp + digit) <= cJU_JPNULLMAX)
+                        continue;
+
+                    state = JLC_BRANCHSTATE(Type, cJU_JPBRANCH_U2);
+                    Pjc->jlc_OffHist[Pjc->jlc_Depth - 1] = digit;
+                    JU_SETDIGIT(Pjc->jlc_Index, digit, state);
+                    return(j__udyLCursorLimit(Pjc, Pjbu->jbu_jp + digit, Forward));
+                }
+            }
+
+            --(Pjc->jlc_Depth);         // branch exhausted; go up.
+        }
+
+        return((PPvoid_t) NULL);
+
+} // j__udyLCursorStep()
+
+
+// ****************************************************************************
+// __ J U D Y   L   C U R S O R   S E E K
+//
+// Take a fresh path from the root to Index, which the caller has just found
+// in the array, and make it the cursor's current Index.  Return its value
+// area, or NULL if the walk does not reach Index after all.
+
+FUNCTION static PPvoid_t j__udyLCursorSeek(
+        PJudyLCursor_t Pjc,
+        Pcvoid_t       PArray,
+        Word_t         Index)
+{
+        Pjpm_t         Pjpm;
+        Pjp_t          Pjp;
+        int            offset, state;
+        uint8_t        digit;
+
+        Pjc->jlc_PArray = PArray;
+        Pjc->jlc_Index  = Index;
+        Pjc->jlc_Depth  = 0;
+
+        if (JU_LEAFW_POP0(PArray) < cJU_LEAFW_MAXPOP1) // must be a LEAFW
+        {
+            Pjlw_t Pjlw = P_JLW(PArray);
+            Word_t pop1 = Pjlw[0] + 1;
+
+            if ((offset = j__udySearchLeafW(Pjlw + 1, pop1, Index)) < 0)
+                return((PPvoid_t) NULL);
+
+            Pjc->jlc_PjpLeaf = (Pvoid_t) NULL;
+            Pjc->jlc_Offset  = offset;
+            return((PPvoid_t) (JL_LEAFWVALUEAREA(Pjlw, pop1) + offset));
+        }
+
+        Pjpm = P_JPM(PArray);
+        Pjc->jlc_ModCount = Pjpm->jpm_ModCount;
+        Pjp  = &(Pjpm->jpm_JP);
+
+        for (;;)
+        {
+            uint8_t Type = JU_JPTYPE(Pjp);
+
+            if (Pjc->jlc_Depth >= cJLC_MAXDEPTH) return((PPvoid_t) NULL);
+
+            if (JLC_ISBRANCHL(Type))
+            {
+                Pjbl_t Pjbl = P_JBL(Pjp->jp_Addr);
+
+                state = JLC_BRANCHSTATE(Type, cJU_JPBRANCH_L2);
+                if ((state < cJU_ROOTSTATE)
+                 && JU_DCDNOTMATCHINDEX(Index, Pjp, state))
+                    return((PPvoid_t) NULL);
+
+                digit  = JU_DIGITATSTATE(Index, state);
+                offset = j__udySearchLeaf1((Pjll_t) (Pjbl->jbl_Expanse),
+                                           Pjbl->jbl_NumJPs, digit);
+                if (offset < 0) return((PPvoid_t) NULL);
+
+                Pjc->jlc_PjpHist[Pjc->jlc_Depth]   = (Pvoid_t) Pjp;
+                Pjc->jlc_OffHist[Pjc->jlc_Depth++] = offset;
+                Pjp = Pjbl->jbl_jp + offset;
+                continue;
+            }
+
+            if (JLC_ISBRANCHB(Type))
+            {
+                Pjbb_t    Pjbb = P_JBB(Pjp->jp_Addr);
+                int       subexp;
+                BITMAPB_t bitmap, bitmask;
+
+                state = JLC_BRANCHSTATE(Type, cJU_JPBRANCH_B2);
+                if ((state < cJU_ROOTSTATE)
+                 && JU_DCDNOTMATCHINDEX(Index, Pjp, state))
+                    return((PPvoid_t) NULL);
+
+                digit   = JU_DIGITATSTATE(Index, state);
+                subexp  = digit / cJU_BITSPERSUBEXPB;
+                bitmap  = JU_JBB_BITMAP(Pjbb, subexp);
+                bitmask = JU_BITPOSMASKB(digit);
+                if (! (bitmap & bitmask)) return((PPvoid_t) NULL);
+
+                Pjc->jlc_PjpHist[Pjc->jlc_Depth]   = (Pvoid_t) Pjp;
+                Pjc->jlc_OffHist[Pjc->jlc_Depth++] = digit;
+                Pjp = P_JP(JU_JBB_PJP(Pjbb, subexp))
+                    + j__udyCountBitsB(bitmap & JU_MASKLOWEREXC(bitmask));
+                continue;
+            }
+
+            if (JLC_ISBRANCHU(Type))
+            {
+                state = JLC_BRANCHSTATE(Type, cJU_JPBRANCH_U2);
+                if ((state < cJU_ROOTSTATE)
+                 && JU_DCDNOTMATCHINDEX(Index, Pjp, state))
+                    return((PPvoid_t) NULL);
+
+                digit = JU_DIGITATSTATE(Index, state);
+                Pjc->jlc_PjpHist[Pjc->jlc_Depth]   = (Pvoid_t) Pjp;
+                Pjc->jlc_OffHist[Pjc->jlc_Depth++] = digit;
+                Pjp = P_JBU(Pjp->jp_Addr)->jbu_jp + digit;
+                continue;
+            }
+
+            if (JLC_ISLEAFL(Type))
+            {
+                Pjll_t Pjll = P_JLL(Pjp->jp_Addr);
+                Word_t pop1 = JU_JPLEAF_POP0(Pjp) + 1;
+
+                state = JL_LEAFINDEXSIZE(Type);
+                if (JU_DCDNOTMATCHINDEX(Index, Pjp, state))
+                    return((PPvoid_t) NULL);
+
+                switch (state)
+                {
+                case 1: offset = j__udySearchLeaf1(Pjll, pop1, Index); break;
+                case 2: offset = j__udySearchLeaf2(Pjll, pop1, Index); break;
+                case 3: offset = j__udySearchLeaf3(Pjll, pop1, Index); break;
+#ifdef JU_64BIT
+                case 4: offset = j__udySearchLeaf4(Pjll, pop1, Index); break;
+                case 5: offset = j__udySearchLeaf5(Pjll, pop1, Index); break;
+                case 6: offset = j__udySearchLeaf6(Pjll, pop1, Index); break;
+                case 7: offset = j__udySearchLeaf7(Pjll, pop1, Index); break;
+#endif
+                default: return((PPvoid_t) NULL);
+                }
+                if (offset < 0) return((PPvoid_t) NULL);
+
+                return(j__udyLCursorEntry(Pjc, Pjp, offset));
+            }
+
+            if (Type == cJU_JPLEAF_B1)
+            {
+                if (JU_DCDNOTMATCHINDEX(Index, Pjp, 1)
+                 || (! JU_BITMAPTESTL(P_JLB(Pjp->jp_Addr), Index)))
+                    return((PPvoid_t) NULL);
+
+                return(j__udyLCursorEntry(Pjc, Pjp, JU_DIGITATSTATE(Index, 1)));
+            }
+
+            if (JLC_ISIMMED(Type))
+            {
+                int IndexSize;
+                int pop1 = j__udyLCursorImmed(Type, &IndexSize);
+
+                if (pop1 == 1)
+                {
+                    if (JU_JPDCDPOP0(Pjp) != JU_TRIMTODCDSIZE(Index))
+                        return((PPvoid_t) NULL);
+                    return(j__udyLCursorEntry(Pjc, Pjp, 0));
+                }
+
+                for (offset = 0; offset < pop1; ++offset)
+                {
+                    if (j__udyLCursorLeafIndex(Pjp->jp_LIndex, IndexSize, offset)
+                     == JU_LEASTBYTES(Index, IndexSize))
+                        return(j__udyLCursorEntry(Pjc, Pjp, offset));
+                }
+                return((PPvoid_t) NULL);
+            }
+
+            return((PPvoid_t) NULL);    // null JP or unknown type.
+        }
+
+} // j__udyLCursorSeek()
+
+
+// ****************************************************************************
+// __ J U D Y   L   C U R S O R   V A L I D
+//
+// Return TRUE if the cursor's path is still good and leads to Index.
+
+FUNCTION static int j__udyLCursorValid(
+        PJudyLCursor_t Pjc,
+        Pcvoid_t       PArray,
+        Word_t         Index)
+{
+        if ((PArray == (Pcvoid_t) NULL) || (Pjc->jlc_PArray != PArray)
+         || (Pjc->jlc_Index != Index))
+        {
+            return(FALSE);
+        }
+
+// A LEAFW has no path, so just check the saved offset still holds Index:
+
+        if (JU_LEAFW_POP0(PArray) < cJU_LEAFW_MAXPOP1)
+        {
+            Pjlw_t Pjlw = P_JLW(PArray);
+
+            return((Pjc->jlc_PjpLeaf == (Pvoid_t) NULL)
+                && ((Word_t) Pjc->jlc_Offset <= Pjlw[0])
+                && (Pjlw[Pjc->jlc_Offset + 1] == Index));
+        }
+
+        return((Pjc->jlc_Depth > 0)
+            && (P_JPM(PArray)->jpm_ModCount == Pjc->jlc_ModCount));
+
+} // j__udyLCursorValid()
+
+
+// ****************************************************************************
+// __ J U D Y   L   C U R S O R   R E S U L T
+//
+// Common tail for the public functions:  given the value area returned by the
+// regular JudyL*() function for *PIndex, take a fresh path to *PIndex.
+
+FUNCTION static PPvoid_t j__udyLCursorResult(
+        PJudyLCursor_t Pjc,
+        Pcvoid_t       PArray,
+        Word_t *       PIndex,
+        PPvoid_t       PValue)
+{
+        if ((PValue == (PPvoid_t) NULL) || (PValue == PPJERR)
+         || (j__udyLCursorSeek(Pjc, PArray, *PIndex) != PValue))
+        {
+            Pjc->jlc_PArray = (Pcvoid_t) NULL;  // no usable path.
+        }
+        return(PValue);
+
+} // j__udyLCursorResult()
+
+
+// ****************************************************************************
+// J U D Y   L   C U R S O R   I N I T
+// J U D Y   L   C U R S O R   F I R S T
+// J U D Y   L   C U R S O R   L A S T
+// J U D Y   L   C U R S O R   N E X T
+// J U D Y   L   C U R S O R   P R E V
+//
+// See the file comment above; otherwise the same as JudyLFirst() etc.
+
+FUNCTION void JudyLCursorInit(PJudyLCursor_t PCursor)
+{
+        PCursor->jlc_PArray   = (Pcvoid_t) NULL;
+        PCursor->jlc_ModCount = 0;
+        PCursor->jlc_Index    = 0;
+        PCursor->jlc_Depth    = 0;
+        PCursor->jlc_PjpLeaf  = (Pvoid_t) NULL;
+        PCursor->jlc_Offset   = 0;
+
+} // JudyLCursorInit()
+
+
+FUNCTION PPvoid_t JudyLCursorFirst(
+        PJudyLCursor_t PCursor,         // path to reuse and update.
+        Pcvoid_t       PArray,          // Judy array to search.
+        Word_t *       PIndex,          // starting point and result.
+        PJError_t      PJError)         // optional, for returning error info.
+{
+        if ((PCursor == (PJudyLCursor_t) NULL) || (PIndex == (PWord_t) NULL))
+        {
+            JU_SET_ERRNO(PJError, JU_ERRNO_NULLPINDEX);
+            return(PPJERR);
+        }
+
+        return(j__udyLCursorResult(PCursor, PArray, PIndex,
+                                   JudyLFirst(PArray, PIndex, PJError)));
+
+} // JudyLCursorFirst()
+
+
+FUNCTION PPvoid_t JudyLCursorLast(
+        PJudyLCursor_t PCursor,         // path to reuse and update.
+        Pcvoid_t       PArray,          // Judy array to search.
+        Word_t *       PIndex,          // starting point and result.
+        PJError_t      PJError)         // optional, for returning error info.
+{
+        if ((PCursor == (PJudyLCursor_t) NULL) || (PIndex == (PWord_t) NULL))
+        {
+            JU_SET_ERRNO(PJError, JU_ERRNO_NULLPINDEX);
+            return(PPJERR);
+        }
+
+        return(j__udyLCursorResult(PCursor, PArray, PIndex,
+                                   JudyLLast(PArray, PIndex, PJError)));
+
+} // JudyLCursorLast()
+
+
+FUNCTION PPvoid_t JudyLCursorNext(
+        PJudyLCursor_t PCursor,         // path to reuse and update.
+        Pcvoid_t       PArray,          // Judy array to search.
+        Word_t *       PIndex,          // starting point and result.
+        PJError_t      PJError)         // optional, for returning error info.
+{
+        PPvoid_t       PValue;
+
+        if ((PCursor == (PJudyLCursor_t) NULL) || (PIndex == (PWord_t) NULL))
+        {
+            JU_SET_ERRNO(PJError, JU_ERRNO_NULLPINDEX);
+            return(PPJERR);
+        }
+
+        if (! j__udyLCursorValid(PCursor, PArray, *PIndex))
+        {
+            return(j__udyLCursorResult(PCursor, PArray, PIndex,
+                                       JudyLNext(PArray, PIndex, PJError)));
+        }
+
+        if ((PValue = j__udyLCursorStep(PCursor, TRUE)) == PPJERR)
+        {
+            PCursor->jlc_PArray = (Pcvoid_t) NULL;
+            JU_SET_ERRNO(PJError, JU_ERRNO_CORRUPT);
+            return(PPJERR);
+        }
+        if (PValue == (PPvoid_t) NULL)          // no next Index.
+        {
+            PCursor->jlc_PArray = (Pcvoid_t) NULL;
+            return((PPvoid_t) NULL);
+        }
+
+        *PIndex = PCursor->jlc_Index;
+        return(PValue);
+
+} // JudyLCursorNext()
+
+
+FUNCTION PPvoid_t JudyLCursorPrev(
+        PJudyLCursor_t PCursor,         // path to reuse and update.
+        Pcvoid_t       PArray,          // Judy array to search.
+        Word_t *       PIndex,          // starting point and result.
+        PJError_t      PJError)         // optional, for returning error info.
+{
+        PPvoid_t       PValue;
+
+        if ((PCursor == (PJudyLCursor_t) NULL) || (PIndex == (PWord_t) NULL))
+        {
+            JU_SET_ERRNO(PJError, JU_ERRNO_NULLPINDEX);
+            return(PPJERR);
+        }
+
+        if (! j__udyLCursorValid(PCursor, PArray, *PIndex))
+        {
+            return(j__udyLCursorResult(PCursor, PArray, PIndex,
+                                       JudyLPrev(PArray, PIndex, PJError)));
+        }
+
+        if ((PValue = j__udyLCursorStep(PCursor, FALSE)) == PPJERR)
+        {
+            PCursor->jlc_PArray = (Pcvoid_t) NULL;
+            JU_SET_ERRNO(PJError, JU_ERRNO_CORRUPT);
+            return(PPJERR);
+        }
+        if (PValue == (PPvoid_t) NULL)          // no previous Index.
+        {
+            PCursor->jlc_PArray = (Pcvoid_t) NULL;
+            return((PPvoid_t) NULL);
+        }
+
+        *PIndex = PCursor->jlc_Index;
+        return(PValue);
+
+} // JudyLCursorPrev()
@@ -1979,6 +1979,7 @@ JUDYLCODE(PPvoid_t PPvalue;)  // pointer from JudyLGet().
             }
 
             --(Pjpm->jpm_Pop0); // success; decrement total population.
+            JUDYLCODE(++(Pjpm->jpm_ModCount);)  // invalidate cursors.
 
             if ((Pjpm->jpm_Pop0 + 1) != cJU_LEAFW_MAXPOP1)
             {
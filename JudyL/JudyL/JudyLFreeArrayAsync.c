@@ -0,0 +1,425 @@
+// @(#) JudyLFreeArrayAsync.c
+//
+// JudyLFreeArrayAsync() and JudyLFreeArrayParallel():  free a JudyL array on
+// worker threads, for arrays large enough that JudyLFreeArray() causes a
+// noticeable pause.
+//
+// Both detach the array from *PPArray and free its JPM on the calling thread,
+// then split the rest of the tree at the top branch:  each JP in the top
+// branch is a separate piece of work, claimed in turn by whichever worker is
+// free, and freed with j__udyFreeSM() just as JudyLFreeArray() would.  The
+// worker which finishes last frees the top branch itself.
+//
+// JudyLFreeArrayAsync() queues the work on Threads workers and returns at
+// once; JudyLFreeArrayWait() waits for all such frees to finish.
+// JudyLFreeArrayParallel() does one share of the work on the calling thread,
+// alongside Threads - 1 workers, and returns when the array is gone.
+//
+// Note:  JudyMalloc() and JudyFree() are called from several threads at once,
+// so the allocator behind them must be thread-safe.  Root-level LEAFW arrays
+// are small, and are simply passed to JudyLFreeArray().
+
+#define JUDYL
+
+#ifdef JU_WIN
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "JudyL.h"
+
+#include "JudyPrivate1L.h"
+
+
+// ****************************************************************************
+// THREADS AND ATOMIC COUNTERS:
+//
+// The counters are only read through JFA_READ(), a full barrier, so a thread
+// which sees a worker's final decrement also sees everything it freed.
+
+#ifdef JU_WIN
+typedef LONG volatile jfc_t;
+
+#define JFA_INCREMENT(PCount) InterlockedIncrement(PCount)
+#define JFA_DECREMENT(PCount) InterlockedDecrement(PCount)
+#define JFA_READ(PCount)      InterlockedCompareExchange(PCount, 0, 0)
+#define JFA_YIELD()           SwitchToThread()
+#else
+typedef long volatile jfc_t;
+
+#define JFA_INCREMENT(PCount) __sync_add_and_fetch(PCount, 1)
+#define JFA_DECREMENT(PCount) __sync_sub_and_fetch(PCount, 1)
+#define JFA_READ(PCount)      __sync_fetch_and_add(PCount, 0)
+#define JFA_YIELD()           sched_yield()
+#endif
+
+
+// ****************************************************************************
+// FREE GROUP:
+//
+// One per array being freed.  Each worker claims the next unfreed JP below
+// the top branch by incrementing jfg_NextJP, and records the (negative) words
+// it freed in that JP's jfg_Words[] slot, so no two workers write the same
+// memory.
+
+typedef struct J_UDYL_FREE_GROUP
+{
+        jp_t   jfg_JP;                           // detached top JP.
+        Word_t jfg_TotalMemWords;                // as in the JPM.
+        Word_t jfg_JPMWords;                     // freed with the JPM.
+        Word_t jfg_NumJPs;                       // in jfg_PjpBelow[].
+        jfc_t  jfg_NextJP;                       // last JP claimed.
+        jfc_t  jfg_Workers;                      // workers still running.
+        int    jfg_Async;                        // last worker frees group.
+        Word_t jfg_Words[cJU_BRANCHUNUMJPS];     // freed below each JP.
+        Pjp_t  jfg_PjpBelow[cJU_BRANCHUNUMJPS];  // JPs in the top branch.
+
+} jfg_t, * Pjfg_t;
+
+#define cJFA_GROUPWORDS \
+        ((sizeof(jfg_t) + cJU_BYTESPERWORD - 1) / cJU_BYTESPERWORD)
+
+static jfc_t j__udyLFreePending = 0;    // async groups not yet freed.
+
+
+// ****************************************************************************
+// __ J U D Y   L   F R E E   T O P
+//
+// Free the top branch of a group, but none of the JPs below it; or if the top
+// JP is not a branch, everything below it.  Return the (negative) words freed.
+
+FUNCTION static Word_t j__udyLFreeTop(Pjfg_t Pjfg)
+{
+        Pjp_t  Pjp = &(Pjfg->jfg_JP);
+        jpm_t  jpm;
+
+        jpm.jpm_Pop0          = 0;
+        jpm.jpm_TotalMemWords = 0;
+
+        switch (JU_JPTYPE(Pjp))
+        {
+        case cJU_JPBRANCH_L:
+            j__udyFreeJBL((Pjbl_t) (Pjp->jp_Addr), &jpm);
+            break;
+
+        case cJU_JPBRANCH_B:
+        {
+            Pjbb_t Pjbb = P_JBB(Pjp->jp_Addr);
+            Word_t subexp;
+            Word_t jpcount;
+
+            for (subexp = 0; subexp < cJU_NUMSUBEXPB; ++subexp)
+            {
+                jpcount = j__udyCountBitsB(JU_JBB_BITMAP(Pjbb, subexp));
+
+                if (jpcount)
+                    j__udyFreeJBBJP(JU_JBB_PJP(Pjbb, subexp), jpcount, &jpm);
+            }
+            j__udyFreeJBB((Pjbb_t) (Pjp->jp_Addr), &jpm);
+            break;
+        }
+
+        case cJU_JPBRANCH_U:
+            j__udyFreeJBU((Pjbu_t) (Pjp->jp_Addr), &jpm);
+            break;
+
+        default:
+            j__udyFreeSM(Pjp, &jpm);
+            break;
+        }
+
+        return(jpm.jpm_TotalMemWords);
+
+} // j__udyLFreeTop()
+
+
+// ****************************************************************************
+// __ J U D Y   L   F R E E   W O R K
+//
+// Body of each worker:  free JPs below the top branch until none are left.
+// Return TRUE if this was the last worker to finish.
+
+FUNCTION static int j__udyLFreeWork(Pjfg_t Pjfg)
+{
+        jpm_t jpm;
+        long  offset;
+        int   async;
+
+        while ((offset = JFA_INCREMENT(&(Pjfg->jfg_NextJP)))
+             < (long) Pjfg->jfg_NumJPs)
+        {
+            jpm.jpm_Pop0          = 0;
+            jpm.jpm_TotalMemWords = 0;
+
+            j__udyFreeSM(Pjfg->jfg_PjpBelow[offset], &jpm);
+            Pjfg->jfg_Words[offset] = jpm.jpm_TotalMemWords;
+        }
+
+// Once jfg_Workers reaches 0, JudyLFreeArrayParallel() may free the group, so
+// jfg_Async must be read first:
+
+        async = Pjfg->jfg_Async;
+        if (JFA_DECREMENT(&(Pjfg->jfg_Workers)) > 0) return(FALSE);
+
+// Last worker out frees the top branch, and for an async free, the group:
+
+        if (async)
+        {
+            (void) j__udyLFreeTop(Pjfg);
+            JudyFree((Pvoid_t) Pjfg, cJFA_GROUPWORDS);
+            (void) JFA_DECREMENT(&j__udyLFreePending);
+        }
+        return(TRUE);
+
+} // j__udyLFreeWork()
+
+
+#ifdef JU_WIN
+FUNCTION static DWORD WINAPI j__udyLFreeWorker(LPVOID Pjfg)
+{
+        (void) j__udyLFreeWork((Pjfg_t) Pjfg);
+        return(0);
+}
+#else
+FUNCTION static void * j__udyLFreeWorker(void * Pjfg)
+{
+        (void) j__udyLFreeWork((Pjfg_t) Pjfg);
+        return((void *) NULL);
+}
+#endif
+
+
+// ****************************************************************************
+// __ J U D Y   L   F R E E   S T A R T
+//
+// Hand a group to one more worker, from the system thread pool on Windows.
+// Return FALSE if no worker could be started.
+
+FUNCTION static int j__udyLFreeStart(Pjfg_t Pjfg)
+{
+#ifdef JU_WIN
+        return(QueueUserWorkItem(j__udyLFreeWorker, (PVOID) Pjfg,
+                                 WT_EXECUTELONGFUNCTION) != 0);
+#else
+        pthread_t thread;
+
+        if (pthread_create(&thread, NULL, j__udyLFreeWorker, (void *) Pjfg))
+            return(FALSE);
+
+        (void) pthread_detach(thread);
+        return(TRUE);
+#endif
+
+} // j__udyLFreeStart()
+
+
+// ****************************************************************************
+// __ J U D Y   L   F R E E   D E T A C H
+//
+// Move the tree below a JPM into a new group, free the JPM, and make *PPArray
+// empty.  Return NULL, with nothing freed, if a group cannot be allocated.
+
+FUNCTION static Pjfg_t j__udyLFreeDetach(PPvoid_t PPArray)
+{
+        Pjpm_t Pjpm = P_JPM(*PPArray);
+        Pjfg_t Pjfg;
+        Pjp_t  Pjp;
+        Word_t offset;
+        jpm_t  jpm;
+
+        if ((Pjfg = (Pjfg_t) JudyMalloc(cJFA_GROUPWORDS)) == (Pjfg_t) NULL)
+            return((Pjfg_t) NULL);
+
+        Pjfg->jfg_JP            = Pjpm->jpm_JP;
+        Pjfg->jfg_TotalMemWords = Pjpm->jpm_TotalMemWords;
+        Pjfg->jfg_NumJPs        = 0;
+        Pjfg->jfg_NextJP        = -1;
+        Pjp = &(Pjfg->jfg_JP);
+
+// List the JPs below the top branch; anything else is left to j__udyLFreeTop():
+
+        switch (JU_JPTYPE(Pjp))
+        {
+        case cJU_JPBRANCH_L:
+        {
+            Pjbl_t Pjbl = P_JBL(Pjp->jp_Addr);
+
+            for (offset = 0; offset < Pjbl->jbl_NumJPs; ++offset)
+                Pjfg->jfg_PjpBelow[Pjfg->jfg_NumJPs++] = Pjbl->jbl_jp + offset;
+            break;
+        }
+
+        case cJU_JPBRANCH_B:
+        {
+            Pjbb_t Pjbb = P_JBB(Pjp->jp_Addr);
+            Word_t subexp;
+            Word_t jpcount;
+
+            for (subexp = 0; subexp < cJU_NUMSUBEXPB; ++subexp)
+            {
+                jpcount = j__udyCountBitsB(JU_JBB_BITMAP(Pjbb, subexp));
+
+                for (offset = 0; offset < jpcount; ++offset)
+                {
+                    Pjfg->jfg_PjpBelow[Pjfg->jfg_NumJPs++]
+                        = P_JP(JU_JBB_PJP(Pjbb, subexp)) + offset;
+                }
+            }
+            break;
+        }
+
+        case cJU_JPBRANCH_U:
+        {
+            Pjbu_t Pjbu = P_JBU(Pjp->jp_Addr);
+
+            for (offset = 0; offset < cJU_BRANCHUNUMJPS; ++offset)
+            {
+                if (JU_JPTYPE(Pjbu->jbu_jp + offset) > cJU_JPNULLMAX)
+                    Pjfg->jfg_PjpBelow[Pjfg->jfg_NumJPs++] = Pjbu->jbu_jp + offset;
+            }
+            break;
+        }
+        }
+
+// The JPM is freed here rather than by a worker, so only the calling thread
+// ever allocates or frees JPMs:
+
+        jpm.jpm_Pop0          = 0;
+        jpm.jpm_TotalMemWords = 0;
+        j__udyFreeJPM(Pjpm, &jpm);
+        Pjfg->jfg_JPMWords = jpm.jpm_TotalMemWords;
+
+        *PPArray = (Pvoid_t) NULL;
+        return(Pjfg);
+
+} // j__udyLFreeDetach()
+
+
+// ****************************************************************************
+// J U D Y   L   F R E E   A R R A Y   A S Y N C
+//
+// Return the number of bytes that will be freed, as JudyLFreeArray() would.
+
+FUNCTION Word_t JudyLFreeArrayAsync(
+        PPvoid_t  PPArray,      // array to free.
+        Word_t    Threads,      // workers to free it with.
+        PJError_t PJError)      // optional, for returning error info.
+{
+        Pjfg_t    Pjfg;
+        Word_t    TotalMem;
+        Word_t    started;
+
+        if (PPArray == (PPvoid_t) NULL)
+        {
+            JU_SET_ERRNO(PJError, JU_ERRNO_NULLPPARRAY);
+            return(JERR);
+        }
+
+        if ((P_JLW(*PPArray) == (Pjlw_t) NULL)
+         || (JU_LEAFW_POP0(*PPArray) < cJU_LEAFW_MAXPOP1)
+         || ((Pjfg = j__udyLFreeDetach(PPArray)) == (Pjfg_t) NULL))
+        {
+            return(JudyLFreeArray(PPArray, PJError));
+        }
+
+        TotalMem = Pjfg->jfg_TotalMemWords;
+        if (Threads < 1) Threads = 1;
+        if (Threads > Pjfg->jfg_NumJPs) Threads = Pjfg->jfg_NumJPs;
+        if (Threads < 1) Threads = 1;
+
+        Pjfg->jfg_Async   = TRUE;
+        Pjfg->jfg_Workers = (long) Threads;
+        (void) JFA_INCREMENT(&j__udyLFreePending);
+
+        for (started = 0; started < Threads; ++started)
+            if (! j__udyLFreeStart(Pjfg)) break;
+
+// Any workers that could not be started are stood in for by this thread,
+// the last of which will free the group:
+
+        for (; started < Threads; ++started)
+            (void) j__udyLFreeWork(Pjfg);
+
+        return(TotalMem * cJU_BYTESPERWORD);
+
+} // JudyLFreeArrayAsync()
+
+
+// ****************************************************************************
+// J U D Y   L   F R E E   A R R A Y   W A I T
+//
+// Wait until every JudyLFreeArrayAsync() has finished.
+
+FUNCTION void JudyLFreeArrayWait(void)
+{
+        while (JFA_READ(&j__udyLFreePending) > 0) JFA_YIELD();
+
+} // JudyLFreeArrayWait()
+
+
+// ****************************************************************************
+// J U D Y   L   F R E E   A R R A Y   P A R A L L E L
+//
+// Return the number of bytes freed, as JudyLFreeArray() does.
+
+FUNCTION Word_t JudyLFreeArrayParallel(
+        PPvoid_t  PPArray,      // array to free.
+        Word_t    Threads,      // threads to free it with, including this one.
+        PJError_t PJError)      // optional, for returning error info.
+{
+        Pjfg_t    Pjfg;
+        Word_t    TotalMem;
+        Word_t    Freed;
+        Word_t    started;
+        Word_t    offset;
+
+        if (PPArray == (PPvoid_t) NULL)
+        {
+            JU_SET_ERRNO(PJError, JU_ERRNO_NULLPPARRAY);
+            return(JERR);
+        }
+
+        if ((P_JLW(*PPArray) == (Pjlw_t) NULL)
+         || (JU_LEAFW_POP0(*PPArray) < cJU_LEAFW_MAXPOP1)
+         || ((Pjfg = j__udyLFreeDetach(PPArray)) == (Pjfg_t) NULL))
+        {
+            return(JudyLFreeArray(PPArray, PJError));
+        }
+
+        TotalMem = Pjfg->jfg_TotalMemWords;
+        if (Threads < 1) Threads = 1;
+        if (Threads > Pjfg->jfg_NumJPs) Threads = Pjfg->jfg_NumJPs;
+        if (Threads < 1) Threads = 1;
+
+        Pjfg->jfg_Async   = FALSE;
+        Pjfg->jfg_Workers = (long) Threads;
+
+        for (started = 1; started < Threads; ++started)
+            if (! j__udyLFreeStart(Pjfg)) break;
+
+        for (; started <= Threads; ++started)   // this thread's share(s).
+            (void) j__udyLFreeWork(Pjfg);
+
+        while (JFA_READ(&(Pjfg->jfg_Workers)) > 0) JFA_YIELD();
+
+// Add up the (negative) words freed; with the JPM's, they must come to the
+// total the JPM recorded, or the array was corrupt:
+
+        Freed = Pjfg->jfg_JPMWords + j__udyLFreeTop(Pjfg);
+
+        for (offset = 0; offset < Pjfg->jfg_NumJPs; ++offset)
+            Freed += Pjfg->jfg_Words[offset];
+
+        JudyFree((Pvoid_t) Pjfg, cJFA_GROUPWORDS);
+
+        if (TotalMem + Freed)
+        {
+            JU_SET_ERRNO(PJError, JU_ERRNO_CORRUPT);
+            return(JERR);
+        }
+        return(TotalMem * cJU_BYTESPERWORD);
+
+} // JudyLFreeArrayParallel()
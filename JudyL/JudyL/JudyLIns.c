@@ -1855,7 +1855,11 @@ FUNCTION PPvoid_t JudyLIns
                 JUDYLCODE(return(PPJERR);)
             }
 
-            if (retcode ==  1) ++(Pjpm->jpm_Pop0);  // incr total array popu.
+            if (retcode ==  1)
+            {
+                ++(Pjpm->jpm_Pop0);             // incr total array popu.
+                JUDYLCODE(++(Pjpm->jpm_ModCount);)  // invalidate cursors.
+            }
 
             assert(((Pjpm->jpm_JP.jp_Type) == cJU_JPBRANCH_L)
                 || ((Pjpm->jpm_JP.jp_Type) == cJU_JPBRANCH_B)
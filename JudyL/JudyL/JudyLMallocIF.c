@@ -49,6 +49,10 @@
 
 #include "JudyPrivate1L.h"
 
+#if defined(MALLOCBITS) && INTEGER_MAP_JUDY_SLAB_ALLOCATOR && (! defined(JU_64BIT))
+#error:  MALLOCBITS needs 8-byte aligned objects; the slab allocator only word-aligns them.
+#endif
+
 // Set "hidden" global j__uMaxWords to the maximum number of words to allocate
 // to any one array (large enough to have a JPM, otherwise j__uMaxWords is
 // ignored), to trigger a fake malloc error when the number is exceeded.  Note,
@@ -57,7 +61,16 @@
 // Note:  To keep the MALLOC macro faster and simpler, set j__uMaxWords to
 // MAXINT, not zero, by default.
 
-Word_t j__uMaxWords = ~0UL;
+Word_t j__uMaxWords = ~(Word_t) 0;
+
+// A new JPM starts its jpm_ModCount above the final jpm_ModCount of every JPM
+// freed so far, so a JudyL cursor cannot mistake a JPM reallocated at the
+// same address for the one it walked (see JudyLCursor.c).  Like the rest of
+// Judy, this is not synchronized between threads.
+
+#ifdef JUDYL
+static Word_t j__udyLModCountSeed = 0;
+#endif
 
 // This macro hides the faking of a malloc failure:
 //
@@ -193,6 +206,7 @@ FUNCTION Pjpm_t j__udyAllocJPM(void)
         {
             ZEROWORDS(Pjpm, Words);
             Pjpm->jpm_TotalMemWords = Words;
+            JUDYLCODE(Pjpm->jpm_ModCount = j__udyLModCountSeed;)
         }
 
         TRACE_ALLOC5("0x%x %8lu = j__udyAllocJPM(), Words = %lu\n",
@@ -529,6 +543,10 @@ FUNCTION void j__udyFreeJPM(Pjpm_t PjpmFree, Pjpm_t PjpmStats)
         Word_t Words = (sizeof(jpm_t) + cJU_BYTESPERWORD - 1) / cJU_BYTESPERWORD;
 
         // MALLOCBITS_TEST(Pjpm_t, PjpmFree);   // see above.
+#ifdef JUDYL
+        if (PjpmFree->jpm_ModCount >= j__udyLModCountSeed)
+            j__udyLModCountSeed = PjpmFree->jpm_ModCount + 1;
+#endif
         JudyFree((Pvoid_t) PjpmFree, Words);
 
         if (PjpmStats != (Pjpm_t) NULL) PjpmStats->jpm_TotalMemWords -= Words;
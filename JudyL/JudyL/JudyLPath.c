@@ -0,0 +1,224 @@
+// @(#) JudyLPath.c
+//
+// JudyLPath():  record the memory that JudyLGet() reads to find Index, one
+// entry per node, from the root down, so that a benchmark can flush exactly
+// those cache lines before a lookup, or check how many of them are cached.
+//
+// The walk follows the same decisions as JudyLGet(), but trusts the Dcd bytes
+// in each JP instead of checking them, since it is only meant for Indexes
+// known to be in the array.  For an absent Index, the path just stops at the
+// node where the lookup would have given up.
+//
+// An entry covers the part of the node a lookup may touch:  the JPM up to its
+// root JP; the whole of a linear branch; the bitmap subexpanse and then the JP
+// subarray of a bitmap branch, which are separate allocations; the one JP
+// taken in an uncompressed branch; and the indexes and values of a linear
+// leaf.  An immediate JP with more than one Index has its values in a small
+// separate array, which gets an entry of its own.
+
+#define JUDYL
+
+#include "JudyL.h"
+
+#include "JudyPrivate1L.h"
+
+
+// ****************************************************************************
+// JP TYPE CLASSIFICATION
+//
+// The same ranges as in JudyLCursor.c; see the enum in JudyL.h.
+
+#define JLP_ISBRANCHL(Type) \
+        (((Type) >= cJU_JPBRANCH_L2) && ((Type) <= cJU_JPBRANCH_L))
+#define JLP_ISBRANCHB(Type) \
+        (((Type) >= cJU_JPBRANCH_B2) && ((Type) <= cJU_JPBRANCH_B))
+#define JLP_ISBRANCHU(Type) \
+        (((Type) >= cJU_JPBRANCH_U2) && ((Type) <= cJU_JPBRANCH_U))
+#define JLP_ISLEAFL(Type) \
+        (((Type) >= cJU_JPLEAF1) && ((Type) < cJU_JPLEAF_B1))
+#define JLP_ISIMMED(Type) \
+        (((Type) >= cJU_JPIMMED_1_01) && ((Type) < cJU_JPIMMED_CAP))
+
+// Digit decoded by each type of branch; the root branches (BRANCH_L, _B, _U)
+// are at cJU_ROOTSTATE:
+
+#define JLP_BRANCHDIGIT(Index,Type,FirstType) \
+        JU_DIGITATSTATE(Index, (int) ((Type) - (FirstType)) + 2)
+
+// Append a node to the path:
+
+#define JLP_ADD(PPath,Addr,Bytes)                                       \
+        {                                                               \
+            if ((PPath)->jlp_Count >= cJLP_MAXNODES) return((PPath)->jlp_Count); \
+            (PPath)->jlp_Addr [(PPath)->jlp_Count]   = (Pcvoid_t) (Addr);     \
+            (PPath)->jlp_Bytes[(PPath)->jlp_Count++] = (Word_t) (Bytes);      \
+        }
+
+
+// ****************************************************************************
+// __ J U D Y   L   P A T H   I M M E D   P O P 1
+//
+// Return the number of Indexes in an immediate JP type.
+
+FUNCTION static Word_t j__udyLPathImmedPop1(uint8_t Type)
+{
+        if (Type < cJU_JPIMMED_1_02) return(1);         // cJU_JPIMMED_*_01.
+#ifdef JU_64BIT
+        if (Type <= cJU_JPIMMED_1_07) return(Type - cJU_JPIMMED_1_02 + 2);
+        if (Type <= cJU_JPIMMED_2_03) return(Type - cJU_JPIMMED_2_02 + 2);
+        return(2);                                      // cJU_JPIMMED_3_02.
+#else
+        return(Type - cJU_JPIMMED_1_02 + 2);            // _1_02, _1_03.
+#endif
+
+} // j__udyLPathImmedPop1()
+
+
+// ****************************************************************************
+// __ J U D Y   L   P A T H   L E A F   E N D
+//
+// Return the address just past the value area of a linear leaf.
+
+FUNCTION static Pjv_t j__udyLPathLeafEnd(
+        Pjll_t    Pjll,
+        int       IndexSize,
+        Word_t    Pop1)
+{
+        switch (IndexSize)
+        {
+        case 1: return(JL_LEAF1VALUEAREA(Pjll, Pop1) + Pop1);
+        case 2: return(JL_LEAF2VALUEAREA(Pjll, Pop1) + Pop1);
+        case 3: return(JL_LEAF3VALUEAREA(Pjll, Pop1) + Pop1);
+#ifdef JU_64BIT
+        case 4: return(JL_LEAF4VALUEAREA(Pjll, Pop1) + Pop1);
+        case 5: return(JL_LEAF5VALUEAREA(Pjll, Pop1) + Pop1);
+        case 6: return(JL_LEAF6VALUEAREA(Pjll, Pop1) + Pop1);
+        case 7: return(JL_LEAF7VALUEAREA(Pjll, Pop1) + Pop1);
+#endif
+        }
+        assert(FALSE);
+        return((Pjv_t) Pjll);
+
+} // j__udyLPathLeafEnd()
+
+
+// ****************************************************************************
+// J U D Y   L   P A T H
+//
+// See the file comment above.  Returns the number of nodes recorded, which is
+// 0 for an empty array.
+
+FUNCTION Word_t JudyLPath(
+        Pcvoid_t     PArray,            // Judy array to search.
+        Word_t       Index,             // Index to look up.
+        PJudyLPath_t PPath)             // filled in with the nodes read.
+{
+        Pjpm_t       Pjpm;
+        Pjp_t        Pjp;
+
+        PPath->jlp_Count = 0;
+        if (PArray == (Pcvoid_t) NULL) return(0);
+
+// ROOT-LEVEL LEAF:  the population, indexes and values are all in one node.
+
+        if (JU_LEAFW_POP0(PArray) < cJU_LEAFW_MAXPOP1)
+        {
+            Pjlw_t Pjlw = P_JLW(PArray);
+            Word_t pop1 = Pjlw[0] + 1;
+
+            JLP_ADD(PPath, Pjlw, (Word_t) (JL_LEAFWVALUEAREA(Pjlw, pop1) + pop1)
+                                 - (Word_t) Pjlw);
+            return(PPath->jlp_Count);
+        }
+
+        Pjpm = P_JPM(PArray);
+        Pjp  = &(Pjpm->jpm_JP);
+        JLP_ADD(PPath, Pjpm, (Word_t) (Pjp + 1) - (Word_t) Pjpm);
+
+        for (;;)
+        {
+            uint8_t Type = JU_JPTYPE(Pjp);
+
+            if (JLP_ISBRANCHL(Type))
+            {
+                Pjbl_t Pjbl  = P_JBL(Pjp->jp_Addr);
+                uint8_t digit = JLP_BRANCHDIGIT(Index, Type, cJU_JPBRANCH_L2);
+                int    posidx;
+
+                JLP_ADD(PPath, Pjbl, sizeof(jbl_t));
+                for (posidx = 0; posidx < Pjbl->jbl_NumJPs; ++posidx)
+                    if (Pjbl->jbl_Expanse[posidx] == digit) break;
+                if (posidx == Pjbl->jbl_NumJPs) break;
+                Pjp = Pjbl->jbl_jp + posidx;
+                continue;
+            }
+
+            if (JLP_ISBRANCHB(Type))
+            {
+                Pjbb_t    Pjbb    = P_JBB(Pjp->jp_Addr);
+                uint8_t   digit   = JLP_BRANCHDIGIT(Index, Type, cJU_JPBRANCH_B2);
+                Word_t    subexp  = digit / cJU_BITSPERSUBEXPB;
+                BITMAPB_t bitmap;
+                BITMAPB_t bitmask = JU_BITPOSMASKB(digit);
+
+                JLP_ADD(PPath, &(Pjbb->jbb_jbbs[subexp]), sizeof(jbbs_t));
+                bitmap = JU_JBB_BITMAP(Pjbb, subexp);
+                if (! (bitmap & bitmask)) break;
+                Pjp = P_JP(JU_JBB_PJP(Pjbb, subexp));
+                JLP_ADD(PPath, Pjp, j__udyCountBitsB(bitmap) * sizeof(jp_t));
+                Pjp += j__udyCountBitsB(bitmap & (bitmask - 1));
+                continue;
+            }
+
+            if (JLP_ISBRANCHU(Type))
+            {
+                Pjbu_t  Pjbu  = P_JBU(Pjp->jp_Addr);
+                uint8_t digit = JLP_BRANCHDIGIT(Index, Type, cJU_JPBRANCH_U2);
+
+                Pjp = Pjbu->jbu_jp + digit;
+                JLP_ADD(PPath, Pjp, sizeof(jp_t));
+                if (JU_JPTYPE(Pjp) <= cJU_JPNULLMAX) break;
+                continue;
+            }
+
+            if (JLP_ISLEAFL(Type))
+            {
+                Pjll_t Pjll = P_JLL(Pjp->jp_Addr);
+                Word_t pop1 = JU_JPLEAF_POP0(Pjp) + 1;
+
+                JLP_ADD(PPath, Pjll,
+                        (Word_t) j__udyLPathLeafEnd(Pjll, JL_LEAFINDEXSIZE(Type), pop1)
+                        - (Word_t) Pjll);
+                break;
+            }
+
+            if (Type == cJU_JPLEAF_B1)
+            {
+                Pjlb_t    Pjlb    = P_JLB(Pjp->jp_Addr);
+                uint8_t   digit   = JU_DIGITATSTATE(Index, 1);
+                Word_t    subexp  = digit / cJU_BITSPERSUBEXPL;
+                BITMAPL_t bitmap;
+
+                JLP_ADD(PPath, &(Pjlb->jLlb_jLlbs[subexp]), sizeof(jLlbs_t));
+                bitmap = JU_JLB_BITMAP(Pjlb, subexp);
+                if (! (bitmap & JU_BITPOSMASKL(digit))) break;
+                JLP_ADD(PPath, P_JV(JL_JLB_PVALUE(Pjlb, subexp)),
+                        j__udyCountBitsL(bitmap) * cJU_BYTESPERWORD);
+                break;
+            }
+
+            if (JLP_ISIMMED(Type))
+            {
+                Word_t pop1 = j__udyLPathImmedPop1(Type);
+
+                if (pop1 > 1)           // values are outside the JP:
+                    JLP_ADD(PPath, P_JV(Pjp->jp_Addr), pop1 * cJU_BYTESPERWORD);
+                break;
+            }
+
+            break;                      // null or unknown JP type.
+        }
+
+        return(PPath->jlp_Count);
+
+} // JudyLPath()
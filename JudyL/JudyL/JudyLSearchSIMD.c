@@ -0,0 +1,445 @@
+// @(#) JudyLSearchSIMD.c
+//
+// SIMD versions of the leaf and linear branch searches, with runtime CPU
+// dispatch.  Used by the inline j__udySearchLeaf*() routines in JudyPrivate.h
+// and by the JPBRANCH_L* walk in JudyLGet.c, when the build option
+// INTEGER_MAP_JUDY_SIMD_SEARCH is enabled.
+//
+// Each search is reached through a function pointer which initially points to
+// a resolver.  The first call detects the CPU (SSE4.2, AVX2), repoints all of
+// the function pointers, then forwards the call.  On CPUs without SSE4.2 the
+// pointers are set to out-of-line copies of the original scalar searches.
+
+#define JUDYL
+
+#include "JudyL.h"
+
+#if INTEGER_MAP_JUDY_SIMD_SEARCH
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <nmmintrin.h>
+
+// AVX2 intrinsics first appeared in Visual C++ 2012:
+
+#if (! defined(_MSC_VER)) || (_MSC_VER >= 1700)
+#define JU_SIMD_AVX2 1
+#include <immintrin.h>
+#endif
+
+// GCC and Clang only emit SSE4.2/AVX2 instructions in functions which are
+// explicitly marked for them; Visual C++ allows intrinsics anywhere:
+
+#ifdef __GNUC__
+#define JU_TARGET_SSE42 __attribute__((target("sse4.2,popcnt")))
+#define JU_TARGET_AVX2  __attribute__((target("avx2,popcnt")))
+#else
+#define JU_TARGET_SSE42
+#define JU_TARGET_AVX2
+#endif
+
+
+// ****************************************************************************
+// __ J U D Y   C O U N T   T R A I L I N G   Z E R O S
+// __ J U D Y   P O P   C O U N T
+//
+// For masks from movemask.  Mask must be non-zero for the trailing zero count.
+
+#ifdef _MSC_VER
+static __inline Word_t j__udyCountTrailingZeros(unsigned Mask)
+{
+        unsigned long Bit;
+        _BitScanForward(&Bit, Mask);
+        return(Bit);
+}
+#define j__udyPopCount(MASK) ((Word_t) __popcnt(MASK))
+#else
+static inline Word_t j__udyCountTrailingZeros(unsigned Mask)
+{
+        return(__builtin_ctz(Mask));
+}
+#define j__udyPopCount(MASK) ((Word_t) __builtin_popcount(MASK))
+#endif
+
+
+// ****************************************************************************
+// VECTOR LEAF SEARCH
+//
+// Search a sorted leaf of at least one full vector of indexes.  LTMASK(V)
+// returns a byte mask (one bit per byte, as from movemask) of the lanes of V
+// that are less than the key.
+//
+// Rather than stopping at the first vector that reaches the key, which costs
+// a hard-to-predict branch per vector, this counts the indexes less than the
+// key across the whole leaf (at most 2 cache lines).  Since the leaf is
+// sorted, that count is the offset of the key, if present, so one final
+// compare decides between found and not found.
+//
+// The last vector is aligned to the end of the leaf so the search never reads
+// past it.  Where it overlaps the previous vector, the lanes already counted
+// are shifted out of its mask.
+//
+// Returns the same as SEARCHLEAFNATIVE:  the offset of the index if found,
+// otherwise the ones-complement of the offset where it would be inserted.
+
+#define SEARCHLEAFVECTOR(LEAFTYPE,VECTYPE,LOAD,LTMASK,ADDR,POP1,INDEX)  \
+{                                                                       \
+    LEAFTYPE *P_leaf  = (LEAFTYPE *) (ADDR);                            \
+    LEAFTYPE  I_ndex  = (LEAFTYPE) (INDEX); /* truncate hi bits */      \
+    Word_t    l_anes  = sizeof(VECTYPE) / sizeof(LEAFTYPE);             \
+    Word_t    o_ffset = 0;                                              \
+    Word_t    c_ount  = 0;                                              \
+                                                                        \
+    for (; o_ffset + l_anes <= (POP1); o_ffset += l_anes)               \
+        c_ount += j__udyPopCount(                                       \
+            LTMASK(LOAD((VECTYPE *) (P_leaf + o_ffset))));              \
+                                                                        \
+    if (o_ffset < (POP1))                                               \
+    {                                                                   \
+        Word_t o_verlap = o_ffset + l_anes - (POP1);                    \
+        c_ount += j__udyPopCount(                                       \
+            LTMASK(LOAD((VECTYPE *) (P_leaf + (POP1) - l_anes)))        \
+                >> (o_verlap * sizeof(LEAFTYPE)));                      \
+    }                                                                   \
+    c_ount /= sizeof(LEAFTYPE);                                         \
+                                                                        \
+    if ((c_ount < (POP1)) && (P_leaf[c_ount] == I_ndex))                \
+        return((int) c_ount);                                           \
+    return(~(int) c_ount);                                              \
+}
+
+// SSE4.2 "less than" lane masks; K_ey holds the key in every lane.  There is
+// no unsigned compare below 64 bits, so "less than" is "not equal to
+// max(V, key)":
+
+#define SSE_LT8(V)  (~(unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8( \
+                        _mm_max_epu8( (V), K_ey), (V))) & 0xFFFF)
+#define SSE_LT16(V) (~(unsigned) _mm_movemask_epi8(_mm_cmpeq_epi16( \
+                        _mm_max_epu16((V), K_ey), (V))) & 0xFFFF)
+#define SSE_LT32(V) (~(unsigned) _mm_movemask_epi8(_mm_cmpeq_epi32( \
+                        _mm_max_epu32((V), K_ey), (V))) & 0xFFFF)
+
+// 64-bit compares are signed only, so flip the sign bits of both sides:
+
+#define SSE_LT64(V) ((unsigned) _mm_movemask_epi8(_mm_cmpgt_epi64( \
+                        K_eyBiased, _mm_xor_si128((V), S_ignBit))))
+
+// AVX2 equivalents:
+
+#define AVX_LT8(V)  (~(unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8( \
+                        _mm256_max_epu8( (V), K_ey), (V))))
+#define AVX_LT16(V) (~(unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi16( \
+                        _mm256_max_epu16((V), K_ey), (V))))
+#define AVX_LT32(V) (~(unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi32( \
+                        _mm256_max_epu32((V), K_ey), (V))))
+#define AVX_LT64(V) ((unsigned) _mm256_movemask_epi8(_mm256_cmpgt_epi64( \
+                        K_eyBiased, _mm256_xor_si256((V), S_ignBit))))
+
+
+// ****************************************************************************
+// SCALAR FALLBACKS
+//
+// Out-of-line copies of the original searches, for CPUs without SSE4.2.
+
+static int j__udySearchLeaf8Scalar(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
+{ SEARCHLEAFNATIVE(uint8_t,  Pjll, LeafPop1, Index); }
+
+static int j__udySearchLeaf16Scalar(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
+{ SEARCHLEAFNATIVE(uint16_t, Pjll, LeafPop1, Index); }
+
+static int j__udySearchLeaf32Scalar(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
+{ SEARCHLEAFNATIVE(uint32_t, Pjll, LeafPop1, Index); }
+
+#ifdef JU_64BIT
+static int j__udySearchLeaf64Scalar(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
+{ SEARCHLEAFNATIVE(uint64_t, Pjll, LeafPop1, Index); }
+#endif
+
+static int j__udySearchExpanseScalar(const uint8_t * PExpanse, Word_t NumJPs, Word_t Digit)
+{
+        Word_t posidx;
+
+        for (posidx = 0; posidx < NumJPs; ++posidx)
+            if (PExpanse[posidx] == Digit) return((int) posidx);
+
+        return(-1);
+}
+
+
+// ****************************************************************************
+// SSE4.2 SEARCHES
+//
+// The caller guarantees at least cJU_SIMDMINBYTES (one SSE vector) of indexes.
+//
+// The SSE leaf searches are macros so the AVX2 searches below can expand them
+// for small leaves, rather than calling across instruction sets (which can
+// incur an SSE/AVX transition penalty).
+
+#define SEARCHLEAF8SSE(ADDR,POP1,INDEX)                         \
+{                                                               \
+    __m128i K_ey = _mm_set1_epi8((char) (INDEX));               \
+    SEARCHLEAFVECTOR(uint8_t, __m128i, _mm_loadu_si128,         \
+                     SSE_LT8, ADDR, POP1, INDEX)                \
+}
+
+#define SEARCHLEAF16SSE(ADDR,POP1,INDEX)                        \
+{                                                               \
+    __m128i K_ey = _mm_set1_epi16((short) (INDEX));             \
+    SEARCHLEAFVECTOR(uint16_t, __m128i, _mm_loadu_si128,        \
+                     SSE_LT16, ADDR, POP1, INDEX)               \
+}
+
+#define SEARCHLEAF32SSE(ADDR,POP1,INDEX)                        \
+{                                                               \
+    __m128i K_ey = _mm_set1_epi32((int) (INDEX));               \
+    SEARCHLEAFVECTOR(uint32_t, __m128i, _mm_loadu_si128,        \
+                     SSE_LT32, ADDR, POP1, INDEX)               \
+}
+
+#define SEARCHLEAF64SSE(ADDR,POP1,INDEX)                        \
+{                                                               \
+    __m128i S_ignBit   = _mm_set1_epi64x((long long) 0x8000000000000000ULL); \
+    __m128i K_eyBiased = _mm_xor_si128(                         \
+                            _mm_set1_epi64x((long long) (INDEX)), S_ignBit); \
+    SEARCHLEAFVECTOR(uint64_t, __m128i, _mm_loadu_si128,        \
+                     SSE_LT64, ADDR, POP1, INDEX)               \
+}
+
+JU_TARGET_SSE42
+static int j__udySearchLeaf8SSE42(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
+{ SEARCHLEAF8SSE(Pjll, LeafPop1, Index) }
+
+JU_TARGET_SSE42
+static int j__udySearchLeaf16SSE42(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
+{ SEARCHLEAF16SSE(Pjll, LeafPop1, Index) }
+
+JU_TARGET_SSE42
+static int j__udySearchLeaf32SSE42(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
+{ SEARCHLEAF32SSE(Pjll, LeafPop1, Index) }
+
+#ifdef JU_64BIT
+JU_TARGET_SSE42
+static int j__udySearchLeaf64SSE42(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
+{ SEARCHLEAF64SSE(Pjll, LeafPop1, Index) }
+#endif
+
+// Note:  jbl_Expanse[] is followed by the JPs inside the same jbl_t, so an 8
+// byte load from it stays inside the branch; lanes past NumJPs are masked off.
+
+JU_TARGET_SSE42
+static int j__udySearchExpanseSSE42(const uint8_t * PExpanse, Word_t NumJPs, Word_t Digit)
+{
+        __m128i  e_xpanse = _mm_loadl_epi64((const __m128i *) PExpanse);
+        unsigned m_ask    = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(
+                                e_xpanse, _mm_set1_epi8((char) Digit)));
+
+        m_ask &= (1U << NumJPs) - 1;
+        if (m_ask == 0) return(-1);
+        return((int) j__udyCountTrailingZeros(m_ask));
+}
+
+
+// ****************************************************************************
+// AVX2 SEARCHES
+//
+// Leaves with less than one AVX2 vector of indexes use the 128-bit search.
+
+#ifdef JU_SIMD_AVX2
+
+JU_TARGET_AVX2
+static int j__udySearchLeaf8AVX2(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
+{
+        if (LeafPop1 * sizeof(uint8_t) < sizeof(__m256i))
+            SEARCHLEAF8SSE(Pjll, LeafPop1, Index)
+        else
+        {
+            __m256i K_ey = _mm256_set1_epi8((char) Index);
+            SEARCHLEAFVECTOR(uint8_t, __m256i, _mm256_loadu_si256,
+                             AVX_LT8, Pjll, LeafPop1, Index)
+        }
+}
+
+JU_TARGET_AVX2
+static int j__udySearchLeaf16AVX2(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
+{
+        if (LeafPop1 * sizeof(uint16_t) < sizeof(__m256i))
+            SEARCHLEAF16SSE(Pjll, LeafPop1, Index)
+        else
+        {
+            __m256i K_ey = _mm256_set1_epi16((short) Index);
+            SEARCHLEAFVECTOR(uint16_t, __m256i, _mm256_loadu_si256,
+                             AVX_LT16, Pjll, LeafPop1, Index)
+        }
+}
+
+JU_TARGET_AVX2
+static int j__udySearchLeaf32AVX2(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
+{
+        if (LeafPop1 * sizeof(uint32_t) < sizeof(__m256i))
+            SEARCHLEAF32SSE(Pjll, LeafPop1, Index)
+        else
+        {
+            __m256i K_ey = _mm256_set1_epi32((int) Index);
+            SEARCHLEAFVECTOR(uint32_t, __m256i, _mm256_loadu_si256,
+                             AVX_LT32, Pjll, LeafPop1, Index)
+        }
+}
+
+#ifdef JU_64BIT
+JU_TARGET_AVX2
+static int j__udySearchLeaf64AVX2(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
+{
+        if (LeafPop1 * sizeof(uint64_t) < sizeof(__m256i))
+            SEARCHLEAF64SSE(Pjll, LeafPop1, Index)
+        else
+        {
+            __m256i S_ignBit   = _mm256_set1_epi64x((long long) 0x8000000000000000ULL);
+            __m256i K_eyBiased = _mm256_xor_si256(
+                                    _mm256_set1_epi64x((long long) Index), S_ignBit);
+            SEARCHLEAFVECTOR(uint64_t, __m256i, _mm256_loadu_si256,
+                             AVX_LT64, Pjll, LeafPop1, Index)
+        }
+}
+#endif
+
+#endif // JU_SIMD_AVX2
+
+
+// ****************************************************************************
+// __ J U D Y   D E T E C T   S I M D
+//
+// Return 2 for AVX2 (including OS support for the YMM registers), 1 for
+// SSE4.2, otherwise 0.  Both levels also require POPCNT.
+
+static int j__udyDetectSIMD(void)
+{
+        unsigned Regs[4];       // eax, ebx, ecx, edx
+        int      Level = 0;
+
+#ifdef _MSC_VER
+        __cpuid((int *) Regs, 1);
+#else
+        __cpuid(1, Regs[0], Regs[1], Regs[2], Regs[3]);
+#endif
+        if (! (Regs[2] & (1U << 20))) return(0);        // SSE4.2
+        if (! (Regs[2] & (1U << 23))) return(0);        // POPCNT
+        Level = 1;
+
+#ifdef JU_SIMD_AVX2
+        if ((Regs[2] & (1U << 27)) && (Regs[2] & (1U << 28)))  // OSXSAVE, AVX
+        {
+            unsigned long long XCR0;
+#ifdef _MSC_VER
+            XCR0 = _xgetbv(0);
+#else
+            unsigned Lo, Hi;
+            __asm__ __volatile__ ("xgetbv" : "=a" (Lo), "=d" (Hi) : "c" (0));
+            XCR0 = ((unsigned long long) Hi << 32) | Lo;
+#endif
+            if ((XCR0 & 6) == 6)                        // XMM and YMM state
+            {
+#ifdef _MSC_VER
+                __cpuidex((int *) Regs, 7, 0);
+#else
+                __cpuid_count(7, 0, Regs[0], Regs[1], Regs[2], Regs[3]);
+#endif
+                if (Regs[1] & (1U << 5)) Level = 2;     // AVX2
+            }
+        }
+#endif // JU_SIMD_AVX2
+
+        return(Level);
+}
+
+
+// ****************************************************************************
+// RESOLVERS
+//
+// Each function pointer starts out at a resolver, which repoints all of them
+// according to j__udyDetectSIMD() and forwards the call.  Resolving more than
+// once (from racing threads) is harmless.
+
+static void j__udyResolveSearchSIMD(void);
+
+static int j__udySearchLeaf8Resolve(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
+{
+        j__udyResolveSearchSIMD();
+        return((*j__udySearchLeaf8Fn)(Pjll, LeafPop1, Index));
+}
+
+static int j__udySearchLeaf16Resolve(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
+{
+        j__udyResolveSearchSIMD();
+        return((*j__udySearchLeaf16Fn)(Pjll, LeafPop1, Index));
+}
+
+static int j__udySearchLeaf32Resolve(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
+{
+        j__udyResolveSearchSIMD();
+        return((*j__udySearchLeaf32Fn)(Pjll, LeafPop1, Index));
+}
+
+#ifdef JU_64BIT
+static int j__udySearchLeaf64Resolve(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
+{
+        j__udyResolveSearchSIMD();
+        return((*j__udySearchLeaf64Fn)(Pjll, LeafPop1, Index));
+}
+#endif
+
+static int j__udySearchExpanseResolve(const uint8_t * PExpanse, Word_t NumJPs, Word_t Digit)
+{
+        j__udyResolveSearchSIMD();
+        return((*j__udySearchExpanseFn)(PExpanse, NumJPs, Digit));
+}
+
+j__udySearchLeafFn_t    j__udySearchLeaf8Fn   = j__udySearchLeaf8Resolve;
+j__udySearchLeafFn_t    j__udySearchLeaf16Fn  = j__udySearchLeaf16Resolve;
+j__udySearchLeafFn_t    j__udySearchLeaf32Fn  = j__udySearchLeaf32Resolve;
+#ifdef JU_64BIT
+j__udySearchLeafFn_t    j__udySearchLeaf64Fn  = j__udySearchLeaf64Resolve;
+#endif
+j__udySearchExpanseFn_t j__udySearchExpanseFn = j__udySearchExpanseResolve;
+
+static void j__udyResolveSearchSIMD(void)
+{
+        int Level = j__udyDetectSIMD();
+
+        if (Level == 0)
+        {
+            j__udySearchLeaf8Fn   = j__udySearchLeaf8Scalar;
+            j__udySearchLeaf16Fn  = j__udySearchLeaf16Scalar;
+            j__udySearchLeaf32Fn  = j__udySearchLeaf32Scalar;
+#ifdef JU_64BIT
+            j__udySearchLeaf64Fn  = j__udySearchLeaf64Scalar;
+#endif
+            j__udySearchExpanseFn = j__udySearchExpanseScalar;
+            return;
+        }
+
+        j__udySearchLeaf8Fn   = j__udySearchLeaf8SSE42;
+        j__udySearchLeaf16Fn  = j__udySearchLeaf16SSE42;
+        j__udySearchLeaf32Fn  = j__udySearchLeaf32SSE42;
+#ifdef JU_64BIT
+        j__udySearchLeaf64Fn  = j__udySearchLeaf64SSE42;
+#endif
+        j__udySearchExpanseFn = j__udySearchExpanseSSE42;
+
+#ifdef JU_SIMD_AVX2
+        if (Level == 2)
+        {
+            j__udySearchLeaf8Fn   = j__udySearchLeaf8AVX2;
+            j__udySearchLeaf16Fn  = j__udySearchLeaf16AVX2;
+            j__udySearchLeaf32Fn  = j__udySearchLeaf32AVX2;
+#ifdef JU_64BIT
+            j__udySearchLeaf64Fn  = j__udySearchLeaf64AVX2;
+#endif
+        }
+#endif // JU_SIMD_AVX2
+
+} // j__udyResolveSearchSIMD()
+
+#endif // INTEGER_MAP_JUDY_SIMD_SEARCH
@@ -0,0 +1,365 @@
+// @(#) JudyLSerialize.c
+//
+// JudyLSave() and JudyLLoad():  write a JudyL array to a caller-supplied
+// byte stream, and rebuild it from one.
+//
+// The stream holds, in order:
+//
+//   4 bytes   magic, "JLSV"
+//   1 byte    format version, cJLS_VERSION
+//   1 byte    bytes per Word_t when written
+//   varint    population
+//   varint    key delta, then varint value, for each Index in ascending order
+//
+// Each key delta is the Index minus the previous Index (the first is the Index
+// itself), and a varint stores 7 bits per byte, low bits first, with the top
+// bit set on every byte but the last.  So the dense or clustered keys Judy is
+// best at, and small values such as counts, take a byte or two each.
+//
+// JudyLSave() walks the array with a JudyLCursor_t, which returns the same
+// Indexes as JudyLFirst() and JudyLNext() without descending from the root for
+// each one.  JudyLLoad() decodes the whole population into sorted Index and
+// value lists, then builds the array bottom-up with one JudyLInsArray() call,
+// which is much faster than inserting the Indexes one at a time.
+// JudyLInsArray() can only build into an empty array, so the lists cannot be
+// passed to it in smaller chunks; they cost two words per Index, and are freed
+// before JudyLLoad() returns.
+
+#define JUDYL
+
+#include "JudyL.h"
+
+#include "JudyPrivate1L.h"
+
+
+#define cJLS_VERSION    1
+#define cJLS_BUFBYTES   8192            // bytes buffered per Read or Write.
+#define cJLS_MAXVARINT  ((cJU_BITSPERWORD + 6) / 7)  // bytes in a varint.
+
+static const uint8_t j__udyLSaveMagic[4] = { 'J', 'L', 'S', 'V' };
+
+// Buffered stream state, for either direction:
+
+typedef struct J_UDYL_STREAM
+{
+        JudyLWrite_t jls_Write;         // or NULL when loading.
+        JudyLRead_t  jls_Read;          // or NULL when saving.
+        void *       jls_PContext;      // passed to jls_Write or jls_Read.
+        Word_t       jls_Pos;           // next byte in jls_Buf.
+        Word_t       jls_End;           // bytes in jls_Buf, when loading.
+        Word_t       jls_Total;         // bytes passed to jls_Write.
+        uint8_t      jls_Buf[cJLS_BUFBYTES];
+} jls_t, * Pjls_t;
+
+
+// ****************************************************************************
+// __ J U D Y   L   S A V E   F L U S H
+//
+// Pass the buffered bytes to the callers Write function.  Return FALSE if it
+// did not accept all of them.
+
+FUNCTION static bool_t j__udyLSaveFlush(Pjls_t Pjls)
+{
+        Word_t Bytes = Pjls->jls_Pos;
+
+        Pjls->jls_Pos = 0;
+        if (Bytes == 0) return(TRUE);
+        if ((Pjls->jls_Write)(Pjls->jls_Buf, Bytes, Pjls->jls_PContext) != Bytes)
+            return(FALSE);
+        Pjls->jls_Total += Bytes;
+        return(TRUE);
+
+} // j__udyLSaveFlush()
+
+
+// ****************************************************************************
+// __ J U D Y   L   S A V E   V A R I N T
+//
+// Append Value to the buffer as a varint, flushing first if there might not
+// be room.
+
+FUNCTION static bool_t j__udyLSaveVarint(Pjls_t Pjls, Word_t Value)
+{
+        uint8_t * Pbyte;
+
+        if ((Pjls->jls_Pos + cJLS_MAXVARINT > cJLS_BUFBYTES)
+         && (! j__udyLSaveFlush(Pjls)))
+        {
+            return(FALSE);
+        }
+
+        Pbyte = Pjls->jls_Buf + Pjls->jls_Pos;
+
+        while (Value >= 0x80)
+        {
+            *Pbyte++ = (uint8_t) (Value | 0x80);
+            Value >>= 7;
+        }
+        *Pbyte++ = (uint8_t) Value;
+
+        Pjls->jls_Pos = (Word_t) (Pbyte - Pjls->jls_Buf);
+        return(TRUE);
+
+} // j__udyLSaveVarint()
+
+
+// ****************************************************************************
+// __ J U D Y   L   L O A D   B Y T E
+//
+// Return the next byte of the stream, refilling the buffer as needed, or -1
+// at the end of the stream.
+
+FUNCTION static int j__udyLLoadByte(Pjls_t Pjls)
+{
+        if (Pjls->jls_Pos == Pjls->jls_End)
+        {
+            Pjls->jls_Pos = 0;
+            Pjls->jls_End = (Pjls->jls_Read)(Pjls->jls_Buf, cJLS_BUFBYTES,
+                                             Pjls->jls_PContext);
+            if ((Pjls->jls_End == 0) || (Pjls->jls_End > cJLS_BUFBYTES))
+            {
+                Pjls->jls_End = 0;
+                return(-1);
+            }
+        }
+        return(Pjls->jls_Buf[Pjls->jls_Pos++]);
+
+} // j__udyLLoadByte()
+
+
+// ****************************************************************************
+// __ J U D Y   L   L O A D   V A R I N T
+//
+// Decode the next varint into *PValue.  Return FALSE if the stream ends in
+// the middle of it, or it does not fit in a Word_t.
+
+FUNCTION static bool_t j__udyLLoadVarint(Pjls_t Pjls, PWord_t PValue)
+{
+        Word_t Value = 0;
+        int    shift;
+        int    byte;
+
+        for (shift = 0; shift < cJU_BITSPERWORD; shift += 7)
+        {
+            // Fast path:  the byte is already buffered.
+
+            if (Pjls->jls_Pos < Pjls->jls_End)
+                byte = Pjls->jls_Buf[Pjls->jls_Pos++];
+            else if ((byte = j__udyLLoadByte(Pjls)) < 0)
+                return(FALSE);
+
+            Value |= ((Word_t) (byte & 0x7f)) << shift;
+
+            if ((byte & 0x80) == 0)
+            {
+                // Reject bits shifted out of the top of the Word_t:
+
+                if ((shift > cJU_BITSPERWORD - 7)
+                 && ((byte >> (cJU_BITSPERWORD - shift)) != 0))
+                {
+                    return(FALSE);
+                }
+                *PValue = Value;
+                return(TRUE);
+            }
+        }
+        return(FALSE);
+
+} // j__udyLLoadVarint()
+
+
+// ****************************************************************************
+// J U D Y   L   S A V E
+//
+// Return the number of bytes written, or JERR.
+
+FUNCTION Word_t JudyLSave(
+        Pcvoid_t      PArray,   // array to save.
+        JudyLWrite_t  Write,    // callers output function.
+        void *        PContext, // passed to Write.
+        PJError_t     PJError)  // optional, for returning error info.
+{
+        jls_t         jls;
+        JudyLCursor_t cursor;
+        Word_t        pop1;
+        Word_t        Index;
+        Word_t        prevIndex;
+        PPvoid_t      PPValue;
+
+        if (Write == (JudyLWrite_t) NULL)
+        {
+            JU_SET_ERRNO(PJError, JU_ERRNO_NULLPVALUE);
+            return(JERR);
+        }
+
+        if (P_JLW(PArray) == (Pjlw_t) NULL)
+            pop1 = 0;
+        else if (JU_LEAFW_POP0(PArray) < cJU_LEAFW_MAXPOP1)    // a LEAFW.
+            pop1 = JU_LEAFW_POP0(PArray) + 1;
+        else
+            pop1 = P_JPM(PArray)->jpm_Pop0 + 1;
+
+        jls.jls_Write    = Write;
+        jls.jls_Read     = (JudyLRead_t) NULL;
+        jls.jls_PContext = PContext;
+        jls.jls_Pos      = 0;
+        jls.jls_End      = 0;
+        jls.jls_Total    = 0;
+
+        JU_COPYMEM(jls.jls_Buf, j__udyLSaveMagic, 4);
+        jls.jls_Buf[4] = cJLS_VERSION;
+        jls.jls_Buf[5] = cJU_BYTESPERWORD;
+        jls.jls_Pos    = 6;
+
+        if (! j__udyLSaveVarint(&jls, pop1)) goto IOError;
+
+        JudyLCursorInit(&cursor);
+        prevIndex = 0;
+        Index     = 0;
+
+        for (PPValue = JudyLCursorFirst(&cursor, PArray, &Index, PJError);
+             PPValue != (PPvoid_t) NULL;
+             PPValue = JudyLCursorNext(&cursor, PArray, &Index, PJError))
+        {
+            if (PPValue == PPJERR) return(JERR);
+
+            if ((! j__udyLSaveVarint(&jls, Index - prevIndex))
+             || (! j__udyLSaveVarint(&jls, *(PWord_t) PPValue)))
+            {
+                goto IOError;
+            }
+            prevIndex = Index;
+        }
+
+        if (! j__udyLSaveFlush(&jls)) goto IOError;
+        return(jls.jls_Total);
+
+IOError:
+        JU_SET_ERRNO(PJError, JU_ERRNO_IO);
+        return(JERR);
+
+} // JudyLSave()
+
+
+// ****************************************************************************
+// J U D Y   L   L O A D
+//
+// Return the population of the rebuilt array, or JERR.  On error, *PPArray is
+// left empty.
+
+FUNCTION Word_t JudyLLoad(
+        PPvoid_t      PPArray,  // empty array to load into.
+        JudyLRead_t   Read,     // callers input function.
+        void *        PContext, // passed to Read.
+        PJError_t     PJError)  // optional, for returning error info.
+{
+        jls_t         jls;
+        Word_t        pop1;
+        Word_t        offset;
+        Word_t        Index;
+        Word_t        delta;
+        PWord_t       PIndex;
+        PWord_t       PValue;
+        int           byte;
+        int           retcode;
+
+        if (PPArray == (PPvoid_t) NULL)
+        {
+            JU_SET_ERRNO(PJError, JU_ERRNO_NULLPPARRAY);
+            return(JERR);
+        }
+        if (*PPArray != (Pvoid_t) NULL)
+        {
+            JU_SET_ERRNO(PJError, JU_ERRNO_NONNULLPARRAY);
+            return(JERR);
+        }
+        if (Read == (JudyLRead_t) NULL)
+        {
+            JU_SET_ERRNO(PJError, JU_ERRNO_NULLPVALUE);
+            return(JERR);
+        }
+
+        jls.jls_Write    = (JudyLWrite_t) NULL;
+        jls.jls_Read     = Read;
+        jls.jls_PContext = PContext;
+        jls.jls_Pos      = 0;
+        jls.jls_End      = 0;
+        jls.jls_Total    = 0;
+
+// CHECK THE HEADER:
+
+        for (offset = 0; offset < 4; ++offset)
+        {
+            if (j__udyLLoadByte(&jls) != j__udyLSaveMagic[offset])
+                goto BadStream;
+        }
+        if (j__udyLLoadByte(&jls) != cJLS_VERSION)     goto BadStream;
+        if (j__udyLLoadByte(&jls) != cJU_BYTESPERWORD) goto BadStream;
+        if (! j__udyLLoadVarint(&jls, &pop1))          goto BadStream;
+
+        if (pop1 == 0)
+        {
+            // Nothing may follow an empty array:
+
+            if (j__udyLLoadByte(&jls) >= 0) goto BadStream;
+            return(0);
+        }
+
+// DECODE THE INDEXES AND VALUES:
+//
+// A population too large to allocate lists for is taken to be a bad stream;
+// each entry needs at least two bytes, so a genuine one would not fit either.
+
+        if (pop1 > (Word_t) -1 / cJU_BYTESPERWORD) goto BadStream;
+
+        PIndex = (PWord_t) JudyMalloc(pop1);
+        PValue = (PWord_t) JudyMalloc(pop1);
+
+        if ((PIndex == (PWord_t) NULL) || (PValue == (PWord_t) NULL))
+        {
+            if (PIndex != (PWord_t) NULL) JudyFree((Pvoid_t) PIndex, pop1);
+            if (PValue != (PWord_t) NULL) JudyFree((Pvoid_t) PValue, pop1);
+            JU_SET_ERRNO(PJError, JU_ERRNO_NOMEM);
+            return(JERR);
+        }
+
+        Index = 0;
+
+        for (offset = 0; offset < pop1; ++offset)
+        {
+            if ((! j__udyLLoadVarint(&jls, &delta))
+             || (! j__udyLLoadVarint(&jls, PValue + offset)))
+            {
+                break;
+            }
+
+            // After the first, each delta must be nonzero and not wrap:
+
+            if ((offset > 0) && ((delta == 0) || (Index + delta < Index)))
+                break;
+
+            Index += delta;
+            PIndex[offset] = Index;
+        }
+
+        byte = j__udyLLoadByte(&jls);           // must be at the end.
+
+// BUILD THE ARRAY:
+
+        if ((offset == pop1) && (byte < 0))
+            retcode = JudyLInsArray(PPArray, pop1, PIndex, PValue, PJError);
+        else
+            retcode = 0;
+
+        JudyFree((Pvoid_t) PIndex, pop1);
+        JudyFree((Pvoid_t) PValue, pop1);
+
+        if (retcode == JERRI) return(JERR);
+        if (retcode == 0) goto BadStream;
+        return(pop1);
+
+BadStream:
+        JU_SET_ERRNO(PJError, JU_ERRNO_BADSTREAM);
+        return(JERR);
+
+} // JudyLLoad()
@@ -307,7 +307,7 @@ typedef int bool_t;
 
 // A word that is all-ones, normally equal to -1UL, but safer with ~0:
 
-#define cJU_ALLONES  (~0UL)
+#define cJU_ALLONES  (~(Word_t) 0)
 
 // Note, these are forward references, but thats OK:
 
@@ -411,7 +411,7 @@ typedef PWord_t Pjv_t;   // pointer to JudyL value area.
 // processors.
 
 #define JU_LEASTBYTESMASK(BYTES) \
-        ((0x100UL << (cJU_BITSPERBYTE * ((BYTES) - 1))) - 1)
+        (((Word_t) 0x100 << (cJU_BITSPERBYTE * ((BYTES) - 1))) - 1)
 
 #define JU_LEASTBYTES(INDEX,BYTES)  ((INDEX) & JU_LEASTBYTESMASK(BYTES))
 
@@ -580,6 +580,47 @@ extern const uint8_t j__L_BranchBJPPopToWords[];
 
 #endif // SEARCH_BINARY
 
+// SIMD leaf and linear branch search:
+//
+// When INTEGER_MAP_JUDY_SIMD_SEARCH is enabled, leaves with native index sizes
+// (1, 2, 4 [and 8] bytes) and the expanses of linear branches are searched 16
+// or 32 bytes at a time using SSE4.2 or AVX2.  The instruction set is chosen
+// at runtime, on the first search, by resolving the function pointers below;
+// see JudyLSearchSIMD.c.  If neither is available, the pointers resolve to
+// out-of-line copies of SEARCHLEAFNATIVE.
+//
+// Leaves with non-native index sizes (3, 5, 6, 7 bytes) are still searched by
+// SEARCHLEAFNONNAT, and leaves smaller than cJU_SIMDMINBYTES are searched
+// inline, since they fit in less than one vector.
+
+#if INTEGER_MAP_JUDY_SIMD_SEARCH
+
+#define cJU_SIMDMINBYTES 16
+
+typedef int (*j__udySearchLeafFn_t)(Pjll_t Pjll, Word_t LeafPop1, Word_t Index);
+typedef int (*j__udySearchExpanseFn_t)(const uint8_t * PExpanse, Word_t NumJPs, Word_t Digit);
+
+extern j__udySearchLeafFn_t    j__udySearchLeaf8Fn;
+extern j__udySearchLeafFn_t    j__udySearchLeaf16Fn;
+extern j__udySearchLeafFn_t    j__udySearchLeaf32Fn;
+#ifdef JU_64BIT
+extern j__udySearchLeafFn_t    j__udySearchLeaf64Fn;
+#endif
+extern j__udySearchExpanseFn_t j__udySearchExpanseFn;
+
+// Prefix for the inline leaf search routines below; hands large enough leaves
+// to the SIMD search:
+
+#define SEARCHLEAFSIMD(LEAFTYPE,FN,ADDR,POP1,INDEX)              \
+    if ((POP1) * sizeof(LEAFTYPE) >= cJU_SIMDMINBYTES)          \
+        return((*(FN))((Pjll_t) (ADDR), (POP1), (INDEX)));
+
+#else
+
+#define SEARCHLEAFSIMD(LEAFTYPE,FN,ADDR,POP1,INDEX) // null.
+
+#endif // INTEGER_MAP_JUDY_SIMD_SEARCH
+
 // Fast way to count bits set in 8..32[64]-bit int:
 //
 // For performance, j__udyCountBits*() are written to take advantage of
@@ -801,8 +842,8 @@ static inline BITMAPL_t j__udyCountBitsL(BITMAPL_t word)
 //
 // TBD:  Perhaps use an array[32] of masks instead of calculating them.
 
-#define JU_BITPOSMASKB(BITNUM) (1L << ((BITNUM) % cJU_BITSPERSUBEXPB))
-#define JU_BITPOSMASKL(BITNUM) (1L << ((BITNUM) % cJU_BITSPERSUBEXPL))
+#define JU_BITPOSMASKB(BITNUM) ((Word_t) 1 << ((BITNUM) % cJU_BITSPERSUBEXPB))
+#define JU_BITPOSMASKL(BITNUM) ((Word_t) 1 << ((BITNUM) % cJU_BITSPERSUBEXPL))
 
 
 // TEST/SET/CLEAR A BIT IN A BITMAP LEAF:
@@ -1553,14 +1594,20 @@ static __inline int j__udySearchLeaf1(Pjll_t Pjll, Word_t LeafPop1, Word_t Index
 #else
 static inline int j__udySearchLeaf1(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
 #endif
-{ SEARCHLEAFNATIVE(uint8_t,  Pjll, LeafPop1, Index); }
+{
+    SEARCHLEAFSIMD(uint8_t, j__udySearchLeaf8Fn, Pjll, LeafPop1, Index)
+    { SEARCHLEAFNATIVE(uint8_t,  Pjll, LeafPop1, Index); }
+}
 
 #ifdef JU_WIN
 static __inline int j__udySearchLeaf2(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
 #else
 static inline int j__udySearchLeaf2(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
 #endif
-{ SEARCHLEAFNATIVE(uint16_t, Pjll, LeafPop1, Index); }
+{
+    SEARCHLEAFSIMD(uint16_t, j__udySearchLeaf16Fn, Pjll, LeafPop1, Index)
+    { SEARCHLEAFNATIVE(uint16_t, Pjll, LeafPop1, Index); }
+}
 
 #ifdef JU_WIN
 static __inline int j__udySearchLeaf3(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
@@ -1576,7 +1623,10 @@ static __inline int j__udySearchLeaf4(Pjll_t Pjll, Word_t LeafPop1, Word_t Index
 #else
 static inline int j__udySearchLeaf4(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
 #endif
-{ SEARCHLEAFNATIVE(uint32_t, Pjll, LeafPop1, Index); }
+{
+    SEARCHLEAFSIMD(uint32_t, j__udySearchLeaf32Fn, Pjll, LeafPop1, Index)
+    { SEARCHLEAFNATIVE(uint32_t, Pjll, LeafPop1, Index); }
+}
 
 #ifdef JU_WIN
 static __inline int j__udySearchLeaf5(Pjll_t Pjll, Word_t LeafPop1, Word_t Index)
@@ -1606,7 +1656,14 @@ static __inline int j__udySearchLeafW(Pjlw_t Pjlw, Word_t LeafPop1, Word_t Index
 #else
 static inline int j__udySearchLeafW(Pjlw_t Pjlw, Word_t LeafPop1, Word_t Index)
 #endif
-{ SEARCHLEAFNATIVE(Word_t, Pjlw, LeafPop1, Index); }
+{
+#ifdef JU_64BIT
+    SEARCHLEAFSIMD(Word_t, j__udySearchLeaf64Fn, Pjlw, LeafPop1, Index)
+#else
+    SEARCHLEAFSIMD(Word_t, j__udySearchLeaf32Fn, Pjlw, LeafPop1, Index)
+#endif
+    { SEARCHLEAFNATIVE(Word_t, Pjlw, LeafPop1, Index); }
+}
 
 #endif // compiler support for inline
 
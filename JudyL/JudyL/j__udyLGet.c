@@ -213,6 +213,18 @@ ContinueWalk:           // for going down one level; come here with Pjp set.
 JudyBranchL:
             Pjbl = P_JBL(Pjp->jp_Addr);
 
+#if INTEGER_MAP_JUDY_SIMD_SEARCH
+
+            posidx = (*j__udySearchExpanseFn)(Pjbl->jbl_Expanse,
+                                              Pjbl->jbl_NumJPs, Digit);
+            if (posidx < 0) break;
+                                        // found Digit; continue traversal:
+            DBGCODE(ParentJPType = JU_JPTYPE(Pjp);)
+            Pjp = Pjbl->jbl_jp + posidx;
+            goto ContinueWalk;
+
+#else // ! INTEGER_MAP_JUDY_SIMD_SEARCH
+
             posidx = 0;
 
             do {
@@ -225,6 +237,8 @@ JudyBranchL:
             } while (++posidx != Pjbl->jbl_NumJPs);
 
             break;
+
+#endif // INTEGER_MAP_JUDY_SIMD_SEARCH
         }
 
 
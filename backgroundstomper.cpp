@@ -0,0 +1,158 @@
+#include <config.h>
+#include <windows.h>
+#include <intrin.h>
+#include "backgroundstomper.h"
+#include "timer.h"
+#include <memory.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+#if INTEGER_MAP_BACKGROUND_STOMPER && INTEGER_MAP_TWEAK_PRIORITY_AFFINITY && INTEGER_MAP_BACKGROUND_STOMPER_CPU == 0
+#error INTEGER_MAP_BACKGROUND_STOMPER_CPU must not be 0, the first processor, where INTEGER_MAP_TWEAK_PRIORITY_AFFINITY pins the benchmark thread
+#endif
+
+
+#if INTEGER_MAP_BACKGROUND_STOMPER
+//----------------------------------------------
+//  Affinity mask of the INTEGER_MAP_BACKGROUND_STOMPER_CPU'th processor (counting from 0) the process
+//  may run on, or 0 if it has fewer. With every processor allowed, that's processor
+//  INTEGER_MAP_BACKGROUND_STOMPER_CPU itself.
+//----------------------------------------------
+static DWORD_PTR StomperAffinity()
+{
+    DWORD_PTR processMask, systemMask;
+    GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+    for (int i = 0; i < INTEGER_MAP_BACKGROUND_STOMPER_CPU && processMask; i++)
+        processMask &= processMask - 1;     // Clear the lowest processor
+    return processMask & (~processMask + 1);
+}
+#endif
+
+
+//----------------------------------------------
+//  BackgroundStomper::BackgroundStomper
+//----------------------------------------------
+BackgroundStomper::BackgroundStomper()
+{
+    m_mem = NULL;
+    m_bytes = 0;
+    m_affinity = 0;
+    m_thread = NULL;
+    m_stop = 0;
+    m_chunksSwept = 0;
+    m_lastChunks = 0;
+    m_lastTime = 0;
+
+#if INTEGER_MAP_BACKGROUND_STOMPER
+    // Round up to whole chunks, and touch the whole buffer so its pages are committed before the experiment
+    m_bytes = ((size_t) INTEGER_MAP_BACKGROUND_STOMPER_BYTES + kChunkBytes - 1) / kChunkBytes * kChunkBytes;
+    m_mem = new char[m_bytes];
+    memset(m_mem, 0, m_bytes);
+#endif
+}
+
+//----------------------------------------------
+//  BackgroundStomper::~BackgroundStomper
+//----------------------------------------------
+BackgroundStomper::~BackgroundStomper()
+{
+    Stop();
+    delete[] m_mem;
+}
+
+//----------------------------------------------
+//  BackgroundStomper::Start
+//----------------------------------------------
+void BackgroundStomper::Start()
+{
+#if INTEGER_MAP_BACKGROUND_STOMPER
+    if (m_thread)
+        return;
+    m_affinity = StomperAffinity();
+    if (!m_affinity)
+    {
+        fprintf(stderr, "The background stomper needs processor #%d of those this process may run on, but there aren't that many\n", INTEGER_MAP_BACKGROUND_STOMPER_CPU);
+        exit(1);
+    }
+    m_stop = 0;
+    m_chunksSwept = 0;
+    m_lastChunks = 0;
+    m_lastTime = QPC_Timer::Sample();
+    m_thread = CreateThread(NULL, 0, ThreadMain, this, 0, NULL);
+#endif
+}
+
+//----------------------------------------------
+//  BackgroundStomper::Stop
+//----------------------------------------------
+void BackgroundStomper::Stop()
+{
+    if (!m_thread)
+        return;
+    InterlockedExchange(&m_stop, 1);
+    WaitForSingleObject(m_thread, INFINITE);
+    CloseHandle(m_thread);
+    m_thread = NULL;
+}
+
+//----------------------------------------------
+//  BackgroundStomper::TakeBandwidth
+//----------------------------------------------
+double BackgroundStomper::TakeBandwidth()
+{
+    if (!m_thread)
+        return 0;
+    ULONG chunks = (ULONG) m_chunksSwept;
+    LONGLONG now = QPC_Timer::Sample();
+    double seconds = (double) (now - m_lastTime) / QPC_Timer::frequency;
+    double mbps = seconds > 0 ? (double) (ULONG) (chunks - m_lastChunks) * kChunkBytes / 1000000.0 / seconds : 0;
+    m_lastChunks = chunks;
+    m_lastTime = now;
+    return mbps;
+}
+
+//----------------------------------------------
+//  BackgroundStomper::ThreadMain
+//----------------------------------------------
+DWORD WINAPI BackgroundStomper::ThreadMain(LPVOID param)
+{
+#if INTEGER_MAP_BACKGROUND_STOMPER
+    SetThreadAffinityMask(GetCurrentThread(), ((BackgroundStomper*) param)->m_affinity);
+#endif
+    ((BackgroundStomper*) param)->Sweep();
+    return 0;
+}
+
+//----------------------------------------------
+//  BackgroundStomper::Sweep
+//----------------------------------------------
+void BackgroundStomper::Sweep()
+{
+#if INTEGER_MAP_BACKGROUND_STOMPER_MBPS > 0
+    LONGLONG ticksPerChunk = (LONGLONG) ((double) kChunkBytes / (INTEGER_MAP_BACKGROUND_STOMPER_MBPS * 1000000.0) * QPC_Timer::frequency);
+    LONGLONG due = QPC_Timer::Sample();
+#endif
+    size_t ofs = 0;
+    ULONGLONG chunks = 0;
+    while (!m_stop)
+    {
+        // Increment one int in each cache line of the next chunk
+        for (size_t end = ofs + kChunkBytes; ofs < end; ofs += kCacheLineSize)
+            (*(volatile int*) (m_mem + ofs))++;
+        if (ofs >= m_bytes)
+            ofs = 0;
+        InterlockedExchange(&m_chunksSwept, (LONG) (ULONG) ++chunks);
+
+#if INTEGER_MAP_BACKGROUND_STOMPER_MBPS > 0
+        // Spin until this chunk's time slot is over. If the thread fell behind, say because it was
+        // preempted, restart the schedule from now instead of bursting to catch up.
+        due += ticksPerChunk;
+        LONGLONG now = 0;
+        while (!m_stop && (now = QPC_Timer::Sample()) < due)
+            YieldProcessor();
+        if (now - due > ticksPerChunk)
+            due = now;
+#endif
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+
+//----------------------------------------------
+//  BackgroundStomper
+//
+//  A noisy neighbor for the INSERT and LOOKUP experiments. Between Start() and Stop(), a thread
+//  pinned to the INTEGER_MAP_BACKGROUND_STOMPER_CPU'th logical processor the process may run on
+//  (processor INTEGER_MAP_BACKGROUND_STOMPER_CPU itself, unless the launcher restricted it) sweeps a buffer of
+//  INTEGER_MAP_BACKGROUND_STOMPER_BYTES over and over, incrementing one int in every cache line.
+//  It competes with the benchmark thread for the shared caches and memory bandwidth, the way
+//  another process on the same machine would, rather than running between operations like CacheStomper.
+//  If INTEGER_MAP_BACKGROUND_STOMPER_MBPS is nonzero, the thread spins between chunks to hold its
+//  rate to that many MB/s; otherwise it runs flat out.
+//  TakeBandwidth() returns the MB/s of cache lines actually swept since Start() or the previous call.
+//  Each swept line is read and written back, so the memory traffic can be up to twice that.
+//  Without INTEGER_MAP_BACKGROUND_STOMPER, it allocates nothing and every method does nothing.
+//----------------------------------------------
+class BackgroundStomper
+{
+private:
+    static const size_t kCacheLineSize = 64;
+    static const size_t kChunkBytes = 4096;     // Swept between checks of the rate and the stop flag
+
+    char* m_mem;
+    size_t m_bytes;
+    DWORD_PTR m_affinity;           // The stomper thread's processor
+    HANDLE m_thread;
+    volatile LONG m_stop;
+    volatile LONG m_chunksSwept;    // Since Start(); wraps around, so only differences are meaningful
+    ULONG m_lastChunks;             // m_chunksSwept at the previous TakeBandwidth()
+    LONGLONG m_lastTime;            // QPC_Timer::Sample() at the previous TakeBandwidth()
+
+    static DWORD WINAPI ThreadMain(LPVOID param);
+    void Sweep();
+
+public:
+    BackgroundStomper();
+    ~BackgroundStomper();
+
+    void Start();
+    void Stop();
+    double TakeBandwidth();
+};
@@ -1,10 +1,48 @@
 #pragma once
 
-#include "mersennetwister.h"
+#include "xoshiro.h"
+#include <vector>
+#include <intrin.h>
+#include <immintrin.h>
+
+
+//---------------------------------------------------
+// CachePath
+//
+// The memory one lookup reads, as a list of nodes: for Judy, one per node on
+// the way down from the root, and for HashTable, the runs of cells probed.
+// Filled in by MAP_LOOKUP_PATH, for INTEGER_MAP_COLD_CACHE.
+//---------------------------------------------------
+struct CachePath
+{
+    static const int kMaxNodes = 24;
+
+    int count;
+    const void* addr[kMaxNodes];
+    size_t bytes[kMaxNodes];
+
+    CachePath() : count(0) {}
+
+    void Add(const void* a, size_t b)
+    {
+        if (count < kMaxNodes)
+        {
+            addr[count] = a;
+            bytes[count++] = b;
+        }
+    }
+};
 
 
 //---------------------------------------------------
 // CacheStomper ENABLED
+//
+// With INTEGER_MAP_CACHE_STOMPER_PATTERN(PAGES), each random stomp touches
+// one cache line in each of stompSize different 4 KB pages, instead of about
+// stompSize bytes of consecutive lines.
+// PrepareRandomStomps draws the positions and lengths of the next random
+// stomps up front, so that no random numbers are generated between the
+// timed operations.
 //---------------------------------------------------
 class CacheStomper
 {
@@ -12,24 +50,88 @@ private:
     static const int kArrayLength = 0x2000000;  // 32 MB (must be power of 2)
     static const int kCacheLineSize = 64;
     static const int kStep = kCacheLineSize / sizeof(int);
+    static const int kPageSize = 4096;
+    static const int kPageStep = kPageSize / sizeof(int);
+    static const int kPageStride = 17 * kPageStep;  // Odd, so it visits every page before repeating
 
     int* m_mem;
     float m_cacheLinesPerRandomStomp;
-    MersenneTwister m_random;
+    int m_pagesPerRandomStomp;
+    Xoshiro256 m_random;
+
+    // A random stomp: lines or pages to touch, from ofs
+    struct RandomStompArgs
+    {
+        size_t ofs;
+        size_t length;
+    };
+    std::vector<RandomStompArgs> m_prepared;
+    size_t m_nextPrepared;
+    int* m_thrashMem;       // For Thrash(); allocated on first use
+    size_t m_thrashLength;
+
+    static bool HasClflushopt()
+    {
+        int regs[4];
+        __cpuid(regs, 0);
+        if ((unsigned) regs[0] < 7)
+            return false;   // No leaf 7 to ask
+        __cpuidex(regs, 7, 0);
+        return (regs[1] & (1 << 23)) != 0;
+    }
+
+    static __int64 TimeLoad(const void* p)
+    {
+        // Fence on both sides, so only the load itself is timed
+        unsigned int aux;
+        _mm_mfence();
+        _mm_lfence();
+        __int64 start = __rdtscp(&aux);
+        *(volatile const char*) p;
+        __int64 end = __rdtscp(&aux);
+        _mm_lfence();
+        return end - start;
+    }
+
+    static __int64 CalibrateResidentTicks()
+    {
+        // Halfway between the fastest load from L1 and the fastest load from memory.
+        // Anything quicker came from some level of cache.
+        static char line[kCacheLineSize * 2];
+        char* p = (char*) (((size_t) line + kCacheLineSize - 1) & ~(size_t) (kCacheLineSize - 1));
+        __int64 hit = 0x7fffffff, miss = 0x7fffffff;
+        for (int i = 0; i < 32; i++)
+        {
+            *(volatile char*) p;
+            __int64 t = TimeLoad(p);
+            if (t < hit)
+                hit = t;
+            _mm_clflush(p);
+            t = TimeLoad(p);
+            if (t < miss)
+                miss = t;
+        }
+        return (hit + miss) / 2;
+    }
 
 public:
-    CacheStomper(int bytesPerRandomStomp)
+    CacheStomper(int stompSize)
     {
         m_mem = new int[kArrayLength];
-        m_cacheLinesPerRandomStomp = (float) bytesPerRandomStomp / kCacheLineSize;
+        m_cacheLinesPerRandomStomp = (float) stompSize / kCacheLineSize;
+        m_pagesPerRandomStomp = stompSize;
         // Touch the whole array
         for (int ofs = 0; ofs < kArrayLength; ofs += kStep)
             m_mem[ofs]++;
+        m_thrashMem = NULL;
+        m_thrashLength = 0;
+        m_nextPrepared = 0;
     }
 
     ~CacheStomper()
     {
         delete[] m_mem;
+        delete[] m_thrashMem;
     }
 
     void Seed(int seed)
@@ -51,12 +153,56 @@ public:
         }
     }
 
+    // Touch one line in each of pageCount distinct pages, spread out so the hardware can't
+    // prefetch their translations. That evicts TLB entries while moving only one line per page
+    // through the cache, and since the lines share their offset in the page, they mostly
+    // compete for the same few L1 sets.
+    void StompPages(size_t ofs, size_t pageCount)
+    {
+        ofs &= kArrayLength - 1;
+        if (pageCount > kArrayLength / kPageStep)
+            pageCount = kArrayLength / kPageStep;
+        while (pageCount-- > 0)
+        {
+            m_mem[ofs]++;
+            ofs = (ofs + kPageStride) & (kArrayLength - 1);
+        }
+    }
+
+    RandomStompArgs NextRandomStompArgs()
+    {
+        RandomStompArgs args;
+        args.ofs = m_random.integer() & (kArrayLength - 1);
+#if INTEGER_MAP_CACHE_STOMPER_PATTERN(PAGES)
+        args.ofs &= ~(size_t) (kStep - 1);
+        args.length = m_pagesPerRandomStomp;
+#else
+        args.length = (int) (m_random.expoVariate(m_cacheLinesPerRandomStomp) + 0.5f);
+#endif
+        return args;
+    }
+
+    // Draw the next count random stomps now, before the operations they go between are timed
+    void PrepareRandomStomps(size_t count)
+    {
+#if INTEGER_MAP_CACHE_STOMPER_ENABLED
+        m_prepared.resize(count);
+        for (size_t i = 0; i < count; i++)
+            m_prepared[i] = NextRandomStompArgs();
+        m_nextPrepared = 0;
+#endif
+    }
+
     void RandomStomp()
     {
 #if INTEGER_MAP_CACHE_STOMPER_ENABLED
-        size_t ofs = m_random.integer() & (kArrayLength - 1);
-        size_t length = (int) (m_random.expoVariate(m_cacheLinesPerRandomStomp) + 0.5f);
-        Stomp(ofs, length);
+        // Falls back to drawing one now if the prepared ones have run out
+        RandomStompArgs args = m_nextPrepared < m_prepared.size() ? m_prepared[m_nextPrepared++] : NextRandomStompArgs();
+#if INTEGER_MAP_CACHE_STOMPER_PATTERN(PAGES)
+        StompPages(args.ofs, args.length);
+#else
+        Stomp(args.ofs, args.length);
+#endif
 #endif
     }
 
@@ -65,4 +211,85 @@ public:
         for (int ofs = 0; ofs < kArrayLength; ofs += kStep)
             m_mem[ofs]++;
     }
+
+    // Size of the largest data or unified cache, from CPUID leaf 4 (Intel) or 0x8000001D (AMD),
+    // or 32 MB if neither is supported.
+    static size_t LastLevelCacheSize()
+    {
+        static const unsigned leaves[] = { 4, 0x8000001D };
+        size_t largest = 0;
+        for (int l = 0; l < 2 && largest == 0; l++)
+        {
+            int regs[4];
+            __cpuid(regs, (int) (leaves[l] & 0x80000000));
+            if ((unsigned) regs[0] < leaves[l])
+                continue;
+            for (int sub = 0;; sub++)
+            {
+                __cpuidex(regs, (int) leaves[l], sub);
+                int type = regs[0] & 0x1f;
+                if (type == 0)
+                    break;
+                if (type == 2)
+                    continue;   // Instruction cache
+                size_t ways = ((unsigned) regs[1] >> 22) + 1;
+                size_t partitions = (((unsigned) regs[1] >> 12) & 0x3ff) + 1;
+                size_t lineSize = (regs[1] & 0xfff) + 1;
+                size_t sets = (size_t) (unsigned) regs[2] + 1;
+                size_t size = ways * partitions * lineSize * sets;
+                if (size > largest)
+                    largest = size;
+            }
+        }
+        return largest ? largest : 0x2000000;
+    }
+
+    // Sweep a buffer twice the size of the last-level cache, which leaves
+    // little of anything else in any level of cache
+    void Thrash()
+    {
+        if (!m_thrashMem)
+        {
+            m_thrashLength = LastLevelCacheSize() * 2 / sizeof(int);
+            m_thrashMem = new int[m_thrashLength];
+        }
+        for (size_t ofs = 0; ofs < m_thrashLength; ofs += kStep)
+            m_thrashMem[ofs]++;
+    }
+
+    // Evict every cache line of each node in path from every level of cache,
+    // using CLFLUSHOPT where the CPU has it
+    static void Flush(const CachePath& path)
+    {
+        static const bool clflushopt = HasClflushopt();
+        for (int n = 0; n < path.count; n++)
+        {
+            size_t line = (size_t) path.addr[n] & ~(size_t) (kCacheLineSize - 1);
+            size_t end = (size_t) path.addr[n] + path.bytes[n];
+            for (; line < end; line += kCacheLineSize)
+            {
+                if (clflushopt)
+                    _mm_clflushopt((void*) line);
+                else
+                    _mm_clflush((void*) line);
+            }
+        }
+        // CLFLUSHOPT is only ordered by fences
+        _mm_mfence();
+    }
+
+    // Count the nodes in path whose first cache line is still cached, in lookup order,
+    // by timing a load from each. Loading them brings them into the cache, so a path
+    // can only be checked once.
+    static int CountResident(const CachePath& path)
+    {
+        static const __int64 residentTicks = CalibrateResidentTicks();
+        int resident = 0;
+        for (int n = 0; n < path.count; n++)
+        {
+            if (TimeLoad(path.addr[n]) < residentTicks)
+                resident++;
+        }
+        return resident;
+    }
 };
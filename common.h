@@ -7,8 +7,9 @@
 #include <intrin.h>
 #include "mersennetwister.h"
 #include "cachestomper.h"
+#include "backgroundstomper.h"
 #include "timer.h"
-#include "randomsequence.h"
+#include "keysequence.h"
 
 
 #if INTEGER_MAP_USE_DLMALLOC
@@ -30,9 +31,32 @@ inline void operator delete(void* p) { return dlfree(p); }
     #define MAP_INCREMENT(key)  { Pvoid_t value; \
                                 JLI(value, judy, (key)); \
                                 (*(size_t*) value)++; }
+    #if INTEGER_MAP_JUDY_FREE_METHOD(ASYNC)
+    #define MAP_CLEAR()         { Word_t Rc_word; \
+                                JLFAA(Rc_word, judy, INTEGER_MAP_JUDY_FREE_THREADS); \
+                                judy = NULL; }
+    #elif INTEGER_MAP_JUDY_FREE_METHOD(PARALLEL)
+    #define MAP_CLEAR()         { Word_t Rc_word; \
+                                JLFAP(Rc_word, judy, INTEGER_MAP_JUDY_FREE_THREADS); \
+                                judy = NULL; }
+    #else
     #define MAP_CLEAR()         { Word_t Rc_word; \
                                 JLFA(Rc_word, judy); \
                                 judy = NULL; }
+    #endif
+    #if INTEGER_MAP_JUDY_CURSOR
+    #define MAP_ITERATE(sum)    { Word_t index = 0; Pvoid_t value; \
+                                JudyLCursor_t cursor; \
+                                JudyLCursorInit(&cursor); \
+                                JLCF(value, cursor, judy, index); \
+                                while (value) { (sum) += *(size_t*) value; \
+                                    JLCN(value, cursor, judy, index); } }
+    #else
+    #define MAP_ITERATE(sum)    { Word_t index = 0; Pvoid_t value; \
+                                JLF(value, judy, index); \
+                                while (value) { (sum) += *(size_t*) value; \
+                                    JLN(value, judy, index); } }
+    #endif
 
 #elif INTEGER_MAP_CONTAINER(TABLE)
     #include "hashtable.h"
@@ -42,16 +66,128 @@ inline void operator delete(void* p) { return dlfree(p); }
     #define MAP_INCREMENT(key)  ht.Insert(key)->value++
     #define MAP_CLEAR()         { ht.Clear(); \
                                 ht.Compact(); }
+    #define MAP_ITERATE(sum)    { for (HashTable::Iterator it(ht); *it; it.Next()) \
+                                    (sum) += it->value; }
+
+#elif INTEGER_MAP_CONTAINER(STD_UNORDERED_MAP)
+    #include <unordered_map>
+
+    #define MAP_DECLARE         std::unordered_map<size_t, size_t> umap
+    #define MAP_INITIALIZE()
+    #define MAP_INCREMENT(key)  umap[key]++
+    #define MAP_CLEAR()         { std::unordered_map<size_t, size_t>().swap(umap); }
+    #define MAP_ITERATE(sum)    { for (std::unordered_map<size_t, size_t>::const_iterator it = umap.begin(); it != umap.end(); ++it) \
+                                    (sum) += it->second; }
+
+#elif INTEGER_MAP_CONTAINER(STD_MAP)
+    #include <map>
+
+    #define MAP_DECLARE         std::map<size_t, size_t> smap
+    #define MAP_INITIALIZE()
+    #define MAP_INCREMENT(key)  smap[key]++
+    #define MAP_CLEAR()         { smap.clear(); }
+    #define MAP_ITERATE(sum)    { for (std::map<size_t, size_t>::const_iterator it = smap.begin(); it != smap.end(); ++it) \
+                                    (sum) += it->second; }
+
+#elif INTEGER_MAP_CONTAINER(DENSE_HASH)
+    #include "densehashtable.h"
+
+    #define MAP_DECLARE         DenseHashTable dht
+    #define MAP_INITIALIZE()
+    #define MAP_INCREMENT(key)  dht.Insert(key)->value++
+    #define MAP_CLEAR()         { dht.Clear(); \
+                                dht.Compact(); }
+
+#elif INTEGER_MAP_CONTAINER(CUCKOO_TABLE)
+    #include "cuckoohashtable.h"
+
+    #define MAP_DECLARE         CuckooHashTable cht
+    #define MAP_INITIALIZE()
+    #define MAP_INCREMENT(key)  cht.Insert(key)->value++
+    #define MAP_CLEAR()         { cht.Clear(); \
+                                cht.Compact(); }
+    #define MAP_ITERATE(sum)    { for (CuckooHashTable::Iterator it(cht); *it; it.Next()) \
+                                    (sum) += it->value; }
+
+#elif INTEGER_MAP_CONTAINER(SHARDED_TABLE) || INTEGER_MAP_CONTAINER(LOCKED_TABLE)
+    #include "shardedhashtable.h"
+
+    // LOCKED_TABLE is a single shard: one HashTable behind one lock
+    typedef ShardedHashTable ConcurrentMap;
+    #if INTEGER_MAP_CONTAINER(SHARDED_TABLE)
+    #define MAP_DECLARE         ConcurrentMap cmap(INTEGER_MAP_TABLE_SHARD_BITS)
+    #else
+    #define MAP_DECLARE         ConcurrentMap cmap(0)
+    #endif
+    #define MAP_INITIALIZE()
+    #define MAP_INCREMENT(key)  cmap.Increment(key)
+    #define MAP_CLEAR()         { cmap.Clear(); \
+                                cmap.Compact(); }
+    #define MAP_ITERATE(sum)    { for (size_t s = 0; s < cmap.ShardCount(); s++) \
+                                    for (HashTable::Iterator it(cmap.ShardTable(s)); *it; it.Next()) \
+                                        (sum) += it->value; }
+
+#elif INTEGER_MAP_CONTAINER(LOCKFREE_TABLE)
+    #include "lockfreehashtable.h"
+
+    // Can't grow, so it's sized for every key up front
+    typedef LockFreeHashTable ConcurrentMap;
+    #define MAP_DECLARE         ConcurrentMap cmap(g_Params.keyCount)
+    #define MAP_INITIALIZE()
+    #define MAP_INCREMENT(key)  cmap.Increment(key)
+    #define MAP_CLEAR()         { cmap.Clear(); }
+    #define MAP_ITERATE(sum)    { for (LockFreeHashTable::Iterator it(cmap); *it; it.Next()) \
+                                    (sum) += it->value; }
 
 #else
     #define MAP_DECLARE         
     #define MAP_INITIALIZE()
     #define MAP_INCREMENT(key)  
     #define MAP_CLEAR()
+    #define MAP_ITERATE(sum)
+
+#endif
+
+// Waits for the worker threads of a MAP_CLEAR that returned before the map was freed, so they
+// don't compete with whatever runs next, or still be freeing when the process exits
+#if INTEGER_MAP_CONTAINER(JUDY) && INTEGER_MAP_JUDY_FREE_METHOD(ASYNC)
+    #define MAP_CLEAR_WAIT()                JudyLFreeArrayWait()
+#else
+    #define MAP_CLEAR_WAIT()
+#endif
+
+// HashTable internals, gathered into a ResultHolder at each marker
+#if INTEGER_MAP_TABLE_STATS && INTEGER_MAP_CONTAINER(TABLE)
+    #define MAP_RESET_LOOKUP_STATS()        ht.ResetLookupStats()
+    #define MAP_GATHER_STATS(rh, n)         { (rh).tableStats.push_back(ResultHolder::TableStats()); \
+                                            (rh).tableStats.back().marker = (n); \
+                                            ht.GetStats((rh).tableStats.back().stats); \
+                                            ht.ResetLookupStats(); }
+#elif INTEGER_MAP_CONTAINER(CUCKOO_TABLE)
+    // CuckooHashTable's counters are cheap, so they're always on
+    #define MAP_RESET_LOOKUP_STATS()
+    #define MAP_GATHER_STATS(rh, n)         { (rh).cuckooStats.push_back(ResultHolder::CuckooStats()); \
+                                            (rh).cuckooStats.back().marker = (n); \
+                                            cht.GetStats((rh).cuckooStats.back().stats); }
+#else
+    #define MAP_RESET_LOOKUP_STATS()
+    #define MAP_GATHER_STATS(rh, n)
+#endif
 
+// The memory a lookup of key reads, as a CachePath, for INTEGER_MAP_COLD_CACHE
+#if INTEGER_MAP_CONTAINER(JUDY)
+    #define MAP_LOOKUP_PATH(key, path)      { JudyLPath_t judyPath; \
+                                            JudyLPath(judy, (key), &judyPath); \
+                                            for (Word_t n = 0; n < judyPath.jlp_Count; n++) \
+                                                (path).Add(judyPath.jlp_Addr[n], judyPath.jlp_Bytes[n]); }
+#elif INTEGER_MAP_CONTAINER(TABLE)
+    #define MAP_LOOKUP_PATH(key, path)      { const HashTable::Cell* runs[2]; size_t runLengths[2]; \
+                                            int runCount = ht.GetProbeRuns((key), runs, runLengths); \
+                                            for (int n = 0; n < runCount; n++) \
+                                                (path).Add(runs[n], runLengths[n] * sizeof(HashTable::Cell)); }
 #endif
 
-void GenerateKeys(std::vector<size_t>& m_keys, int keyCount, int M);
+void GenerateKeys(KeySequence& keys, size_t keyCount, int M);
 
 
 //---------------------------------------------------
@@ -61,12 +197,21 @@ struct TestParams
 {
     int seed;
     int operationsPerGroup;
-    int keyCount;
+    size_t keyCount;
     int granularity;
     int stompBytes;
     MersenneTwister random;
 
-    void DefineMarkers(std::vector<int>& markers);
+    void DefineMarkers(std::vector<size_t>& markers);
+
+    // A random index below n, using a second number from random when n needs more than 32 bits
+    size_t RandomIndex(size_t n)
+    {
+        if (n <= 0xffffffffu)
+            return random.integer() % n;
+        unsigned long long r = ((unsigned long long) random.integer() << 32) | random.integer();
+        return (size_t) (r % n);
+    }
 };
 
 extern TestParams g_Params;
@@ -76,11 +221,43 @@ struct ResultHolder
 {
     struct Result
     {
-        int marker;
+        size_t marker;
         double nanosecs;
     };
 
     std::vector<Result> results;
+    std::vector<Result> teardown;   // MAP_CLEAR time per item, where measured
+    std::vector<Result> warmup;     // Lookup time just after mapping a snapshot
+    std::vector<Result> load;       // Time per item to load a saved map
+    std::vector<Result> filesize;   // Bytes in a saved map's file
+    std::vector<Result> hashtime;   // Time to compute tableHash alone
+#if INTEGER_MAP_BACKGROUND_STOMPER
+    std::vector<Result> stompBandwidth; // MB/s swept by BackgroundStomper, in place of nanosecs
+#endif
+#if !INTEGER_MAP_COLD_CACHE(NONE)
+    std::vector<Result> resident;   // Nodes of a lookup's path still cached after eviction, in place of nanosecs
+    std::vector<Result> pathNodes;  // Nodes in a lookup's path
+#endif
+
+#if INTEGER_MAP_TABLE_STATS && INTEGER_MAP_CONTAINER(TABLE)
+    struct TableStats
+    {
+        size_t marker;
+        HashTable::Stats stats;
+    };
+
+    std::vector<TableStats> tableStats; // See MAP_GATHER_STATS
+#endif
+
+#if INTEGER_MAP_CONTAINER(CUCKOO_TABLE)
+    struct CuckooStats
+    {
+        size_t marker;
+        CuckooHashTable::Stats stats;
+    };
+
+    std::vector<CuckooStats> cuckooStats;   // See MAP_GATHER_STATS
+#endif
 
     void dump();
 };
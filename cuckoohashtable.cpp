@@ -0,0 +1,363 @@
+#include <config.h>
+#include "cuckoohashtable.h"
+#include "util.h"
+#include <assert.h>
+#include <memory.h>
+
+
+// Keys are hashed again with this mixed in to pick their second bucket
+#define SECOND_HASH_SEED ((size_t) 0x9e3779b97f4a7c15ull)
+
+// Rounds p up to the next bucket; new[] only guarantees word alignment
+#define ALIGN_TO_BUCKET(p) (((size_t) (p) + CuckooHashTable::kBucketBytes - 1) & ~(CuckooHashTable::kBucketBytes - 1))
+
+
+//----------------------------------------------
+//  CuckooHashTable::CuckooHashTable
+//----------------------------------------------
+CuckooHashTable::CuckooHashTable(size_t initialBuckets)
+{
+    // Initialize buckets
+    assert(initialBuckets > 0 && (initialBuckets & (initialBuckets - 1)) == 0);   // Must be a power of 2
+    m_memory = new char[initialBuckets * sizeof(Bucket) + kBucketBytes - 1];
+    m_buckets = (Bucket*) ALIGN_TO_BUCKET(m_memory);
+    memset(m_buckets, 0, initialBuckets * sizeof(Bucket));
+    m_bucketMask = initialBuckets - 1;
+    m_population = 0;
+
+    // Initialize zero cell
+    m_zeroUsed = 0;
+    m_zeroCell.key = 0;
+    m_zeroCell.value = 0;
+
+    m_insertFailures = 0;
+    m_rehashes = 0;
+    m_displacements = 0;
+}
+
+//----------------------------------------------
+//  CuckooHashTable::~CuckooHashTable
+//----------------------------------------------
+CuckooHashTable::~CuckooHashTable()
+{
+    delete[] m_memory;
+}
+
+//----------------------------------------------
+//  CuckooHashTable::FirstBucket
+//----------------------------------------------
+size_t CuckooHashTable::FirstBucket(size_t key) const
+{
+    return (size_t) integerHash(key) & m_bucketMask;
+}
+
+//----------------------------------------------
+//  CuckooHashTable::SecondBucket
+//----------------------------------------------
+size_t CuckooHashTable::SecondBucket(size_t key) const
+{
+    return (size_t) integerHash(key ^ SECOND_HASH_SEED) & m_bucketMask;
+}
+
+//----------------------------------------------
+//  CuckooHashTable::Lookup
+//----------------------------------------------
+CuckooHashTable::Cell* CuckooHashTable::Lookup(size_t key)
+{
+    if (key)
+    {
+        // Check both buckets
+        Bucket& first = m_buckets[FirstBucket(key)];
+        for (size_t s = 0; s < kSlotsPerBucket; s++)
+        {
+            if (first.cells[s].key == key)
+                return &first.cells[s];
+        }
+        Bucket& second = m_buckets[SecondBucket(key)];
+        for (size_t s = 0; s < kSlotsPerBucket; s++)
+        {
+            if (second.cells[s].key == key)
+                return &second.cells[s];
+        }
+        return NULL;
+    }
+    else
+    {
+        // Check zero cell
+        if (m_zeroUsed)
+            return &m_zeroCell;
+        return NULL;
+    }
+}
+
+//----------------------------------------------
+//  CuckooHashTable::Insert
+//----------------------------------------------
+CuckooHashTable::Cell* CuckooHashTable::Insert(size_t key)
+{
+    if (key)
+    {
+        Cell* cell = Lookup(key);
+        if (cell)
+            return cell;        // Found
+
+        for (;;)
+        {
+            cell = Place(key);
+            if (cell)
+            {
+                m_population++;
+                return cell;
+            }
+
+            // No room within reach. Time to resize
+            m_insertFailures++;
+            Repopulate((m_bucketMask + 1) * 2);
+        }
+    }
+    else
+    {
+        // Check zero cell
+        if (!m_zeroUsed)
+        {
+            // Insert here
+            m_zeroUsed = true;
+            m_population++;
+        }
+        return &m_zeroCell;
+    }
+}
+
+//----------------------------------------------
+//  CuckooHashTable::FreeCell
+//----------------------------------------------
+CuckooHashTable::Cell* CuckooHashTable::FreeCell(size_t bucket)
+{
+    Bucket& b = m_buckets[bucket];
+    for (size_t s = 0; s < kSlotsPerBucket; s++)
+    {
+        if (!b.cells[s].key)
+            return &b.cells[s];
+    }
+    return NULL;
+}
+
+//----------------------------------------------
+//  CuckooHashTable::Place
+//----------------------------------------------
+CuckooHashTable::Cell* CuckooHashTable::Place(size_t key)
+{
+    // Returns the cell the new key went in, or NULL if both its buckets are full and can't be made room in
+    Cell* cell = FreeCell(FirstBucket(key));
+    if (!cell)
+        cell = FreeCell(SecondBucket(key));
+    if (!cell)
+        cell = MakeRoom(key);
+    if (cell)
+    {
+        cell->key = key;
+        cell->value = 0;
+    }
+    return cell;
+}
+
+//----------------------------------------------
+//  CuckooHashTable::OnPath
+//----------------------------------------------
+bool CuckooHashTable::OnPath(const SearchNode* nodes, int node, size_t bucket) const
+{
+    for (; node >= 0; node = nodes[node].parent)
+    {
+        if (nodes[node].bucket == bucket)
+            return true;
+    }
+    return false;
+}
+
+//----------------------------------------------
+//  CuckooHashTable::MakeRoom
+//----------------------------------------------
+CuckooHashTable::Cell* CuckooHashTable::MakeRoom(size_t key)
+{
+    // Breadth-first search, starting from both of the key's buckets, which are full.
+    // Every bucket in the queue is full, and each key in it can move to its other bucket.
+    SearchNode nodes[kMaxSearchNodes];
+    int count = 0;
+    nodes[count].bucket = FirstBucket(key);
+    nodes[count].parent = -1;
+    nodes[count++].parentSlot = -1;
+    size_t second = SecondBucket(key);
+    if (second != nodes[0].bucket)
+    {
+        nodes[count].bucket = second;
+        nodes[count].parent = -1;
+        nodes[count++].parentSlot = -1;
+    }
+
+    for (int n = 0; n < count; n++)
+    {
+        Bucket& bucket = m_buckets[nodes[n].bucket];
+        for (size_t s = 0; s < kSlotsPerBucket; s++)
+        {
+            size_t moving = bucket.cells[s].key;
+            size_t other = FirstBucket(moving);
+            if (other == nodes[n].bucket)
+                other = SecondBucket(moving);
+            if (other == nodes[n].bucket)
+                continue;       // Both of this key's hashes pick the same bucket
+
+            Cell* free = FreeCell(other);
+            if (free)
+            {
+                // Shift each key on the path into the cell vacated after it, back to the start.
+                // No bucket appears twice on the path, so each cell is only moved once.
+                *free = bucket.cells[s];
+                Cell* vacated = &bucket.cells[s];
+                m_displacements++;
+                for (int p = n; nodes[p].parent >= 0; p = nodes[p].parent)
+                {
+                    Cell* from = &m_buckets[nodes[nodes[p].parent].bucket].cells[nodes[p].parentSlot];
+                    *vacated = *from;
+                    vacated = from;
+                    m_displacements++;
+                }
+                return vacated;
+            }
+
+            // Continue the search from the other bucket, unless it would make a cycle
+            if (count < kMaxSearchNodes && !OnPath(nodes, n, other))
+            {
+                nodes[count].bucket = other;
+                nodes[count].parent = n;
+                nodes[count++].parentSlot = (int) s;
+            }
+        }
+    }
+    return NULL;
+}
+
+//----------------------------------------------
+//  CuckooHashTable::Clear
+//----------------------------------------------
+void CuckooHashTable::Clear()
+{
+    // (Does not resize the array)
+    // Clear regular cells
+    memset(m_buckets, 0, (m_bucketMask + 1) * sizeof(Bucket));
+    m_population = 0;
+    // Clear zero cell
+    m_zeroUsed = false;
+    m_zeroCell.value = 0;
+}
+
+//----------------------------------------------
+//  CuckooHashTable::Compact
+//----------------------------------------------
+void CuckooHashTable::Compact()
+{
+    // Aim for 90% occupancy; Repopulate grows further if the keys don't fit
+    size_t buckets = (m_population * 10 + kSlotsPerBucket * 9 - 1) / (kSlotsPerBucket * 9);
+    Repopulate(upper_power_of_two(buckets > 0 ? buckets : 1));
+}
+
+//----------------------------------------------
+//  CuckooHashTable::Repopulate
+//----------------------------------------------
+void CuckooHashTable::Repopulate(size_t desiredBuckets)
+{
+    assert((desiredBuckets & (desiredBuckets - 1)) == 0);   // Must be a power of 2
+
+    // Keep the old array until every key has been placed in the new one
+    char* oldMemory = m_memory;
+    Bucket* oldBuckets = m_buckets;
+    size_t oldBucketCount = m_bucketMask + 1;
+
+    for (size_t bucketCount = desiredBuckets;; bucketCount *= 2)
+    {
+        m_rehashes++;
+
+        // Allocate new array
+        m_memory = new char[bucketCount * sizeof(Bucket) + kBucketBytes - 1];
+        m_buckets = (Bucket*) ALIGN_TO_BUCKET(m_memory);
+        memset(m_buckets, 0, bucketCount * sizeof(Bucket));
+        m_bucketMask = bucketCount - 1;
+
+        // Iterate through old array
+        bool placedAll = true;
+        for (size_t b = 0; b < oldBucketCount && placedAll; b++)
+        {
+            for (size_t s = 0; s < kSlotsPerBucket; s++)
+            {
+                Cell& c = oldBuckets[b].cells[s];
+                if (c.key)
+                {
+                    // Insert this element into new array
+                    Cell* cell = Place(c.key);
+                    if (!cell)
+                    {
+                        placedAll = false;
+                        break;
+                    }
+                    cell->value = c.value;
+                }
+            }
+        }
+        if (placedAll)
+            break;
+
+        // Try again with twice as many buckets
+        delete[] m_memory;
+    }
+
+    // Delete old array
+    delete[] oldMemory;
+}
+
+//----------------------------------------------
+//  CuckooHashTable::GetStats
+//----------------------------------------------
+void CuckooHashTable::GetStats(Stats& stats) const
+{
+    stats.population = m_population;
+    stats.bucketCount = m_bucketMask + 1;
+    stats.slotCount = (m_bucketMask + 1) * kSlotsPerBucket;
+    stats.insertFailures = m_insertFailures;
+    stats.rehashes = m_rehashes;
+    stats.displacements = m_displacements;
+}
+
+//----------------------------------------------
+//  Iterator::Iterator
+//----------------------------------------------
+CuckooHashTable::Iterator::Iterator(CuckooHashTable &table) : m_table(table)
+{
+    m_cur = &m_table.m_zeroCell;
+    if (!m_table.m_zeroUsed)
+        Next();
+}
+
+//----------------------------------------------
+//  Iterator::Next
+//----------------------------------------------
+CuckooHashTable::Cell* CuckooHashTable::Iterator::Next()
+{
+    // Already finished?
+    if (!m_cur)
+        return m_cur;
+
+    // Iterate past zero cell; the buckets' cells are contiguous, so they're scanned as one array
+    Cell* begin = m_table.m_buckets[0].cells;
+    if (m_cur == &m_table.m_zeroCell)
+        m_cur = begin - 1;
+
+    // Iterate through the regular cells
+    Cell* end = begin + (m_table.m_bucketMask + 1) * kSlotsPerBucket;
+    while (++m_cur != end)
+    {
+        if (m_cur->key)
+            return m_cur;
+    }
+
+    // Finished
+    return m_cur = NULL;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+
+//----------------------------------------------
+//  CuckooHashTable
+//
+//  Bucketized cuckoo hashing: every key lives in one of two buckets, picked by two different
+//  hashes, and each bucket is a 64-byte cache line of kSlotsPerBucket cells. So a lookup
+//  reads at most two cache lines, no matter how full the table is.
+//  When both of a new key's buckets are full, Insert() searches breadth-first for the shortest
+//  chain of keys which can each move to their other bucket, ending at a free cell, then shifts
+//  them along it. If no chain is found within kMaxSearchNodes buckets, the insert has failed,
+//  and the bucket array doubles in size. With 4 slots per bucket, that happens at about 97% occupancy.
+//  Like HashTable, key = 0 marks an unused cell, and the value for key 0 is stored in m_zeroCell.
+//  Deletion is not supported; the benchmark never deletes individual keys.
+//----------------------------------------------
+class CuckooHashTable
+{
+public:
+    static const size_t kBucketBytes = 64;
+
+    struct Cell
+    {
+        size_t key;
+        size_t value;
+    };
+
+    struct Stats
+    {
+        size_t population;
+        size_t bucketCount;
+        size_t slotCount;
+        size_t insertFailures;  // Inserts which found no chain, and grew the table
+        size_t rehashes;        // Calls to Repopulate, including Compact() and retries when a rehash fails
+        size_t displacements;   // Keys moved to their other bucket by inserts
+    };
+
+private:
+    static const size_t kSlotsPerBucket = kBucketBytes / sizeof(Cell);
+    static const int kMaxSearchNodes = 512;
+
+    struct Bucket
+    {
+        Cell cells[kSlotsPerBucket];
+    };
+
+    // Step in the breadth-first search: a bucket, reached by moving the key in
+    // slot parentSlot of the parent node's bucket
+    struct SearchNode
+    {
+        size_t bucket;
+        int parent;
+        int parentSlot;
+    };
+
+    char* m_memory;
+    Bucket* m_buckets;
+    size_t m_bucketMask;    // Bucket count - 1; the count is a power of 2
+    size_t m_population;
+    bool m_zeroUsed;
+    Cell m_zeroCell;
+    size_t m_insertFailures;
+    size_t m_rehashes;
+    size_t m_displacements;
+
+    size_t FirstBucket(size_t key) const;
+    size_t SecondBucket(size_t key) const;
+    Cell* FreeCell(size_t bucket);
+    Cell* MakeRoom(size_t key);
+    Cell* Place(size_t key);
+    void Repopulate(size_t desiredBuckets);
+    bool OnPath(const SearchNode* nodes, int node, size_t bucket) const;
+
+public:
+    CuckooHashTable(size_t initialBuckets = 2);
+    ~CuckooHashTable();
+
+    // Basic operations
+    Cell* Lookup(size_t key);
+    Cell* Insert(size_t key);
+    void Clear();
+    void Compact();
+
+    void GetStats(Stats& stats) const;
+
+    // Iteration
+    friend class Iterator;
+    class Iterator
+    {
+    private:
+        CuckooHashTable& m_table;
+        Cell* m_cur;
+
+    public:
+        Iterator(CuckooHashTable &table);
+        Cell* Next();
+        inline Cell* operator*() const { return m_cur; }
+        inline Cell* operator->() const { return m_cur; }
+    };
+};
@@ -0,0 +1,177 @@
+#include <config.h>
+#include "densehashtable.h"
+#include "util.h"
+#include <assert.h>
+#include <memory.h>
+
+
+#define FIRST_INDEX(hash) ((hash) & (m_arraySize - 1))
+#define PROBE_NEXT(index, probes) (((index) + (probes)) & (m_arraySize - 1))
+#define MIN_ARRAY_SIZE 4
+
+
+//----------------------------------------------
+//  DenseHashTable::DenseHashTable
+//----------------------------------------------
+DenseHashTable::DenseHashTable(size_t initialSize)
+{
+    // Initialize regular cells
+    m_arraySize = initialSize;
+    assert((m_arraySize & (m_arraySize - 1)) == 0);   // Must be a power of 2
+    m_cells = new Cell[m_arraySize];
+    memset(m_cells, 0, sizeof(Cell) * m_arraySize);
+    m_population = 0;
+
+    // Initialize zero cell
+    m_zeroUsed = 0;
+    m_zeroCell.key = 0;
+    m_zeroCell.value = 0;
+}
+
+//----------------------------------------------
+//  DenseHashTable::~DenseHashTable
+//----------------------------------------------
+DenseHashTable::~DenseHashTable()
+{
+    // Delete regular cells
+    delete[] m_cells;
+}
+
+//----------------------------------------------
+//  DenseHashTable::Lookup
+//----------------------------------------------
+DenseHashTable::Cell* DenseHashTable::Lookup(size_t key)
+{
+    if (key)
+    {
+        // Check regular cells
+        size_t index = FIRST_INDEX(integerHash(key));
+        for (size_t probes = 1;; probes++)
+        {
+            Cell* cell = m_cells + index;
+            if (cell->key == key)
+                return cell;
+            if (!cell->key)
+                return NULL;
+            index = PROBE_NEXT(index, probes);
+        }
+    }
+    else
+    {
+        // Check zero cell
+        if (m_zeroUsed)
+            return &m_zeroCell;
+        return NULL;
+    }
+}
+
+//----------------------------------------------
+//  DenseHashTable::Insert
+//----------------------------------------------
+DenseHashTable::Cell* DenseHashTable::Insert(size_t key)
+{
+    if (key)
+    {
+        // Check regular cells
+        for (;;)
+        {
+            size_t index = FIRST_INDEX(integerHash(key));
+            for (size_t probes = 1;; probes++)
+            {
+                Cell* cell = m_cells + index;
+                if (cell->key == key)
+                    return cell;        // Found
+                if (cell->key == 0)
+                {
+                    // Insert here
+                    if ((m_population + 1) * 2 > m_arraySize)
+                    {
+                        // Time to resize
+                        Repopulate(m_arraySize * 2);
+                        break;
+                    }
+                    ++m_population;
+                    cell->key = key;
+                    return cell;
+                }
+                index = PROBE_NEXT(index, probes);
+            }
+        }
+    }
+    else
+    {
+        // Check zero cell
+        if (!m_zeroUsed)
+        {
+            // Insert here
+            m_zeroUsed = true;
+            if (++m_population * 2 > m_arraySize)
+                Repopulate(m_arraySize * 2);
+        }
+        return &m_zeroCell;
+    }
+}
+
+//----------------------------------------------
+//  DenseHashTable::Clear
+//----------------------------------------------
+void DenseHashTable::Clear()
+{
+    // (Does not resize the array)
+    // Clear regular cells
+    memset(m_cells, 0, sizeof(Cell) * m_arraySize);
+    m_population = 0;
+    // Clear zero cell
+    m_zeroUsed = false;
+    m_zeroCell.value = 0;
+}
+
+//----------------------------------------------
+//  DenseHashTable::Compact
+//----------------------------------------------
+void DenseHashTable::Compact()
+{
+    size_t desiredSize = upper_power_of_two(m_population * 2);
+    Repopulate(desiredSize > MIN_ARRAY_SIZE ? desiredSize : MIN_ARRAY_SIZE);
+}
+
+//----------------------------------------------
+//  DenseHashTable::Repopulate
+//----------------------------------------------
+void DenseHashTable::Repopulate(size_t desiredSize)
+{
+    assert((desiredSize & (desiredSize - 1)) == 0);   // Must be a power of 2
+    assert(m_population * 2 <= desiredSize);
+
+    // Get start/end pointers of old array
+    Cell* oldCells = m_cells;
+    Cell* end = m_cells + m_arraySize;
+
+    // Allocate new array
+    m_arraySize = desiredSize;
+    m_cells = new Cell[m_arraySize];
+    memset(m_cells, 0, sizeof(Cell) * m_arraySize);
+
+    // Iterate through old array
+    for (Cell* c = oldCells; c != end; c++)
+    {
+        if (c->key)
+        {
+            // Insert this element into new array
+            size_t index = FIRST_INDEX(integerHash(c->key));
+            for (size_t probes = 1;; probes++)
+            {
+                if (!m_cells[index].key)
+                {
+                    // Insert here
+                    m_cells[index] = *c;
+                    break;
+                }
+                index = PROBE_NEXT(index, probes);
+            }
+        }
+    }
+
+    // Delete old array
+    delete[] oldCells;
+}
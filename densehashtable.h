@@ -0,0 +1,41 @@
+#pragma once
+
+
+//----------------------------------------------
+//  DenseHashTable
+//
+//  Baseline open addressing map, following the policies of google::dense_hash_map:
+//  Quadratic (triangular) probing, and the table doubles in size when it becomes 50% full.
+//  Provided so the custom HashTable can be compared against the kind of
+//  off-the-shelf open addressing table an engineer would otherwise reach for.
+//  Like HashTable, key = 0 marks an unused cell, and the value for key 0 is stored in m_zeroCell.
+//  Deletion is not supported; the benchmark never deletes individual keys.
+//----------------------------------------------
+class DenseHashTable
+{
+public:
+    struct Cell
+    {
+        size_t key;
+        size_t value;
+    };
+
+private:
+    Cell* m_cells;
+    size_t m_arraySize;
+    size_t m_population;
+    bool m_zeroUsed;
+    Cell m_zeroCell;
+
+    void Repopulate(size_t desiredSize);
+
+public:
+    DenseHashTable(size_t initialSize = 32);
+    ~DenseHashTable();
+
+    // Basic operations
+    Cell* Lookup(size_t key);
+    Cell* Insert(size_t key);
+    void Clear();
+    void Compact();
+};
@@ -1,14 +1,156 @@
 #include <config.h>
+#include <windows.h>
 #include "hashtable.h"
 #include "util.h"
+#include "tablehash.h"
 #include <assert.h>
 #include <memory.h>
+#include <stdio.h>
+#include <intrin.h>
+#include <smmintrin.h>
 
 
-#define FIRST_CELL(hash) (m_cells + ((hash) & (m_arraySize - 1)))
+#if INTEGER_MAP_TABLE_MAX_LOAD_PERCENT <= 0 || INTEGER_MAP_TABLE_MAX_LOAD_PERCENT >= 100
+#error INTEGER_MAP_TABLE_MAX_LOAD_PERCENT must leave at least one unused cell
+#endif
+#if INTEGER_MAP_TABLE_GROWTH_PERCENT <= 100
+#error INTEGER_MAP_TABLE_GROWTH_PERCENT must be over 100
+#endif
+
+// Maps a hash to [0, n) with Lemire's multiply-shift range reduction, so any array size works.
+// It uses the top bits of the hash; the low bits are left for ShardedHashTable and friends to pick a table with.
+#ifdef _WIN64
+#define REDUCE_HASH(hash, n) ((size_t) __umulh((hash), (n)))
+#else
+#define REDUCE_HASH(hash, n) ((size_t) (((uint64_t) (hash) * (n)) >> 32))
+#endif
+#if INTEGER_MAP_TABLE_BUCKETED
+// The first cell of the hash's bucket
+#define FIRST_CELL(hash) (m_cells + REDUCE_HASH(hash, m_arraySize / kBucketCells) * kBucketCells)
+#define BUCKET_OF(c) (m_cells + (size_t) ((c) - m_cells) / kBucketCells * kBucketCells)
+#define CIRCULAR_NEXT_BUCKET(b) ((b) + kBucketCells != m_cells + m_arraySize ? (b) + kBucketCells : m_cells)
+#else
+#define FIRST_CELL(hash) (m_cells + REDUCE_HASH(hash, m_arraySize))
+#endif
 #define CIRCULAR_NEXT(c) ((c) + 1 != m_cells + m_arraySize ? (c) + 1 : m_cells)
 #define CIRCULAR_OFFSET(a, b) ((b) >= (a) ? (b) - (a) : m_arraySize + (b) - (a))
 
+#if INTEGER_MAP_TABLE_STATS
+#define STATS_ADD(member, n) ((member) += (n))
+#else
+#define STATS_ADD(member, n)
+#endif
+
+
+//----------------------------------------------
+//  Snapshot file format
+//
+//  A SnapshotHeader, padded to SNAPSHOT_CELLS_OFFSET, followed by the m_cells array exactly as it is
+//  in memory. The cells start on a page boundary, so MapFromFile() can point m_cells straight into the view.
+//  Snapshots are only portable between builds with the same pointer size, byte order and hash function;
+//  cellBytes catches a 32/64-bit mismatch, hashCheck a different INTEGER_MAP_TABLE_HASH, and
+//  bucketCells a different INTEGER_MAP_TABLE_BUCKETED.
+//----------------------------------------------
+#define SNAPSHOT_MAGIC 0x4e535448       // 'HTSN'
+#define SNAPSHOT_VERSION 4
+#define SNAPSHOT_CELLS_OFFSET 4096
+#if INTEGER_MAP_TABLE_BUCKETED
+#define SNAPSHOT_BUCKET_CELLS HashTable::kBucketCells
+#else
+#define SNAPSHOT_BUCKET_CELLS 1
+#endif
+
+struct SnapshotHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t cellBytes;
+    uint32_t cellsOffset;
+    uint64_t arraySize;
+    uint64_t population;
+    uint64_t zeroUsed;
+    uint64_t zeroValue;
+    uint64_t hashCheck;     // tableHash(SNAPSHOT_MAGIC)
+    uint64_t bucketCells;   // 1 for the flat layout
+};
+
+
+//----------------------------------------------
+//  Sizing
+//
+//  The table grows by INTEGER_MAP_TABLE_GROWTH_PERCENT when an insert would fill it past
+//  INTEGER_MAP_TABLE_MAX_LOAD_PERCENT. 64-bit math keeps the percentages from overflowing a 32-bit size_t.
+//----------------------------------------------
+static size_t ResizePopulation(size_t arraySize)
+{
+    return (size_t) (((uint64_t) arraySize * INTEGER_MAP_TABLE_MAX_LOAD_PERCENT + 99) / 100);
+}
+
+static size_t ArraySizeFor(size_t population)
+{
+    size_t arraySize = (size_t) (((uint64_t) population * 100 + INTEGER_MAP_TABLE_MAX_LOAD_PERCENT - 1) / INTEGER_MAP_TABLE_MAX_LOAD_PERCENT);
+    return arraySize > 0 ? arraySize : 1;
+}
+
+static size_t GrownArraySize(size_t arraySize)
+{
+    size_t grown = (size_t) ((uint64_t) arraySize * INTEGER_MAP_TABLE_GROWTH_PERCENT / 100);
+    return grown > arraySize ? grown : arraySize + 1;
+}
+
+// The bucketed layout only uses whole buckets
+static size_t WholeBuckets(size_t arraySize)
+{
+#if INTEGER_MAP_TABLE_BUCKETED
+    return (arraySize + HashTable::kBucketCells - 1) / HashTable::kBucketCells * HashTable::kBucketCells;
+#else
+    return arraySize;
+#endif
+}
+
+
+#if INTEGER_MAP_TABLE_BUCKETED
+
+//----------------------------------------------
+//  MatchBucket
+//
+//  Returns a mask with bit i set if cell i of the bucket holds key. The keys are gathered out of
+//  the interleaved cells with unpack/shuffle, then compared all at once.
+//----------------------------------------------
+static inline unsigned MatchBucket(const HashTable::Cell* bucket, size_t key)
+{
+    const __m128i* p = (const __m128i*) bucket;
+#ifdef _WIN64
+    // 4 cells of 16 bytes: two keys per comparison
+    __m128i k = _mm_set1_epi64x(key);
+    __m128i keys01 = _mm_unpacklo_epi64(_mm_load_si128(p), _mm_load_si128(p + 1));
+    __m128i keys23 = _mm_unpacklo_epi64(_mm_load_si128(p + 2), _mm_load_si128(p + 3));
+    unsigned lo = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(keys01, k)));
+    unsigned hi = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(keys23, k)));
+    return lo | (hi << 2);
+#else
+    // 8 cells of 8 bytes: four keys per comparison
+    __m128i k = _mm_set1_epi32(key);
+    __m128 keys0123 = _mm_shuffle_ps(_mm_load_ps((const float*) p), _mm_load_ps((const float*) (p + 1)), _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 keys4567 = _mm_shuffle_ps(_mm_load_ps((const float*) (p + 2)), _mm_load_ps((const float*) (p + 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    unsigned lo = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_castps_si128(keys0123), k)));
+    unsigned hi = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_castps_si128(keys4567), k)));
+    return lo | (hi << 4);
+#endif
+}
+
+//----------------------------------------------
+//  FirstMatch
+//----------------------------------------------
+static inline size_t FirstMatch(unsigned mask)
+{
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+}
+
+#endif // INTEGER_MAP_TABLE_BUCKETED
+
 
 //----------------------------------------------
 //  HashTable::HashTable
@@ -16,16 +158,25 @@
 HashTable::HashTable(size_t initialSize)
 {
     // Initialize regular cells
-    m_arraySize = initialSize;
-    assert((m_arraySize & (m_arraySize - 1)) == 0);   // Must be a power of 2
-    m_cells = new Cell[m_arraySize];
-    memset(m_cells, 0, sizeof(Cell) * m_arraySize);
+    assert(initialSize > 0);
+    m_arraySize = WholeBuckets(initialSize);
+    m_cells = AllocateCells(m_arraySize, m_memory);
     m_population = 0;
+    m_resizePopulation = ResizePopulation(m_arraySize);
 
     // Initialize zero cell
     m_zeroUsed = 0;
     m_zeroCell.key = 0;
     m_zeroCell.value = 0;
+
+    m_mappedView = NULL;
+
+#if INTEGER_MAP_TABLE_STATS
+    m_resizes = 0;
+    m_bytesMoved = 0;
+    m_lookups = 0;
+    m_lookupProbes = 0;
+#endif
 }
 
 //----------------------------------------------
@@ -34,7 +185,35 @@ HashTable::HashTable(size_t initialSize)
 HashTable::~HashTable()
 {
     // Delete regular cells
-    delete[] m_cells;
+    FreeCells(m_memory, m_mappedView);
+}
+
+//----------------------------------------------
+//  HashTable::AllocateCells
+//----------------------------------------------
+HashTable::Cell* HashTable::AllocateCells(size_t arraySize, char*& memory)
+{
+#if INTEGER_MAP_TABLE_BUCKETED
+    // new[] only guarantees word alignment, so round up to the next bucket
+    memory = new char[sizeof(Cell) * arraySize + kBucketBytes - 1];
+    Cell* cells = (Cell*) (((size_t) memory + kBucketBytes - 1) & ~(kBucketBytes - 1));
+#else
+    memory = new char[sizeof(Cell) * arraySize];
+    Cell* cells = (Cell*) memory;
+#endif
+    memset(cells, 0, sizeof(Cell) * arraySize);
+    return cells;
+}
+
+//----------------------------------------------
+//  HashTable::FreeCells
+//----------------------------------------------
+void HashTable::FreeCells(char* memory, void* mappedView)
+{
+    if (mappedView)
+        UnmapViewOfFile(mappedView);
+    else
+        delete[] memory;
 }
 
 //----------------------------------------------
@@ -42,16 +221,30 @@ HashTable::~HashTable()
 //----------------------------------------------
 HashTable::Cell* HashTable::Lookup(size_t key)
 {
+    STATS_ADD(m_lookups, 1);
     if (key)
     {
         // Check regular cells
-        for (Cell* cell = FIRST_CELL(integerHash(key));; cell = CIRCULAR_NEXT(cell))
+#if INTEGER_MAP_TABLE_BUCKETED
+        for (Cell* bucket = FIRST_CELL(tableHash(key));; bucket = CIRCULAR_NEXT_BUCKET(bucket))
+        {
+            STATS_ADD(m_lookupProbes, 1);
+            unsigned match = MatchBucket(bucket, key);
+            if (match)
+                return bucket + FirstMatch(match);
+            if (MatchBucket(bucket, 0))
+                return NULL;
+        }
+#else
+        for (Cell* cell = FIRST_CELL(tableHash(key));; cell = CIRCULAR_NEXT(cell))
         {
+            STATS_ADD(m_lookupProbes, 1);
             if (cell->key == key)
                 return cell;
             if (!cell->key)
                 return NULL;
         }
+#endif
     }
     else
     {
@@ -62,27 +255,93 @@ HashTable::Cell* HashTable::Lookup(size_t key)
     }
 };
 
+//----------------------------------------------
+//  HashTable::GetProbeRuns
+//----------------------------------------------
+int HashTable::GetProbeRuns(size_t key, const Cell** runs, size_t* runLengths) const
+{
+    if (!key)
+        return 0;
+
+    // Follow the same probe as Lookup, counting cells until it wraps or stops
+    int count = 0;
+    runs[0] = FIRST_CELL(tableHash(key));
+    runLengths[0] = 0;
+#if INTEGER_MAP_TABLE_BUCKETED
+    for (const Cell* bucket = runs[0];; bucket = CIRCULAR_NEXT_BUCKET(bucket))
+    {
+        if (bucket == m_cells && runLengths[count] > 0)
+        {
+            runs[++count] = bucket;
+            runLengths[count] = 0;
+        }
+        runLengths[count] += kBucketCells;
+        if (MatchBucket(bucket, key) || MatchBucket(bucket, 0))
+            break;
+    }
+#else
+    for (const Cell* cell = runs[0];; cell = CIRCULAR_NEXT(cell))
+    {
+        if (cell == m_cells && runLengths[count] > 0)
+        {
+            runs[++count] = cell;
+            runLengths[count] = 0;
+        }
+        runLengths[count]++;
+        if (cell->key == key || !cell->key)
+            break;
+    }
+#endif
+    return count + 1;
+}
+
 //----------------------------------------------
 //  HashTable::Insert
 //----------------------------------------------
 HashTable::Cell* HashTable::Insert(size_t key)
 {
+    STATS_ADD(m_lookups, 1);
     if (key)
     {
         // Check regular cells
         for (;;)
         {
-            for (Cell* cell = FIRST_CELL(integerHash(key));; cell = CIRCULAR_NEXT(cell))
+#if INTEGER_MAP_TABLE_BUCKETED
+            for (Cell* bucket = FIRST_CELL(tableHash(key));; bucket = CIRCULAR_NEXT_BUCKET(bucket))
+            {
+                STATS_ADD(m_lookupProbes, 1);
+                unsigned match = MatchBucket(bucket, key);
+                if (match)
+                    return bucket + FirstMatch(match);     // Found
+                unsigned unused = MatchBucket(bucket, 0);
+                if (unused)
+                {
+                    // Insert here
+                    if (m_population + 1 >= m_resizePopulation)
+                    {
+                        // Time to resize
+                        Repopulate(GrownArraySize(m_arraySize));
+                        break;
+                    }
+                    ++m_population;
+                    Cell* cell = bucket + FirstMatch(unused);
+                    cell->key = key;
+                    return cell;
+                }
+            }
+#else
+            for (Cell* cell = FIRST_CELL(tableHash(key));; cell = CIRCULAR_NEXT(cell))
             {
+                STATS_ADD(m_lookupProbes, 1);
                 if (cell->key == key)
                     return cell;        // Found
                 if (cell->key == 0)
                 {
                     // Insert here
-                    if ((m_population + 1) * 4 >= m_arraySize * 3)
+                    if (m_population + 1 >= m_resizePopulation)
                     {
                         // Time to resize
-                        Repopulate(m_arraySize * 2);
+                        Repopulate(GrownArraySize(m_arraySize));
                         break;
                     }
                     ++m_population;
@@ -90,6 +349,7 @@ HashTable::Cell* HashTable::Insert(size_t key)
                     return cell;
                 }
             }
+#endif
         }
     }
     else
@@ -99,10 +359,10 @@ HashTable::Cell* HashTable::Insert(size_t key)
         {
             // Insert here
             m_zeroUsed = true;
-            if (++m_population * 4 >= m_arraySize * 3)
+            if (++m_population >= m_resizePopulation)
 			{
 				// Even though we didn't use a regular slot, let's keep the sizing rules consistent
-                Repopulate(m_arraySize * 2);
+                Repopulate(GrownArraySize(m_arraySize));
 			}
         }
         return &m_zeroCell;
@@ -120,6 +380,37 @@ void HashTable::Delete(Cell* cell)
         assert(cell >= m_cells && cell - m_cells < m_arraySize);
         assert(cell->key);
 
+#if INTEGER_MAP_TABLE_BUCKETED
+        // Every key's buckets, from the one its hash points to up to the one it's in, must stay full.
+        // So refill the hole from later buckets, moving at most one key out of each, until reaching
+        // a bucket which already had an unused cell. No key beyond that one can depend on the hole.
+        Cell* hole = cell;
+        hole->key = 0;
+        for (Cell* bucket = CIRCULAR_NEXT_BUCKET(BUCKET_OF(hole));; bucket = CIRCULAR_NEXT_BUCKET(bucket))
+        {
+            bool hadUnused = MatchBucket(bucket, 0) != 0;
+            Cell* holeBucket = BUCKET_OF(hole);
+            for (size_t i = 0; i < kBucketCells; i++)
+            {
+                Cell* neighbor = bucket + i;
+                if (!neighbor->key)
+                    continue;
+                Cell* ideal = FIRST_CELL(tableHash(neighbor->key));
+                if (CIRCULAR_OFFSET(ideal, holeBucket) < CIRCULAR_OFFSET(ideal, bucket))
+                {
+                    // Move neighbor into the hole, then make neighbor the new hole.
+                    *hole = *neighbor;
+                    hole = neighbor;
+                    hole->key = 0;
+                    break;
+                }
+            }
+            if (hadUnused)
+                break;
+        }
+        hole->value = 0;
+        m_population--;
+#else
         // Remove this cell by shuffling neighboring cells so there are no gaps in anyone's probe chain
         for (Cell* neighbor = CIRCULAR_NEXT(cell);; neighbor = CIRCULAR_NEXT(neighbor))
         {
@@ -131,7 +422,7 @@ void HashTable::Delete(Cell* cell)
                 m_population--;
                 return;
             }
-            Cell* ideal = FIRST_CELL(integerHash(neighbor->key));
+            Cell* ideal = FIRST_CELL(tableHash(neighbor->key));
             if (CIRCULAR_OFFSET(ideal, cell) < CIRCULAR_OFFSET(ideal, neighbor))
             {
                 // Swap with neighbor, then make neighbor the new cell to remove.
@@ -139,6 +430,7 @@ void HashTable::Delete(Cell* cell)
                 cell = neighbor;
             }
         }
+#endif
     }
     else
     {
@@ -170,7 +462,18 @@ void HashTable::Clear()
 //----------------------------------------------
 void HashTable::Compact()
 {
-    Repopulate(upper_power_of_two((m_population * 4 + 3) / 3));
+    Repopulate(ArraySizeFor(m_population));
+}
+
+//----------------------------------------------
+//  HashTable::Reserve
+//----------------------------------------------
+void HashTable::Reserve(size_t population)
+{
+    // Leave room to insert the last entry without reaching the resize point
+    size_t desiredSize = ArraySizeFor(population + 1);
+    if (desiredSize > m_arraySize)
+        Repopulate(desiredSize);
 }
 
 //----------------------------------------------
@@ -178,17 +481,22 @@ void HashTable::Compact()
 //----------------------------------------------
 void HashTable::Repopulate(size_t desiredSize)
 {
-    assert((desiredSize & (desiredSize - 1)) == 0);   // Must be a power of 2
-    assert(m_population * 4  <= desiredSize * 3);
+    assert(desiredSize > 0);
+    assert((uint64_t) m_population * 100 <= (uint64_t) desiredSize * INTEGER_MAP_TABLE_MAX_LOAD_PERCENT);
+    STATS_ADD(m_resizes, 1);
+    STATS_ADD(m_bytesMoved, (m_population - (m_zeroUsed ? 1 : 0)) * sizeof(Cell));
 
     // Get start/end pointers of old array
     Cell* oldCells = m_cells;
     Cell* end = m_cells + m_arraySize;
+    char* oldMemory = m_memory;
+    void* oldMappedView = m_mappedView;
+    m_mappedView = NULL;
 
     // Allocate new array
-    m_arraySize = desiredSize;
-    m_cells = new Cell[m_arraySize];
-    memset(m_cells, 0, sizeof(Cell) * m_arraySize);
+    m_arraySize = WholeBuckets(desiredSize);
+    m_resizePopulation = ResizePopulation(m_arraySize);
+    m_cells = AllocateCells(m_arraySize, m_memory);
 
     // Iterate through old array
     for (Cell* c = oldCells; c != end; c++)
@@ -196,7 +504,19 @@ void HashTable::Repopulate(size_t desiredSize)
         if (c->key)
         {
             // Insert this element into new array
-            for (Cell* cell = FIRST_CELL(integerHash(c->key));; cell = CIRCULAR_NEXT(cell))
+#if INTEGER_MAP_TABLE_BUCKETED
+            for (Cell* bucket = FIRST_CELL(tableHash(c->key));; bucket = CIRCULAR_NEXT_BUCKET(bucket))
+            {
+                unsigned unused = MatchBucket(bucket, 0);
+                if (unused)
+                {
+                    // Insert here
+                    bucket[FirstMatch(unused)] = *c;
+                    break;
+                }
+            }
+#else
+            for (Cell* cell = FIRST_CELL(tableHash(c->key));; cell = CIRCULAR_NEXT(cell))
             {
                 if (!cell->key)
                 {
@@ -205,11 +525,92 @@ void HashTable::Repopulate(size_t desiredSize)
                     break;
                 }
             }
+#endif
         }
     }
 
     // Delete old array
-    delete[] oldCells;
+    FreeCells(oldMemory, oldMappedView);
+}
+
+//----------------------------------------------
+//  HashTable::Save
+//----------------------------------------------
+bool HashTable::Save(const char* path) const
+{
+    FILE* f = fopen(path, "wb");
+    if (!f)
+        return false;
+
+    char page[SNAPSHOT_CELLS_OFFSET];
+    memset(page, 0, sizeof(page));
+    SnapshotHeader* header = (SnapshotHeader*) page;
+    header->magic = SNAPSHOT_MAGIC;
+    header->version = SNAPSHOT_VERSION;
+    header->cellBytes = sizeof(Cell);
+    header->cellsOffset = SNAPSHOT_CELLS_OFFSET;
+    header->arraySize = m_arraySize;
+    header->population = m_population;
+    header->zeroUsed = m_zeroUsed;
+    header->zeroValue = m_zeroCell.value;
+    header->hashCheck = tableHash(SNAPSHOT_MAGIC);
+    header->bucketCells = SNAPSHOT_BUCKET_CELLS;
+
+    bool ok = fwrite(page, sizeof(page), 1, f) == 1
+        && fwrite(m_cells, sizeof(Cell), m_arraySize, f) == m_arraySize;
+    return (fclose(f) == 0) && ok;
+}
+
+//----------------------------------------------
+//  HashTable::MapFromFile
+//----------------------------------------------
+bool HashTable::MapFromFile(const char* path, bool copyOnWrite)
+{
+    // Map the whole file. The view keeps the file and mapping objects alive, so their handles can be closed now.
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = NULL;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart >= SNAPSHOT_CELLS_OFFSET)
+        mapping = CreateFileMappingA(file, NULL, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping)
+        return false;
+    void* view = MapViewOfFile(mapping, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view)
+        return false;
+
+    // Validate the header before trusting any of it
+    const SnapshotHeader* header = (const SnapshotHeader*) view;
+    if (header->magic != SNAPSHOT_MAGIC
+        || header->version != SNAPSHOT_VERSION
+        || header->cellBytes != sizeof(Cell)
+        || header->cellsOffset != SNAPSHOT_CELLS_OFFSET
+        || header->hashCheck != tableHash(SNAPSHOT_MAGIC)
+        || header->bucketCells != SNAPSHOT_BUCKET_CELLS
+        || header->arraySize % SNAPSHOT_BUCKET_CELLS != 0
+        || header->arraySize == 0
+        || header->population >= header->arraySize
+        || header->arraySize > ((uint64_t) fileSize.QuadPart - SNAPSHOT_CELLS_OFFSET) / sizeof(Cell))
+    {
+        UnmapViewOfFile(view);
+        return false;
+    }
+
+    // Replace the current contents
+    FreeCells(m_memory, m_mappedView);
+    m_memory = NULL;
+    m_mappedView = view;
+    m_cells = (Cell*) ((char*) view + SNAPSHOT_CELLS_OFFSET);
+    m_arraySize = (size_t) header->arraySize;
+    m_population = (size_t) header->population;
+    m_resizePopulation = ResizePopulation(m_arraySize);
+    m_zeroUsed = header->zeroUsed != 0;
+    m_zeroCell.key = 0;
+    m_zeroCell.value = (size_t) header->zeroValue;
+    return true;
 }
 
 //----------------------------------------------
@@ -246,3 +647,74 @@ HashTable::Cell* HashTable::Iterator::Next()
     // Finished
     return m_cur = NULL;
 }
+
+#if INTEGER_MAP_TABLE_STATS
+
+//----------------------------------------------
+//  StatsBucket
+//----------------------------------------------
+static int StatsBucket(size_t value)
+{
+    int bucket = 0;
+    while (value && bucket < HashTable::Stats::kHistogramSize - 1)
+    {
+        value >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+//----------------------------------------------
+//  HashTable::GetStats
+//----------------------------------------------
+void HashTable::GetStats(Stats& stats) const
+{
+    memset(&stats, 0, sizeof(stats));
+    stats.population = m_population;
+    stats.arraySize = m_arraySize;
+    stats.resizes = m_resizes;
+    stats.bytesMoved = m_bytesMoved;
+    stats.lookups = m_lookups;
+    stats.lookupProbes = m_lookupProbes;
+
+    // Start just after an unused cell, so that no cluster wraps around the end of the scan.
+    // Insert grows the table before the population reaches INTEGER_MAP_TABLE_MAX_LOAD_PERCENT of the
+    // array size, which is under 100%, so there is always one.
+    Cell* start = m_cells;
+    while (start->key)
+        start++;
+    start = CIRCULAR_NEXT(start);
+
+    size_t clusterLength = 0;
+    Cell* cell = start;
+    for (size_t i = 0; i < m_arraySize; i++)
+    {
+        if (cell->key)
+        {
+            Cell* ideal = FIRST_CELL(tableHash(cell->key));
+            size_t distance = CIRCULAR_OFFSET(ideal, cell);
+            stats.probeDistance[StatsBucket(distance)]++;
+            if (distance > stats.maxProbeDistance)
+                stats.maxProbeDistance = distance;
+            clusterLength++;
+        }
+        else if (clusterLength > 0)
+        {
+            stats.clusterLength[StatsBucket(clusterLength)]++;
+            clusterLength = 0;
+        }
+        cell = CIRCULAR_NEXT(cell);
+    }
+    assert(clusterLength == 0);     // The scan ends on the unused cell it started after
+}
+
+//----------------------------------------------
+//  HashTable::ResetLookupStats
+//----------------------------------------------
+void HashTable::ResetLookupStats()
+{
+    m_lookups = 0;
+    m_lookupProbes = 0;
+}
+
+#endif // INTEGER_MAP_TABLE_STATS
@@ -5,11 +5,19 @@
 //  HashTable
 //
 //  Maps pointer-sized integers to pointer-sized integers.
-//  Uses open addressing with linear probing.
+//  Uses open addressing with linear probing, starting from the cell picked by tableHash (see tablehash.h).
 //  In the m_cells array, key = 0 is reserved to indicate an unused cell.
 //  Actual value for key 0 (if any) is stored in m_zeroCell.
-//  The hash table automatically doubles in size when it becomes 75% full.
+//  The hash table automatically grows by INTEGER_MAP_TABLE_GROWTH_PERCENT (200%, doubling, by default)
+//  when it becomes INTEGER_MAP_TABLE_MAX_LOAD_PERCENT (75% by default) full. The array size doesn't
+//  need to be a power of 2, and Reserve() can set it up front.
 //  The hash table never shrinks in size, even after Clear(), unless you explicitly call Compact().
+//  Save() writes a snapshot file which MapFromFile() maps straight into m_cells, with no rehashing.
+//  With INTEGER_MAP_TABLE_STATS, the table also counts its resizes and probes, and GetStats()
+//  reports them along with the current probe distances and cluster lengths.
+//  With INTEGER_MAP_TABLE_BUCKETED, m_cells is aligned to a cache line and divided into buckets of
+//  kBucketCells, and tableHash picks a bucket instead of a cell. Each probe compares the key against
+//  the whole bucket at once using SIMD, and the search ends at the first bucket with an unused cell.
 //----------------------------------------------
 class HashTable
 {
@@ -19,15 +27,49 @@ public:
         size_t key;
         size_t value;
     };
+
+#if INTEGER_MAP_TABLE_BUCKETED
+    static const size_t kBucketBytes = 64;
+    static const size_t kBucketCells = kBucketBytes / sizeof(Cell);
+#endif
+
+#if INTEGER_MAP_TABLE_STATS
+    struct Stats
+    {
+        // Histogram bucket 0 counts zeros, and bucket b counts values in [2^(b-1), 2^b)
+        static const int kHistogramSize = 24;
+
+        size_t probeDistance[kHistogramSize];   // Occupied cells, by distance from the cell their hash points to
+        size_t clusterLength[kHistogramSize];   // Runs of consecutive occupied cells, by length
+        size_t maxProbeDistance;
+        size_t population;
+        size_t arraySize;
+        size_t resizes;         // Calls to Repopulate since the table was created
+        size_t bytesMoved;      // Cell bytes reinserted by those calls
+        size_t lookups;         // Searches by Lookup and Insert since the last ResetLookupStats()
+        size_t lookupProbes;    // Cells examined by those searches, or buckets in the bucketed layout
+    };
+#endif
     
 private:
+    char* m_memory;         // Block from new[] containing m_cells, or NULL if m_cells is in a snapshot view
     Cell* m_cells;
     size_t m_arraySize;
     size_t m_population;
+    size_t m_resizePopulation;  // Inserting the entry which brings m_population here grows the array
     bool m_zeroUsed;
     Cell m_zeroCell;
+    void* m_mappedView;     // Snapshot file view containing m_cells, or NULL if m_cells came from new[]
+#if INTEGER_MAP_TABLE_STATS
+    size_t m_resizes;
+    size_t m_bytesMoved;
+    size_t m_lookups;
+    size_t m_lookupProbes;
+#endif
     
     void Repopulate(size_t desiredSize);
+    static Cell* AllocateCells(size_t arraySize, char*& memory);
+    static void FreeCells(char* memory, void* mappedView);
 
 public:
     HashTable(size_t initialSize = 8);
@@ -39,6 +81,22 @@ public:
     void Delete(Cell* cell);
     void Clear();
     void Compact();
+    void Reserve(size_t population);
+
+    // The cells a Lookup of key reads, as up to two runs, since the probe can wrap past the end of the array.
+    // Returns the number of runs, which is 0 for key 0.
+    int GetProbeRuns(size_t key, const Cell** runs, size_t* runLengths) const;
+
+    // Snapshots
+    // A copy-on-write mapping supports every operation; a read-only one supports only Lookup and Iterator.
+    bool Save(const char* path) const;
+    bool MapFromFile(const char* path, bool copyOnWrite = true);
+
+#if INTEGER_MAP_TABLE_STATS
+    // Scans every cell, so it costs as much as iterating the table
+    void GetStats(Stats& stats) const;
+    void ResetLookupStats();
+#endif
 
     void Delete(size_t key)
     {
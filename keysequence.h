@@ -0,0 +1,52 @@
+#pragma once
+
+#include "randomsequence.h"
+#include <vector>
+
+
+#if INTEGER_MAP_LAZY_KEYS && !INTEGER_MAP_KEY_GENERATION(LINEAR) && !INTEGER_MAP_KEY_GENERATION(RANDOM_SEQUENCE_OF_UNIQUE) && !INTEGER_MAP_KEY_GENERATION(RANDOM_SEQUENCE_OF_UNIQUE_64)
+#error INTEGER_MAP_LAZY_KEYS needs an INTEGER_MAP_KEY_GENERATION which computes each key from its position: LINEAR, RANDOM_SEQUENCE_OF_UNIQUE or RANDOM_SEQUENCE_OF_UNIQUE_64
+#endif
+
+//---------------------------------------------------
+// KeySequence
+//
+// The keys an experiment inserts, in order, as made by GenerateKeys.
+// Normally they're stored, at 8 bytes per key in 64-bit builds. With
+// INTEGER_MAP_LAZY_KEYS, each key is computed from its position when it's
+// read instead, so billions of keys take no memory beside the map. Only
+// the generators which don't depend on the keys before can do that.
+//---------------------------------------------------
+class KeySequence
+{
+private:
+    size_t m_count;
+#if INTEGER_MAP_LAZY_KEYS && INTEGER_MAP_KEY_GENERATION(RANDOM_SEQUENCE_OF_UNIQUE)
+    RandomSequenceOfUnique m_sequence;
+#elif INTEGER_MAP_LAZY_KEYS && INTEGER_MAP_KEY_GENERATION(RANDOM_SEQUENCE_OF_UNIQUE_64)
+    RandomSequenceOfUnique64 m_sequence;
+#elif !INTEGER_MAP_LAZY_KEYS
+    std::vector<size_t> m_keys;
+#endif
+
+    friend void GenerateKeys(KeySequence& keys, size_t keyCount, int M);
+
+public:
+    KeySequence() : m_count(0) {}
+
+    size_t size() const
+    {
+        return m_count;
+    }
+
+    size_t operator[](size_t i) const
+    {
+#if INTEGER_MAP_LAZY_KEYS && INTEGER_MAP_KEY_GENERATION(LINEAR)
+        return i;
+#elif INTEGER_MAP_LAZY_KEYS
+        return (size_t) m_sequence.at(i);
+#else
+        return m_keys[i];
+#endif
+    }
+};
@@ -0,0 +1,154 @@
+#include <config.h>
+#include <windows.h>
+#include "lockfreehashtable.h"
+#include "util.h"
+#include <assert.h>
+#include <memory.h>
+
+
+#define FIRST_INDEX(hash) ((hash) & (m_arraySize - 1))
+#define CIRCULAR_NEXT_INDEX(index) (((index) + 1) & (m_arraySize - 1))
+
+// Atomic operations on size_t, which is pointer-sized
+#ifdef _WIN64
+#define COMPARE_EXCHANGE_SIZE_T(dest, exchange, comparand) \
+    ((size_t) InterlockedCompareExchange64((volatile LONG64*) (dest), (LONG64) (exchange), (LONG64) (comparand)))
+#define INCREMENT_SIZE_T(dest) ((size_t) InterlockedIncrement64((volatile LONG64*) (dest)))
+#else
+#define COMPARE_EXCHANGE_SIZE_T(dest, exchange, comparand) \
+    ((size_t) InterlockedCompareExchange((volatile LONG*) (dest), (LONG) (exchange), (LONG) (comparand)))
+#define INCREMENT_SIZE_T(dest) ((size_t) InterlockedIncrement((volatile LONG*) (dest)))
+#endif
+
+
+//----------------------------------------------
+//  LockFreeHashTable::LockFreeHashTable
+//----------------------------------------------
+LockFreeHashTable::LockFreeHashTable(size_t capacity)
+{
+    // Keep the array no more than 50% full, since it can't grow
+    m_arraySize = upper_power_of_two(capacity * 2 > 8 ? capacity * 2 : 8);
+    m_cells = new Cell[m_arraySize];
+    memset((void*) m_cells, 0, sizeof(Cell) * m_arraySize);
+
+    // Initialize zero cell
+    m_zeroUsed = 0;
+    m_zeroCell.key = 0;
+    m_zeroCell.value = 0;
+}
+
+//----------------------------------------------
+//  LockFreeHashTable::~LockFreeHashTable
+//----------------------------------------------
+LockFreeHashTable::~LockFreeHashTable()
+{
+    delete[] m_cells;
+}
+
+//----------------------------------------------
+//  LockFreeHashTable::Increment
+//----------------------------------------------
+size_t LockFreeHashTable::Increment(size_t key)
+{
+    if (key)
+    {
+        size_t index = FIRST_INDEX(integerHash(key));
+        for (size_t probes = 0; probes < m_arraySize; probes++, index = CIRCULAR_NEXT_INDEX(index))
+        {
+            Cell* cell = m_cells + index;
+            size_t probedKey = cell->key;
+            if (probedKey != key)
+            {
+                if (probedKey != 0)
+                    continue;
+                // Try to claim the unused cell. If another thread got there first, it may have used our key
+                probedKey = COMPARE_EXCHANGE_SIZE_T(&cell->key, key, 0);
+                if (probedKey != 0 && probedKey != key)
+                    continue;
+            }
+            return INCREMENT_SIZE_T(&cell->value);
+        }
+        assert(0);      // Over capacity
+        return 0;
+    }
+    else
+    {
+        InterlockedExchange(&m_zeroUsed, 1);
+        return INCREMENT_SIZE_T(&m_zeroCell.value);
+    }
+}
+
+//----------------------------------------------
+//  LockFreeHashTable::Lookup
+//----------------------------------------------
+bool LockFreeHashTable::Lookup(size_t key, size_t& value)
+{
+    if (key)
+    {
+        size_t index = FIRST_INDEX(integerHash(key));
+        for (size_t probes = 0; probes < m_arraySize; probes++, index = CIRCULAR_NEXT_INDEX(index))
+        {
+            size_t probedKey = m_cells[index].key;
+            if (probedKey == key)
+            {
+                value = m_cells[index].value;
+                return true;
+            }
+            if (probedKey == 0)
+                return false;
+        }
+        return false;
+    }
+    else
+    {
+        if (!m_zeroUsed)
+            return false;
+        value = m_zeroCell.value;
+        return true;
+    }
+}
+
+//----------------------------------------------
+//  LockFreeHashTable::Clear
+//----------------------------------------------
+void LockFreeHashTable::Clear()
+{
+    memset((void*) m_cells, 0, sizeof(Cell) * m_arraySize);
+    m_zeroUsed = 0;
+    m_zeroCell.value = 0;
+}
+
+//----------------------------------------------
+//  Iterator::Iterator
+//----------------------------------------------
+LockFreeHashTable::Iterator::Iterator(LockFreeHashTable &table) : m_table(table)
+{
+    m_cur = &m_table.m_zeroCell;
+    if (!m_table.m_zeroUsed)
+        Next();
+}
+
+//----------------------------------------------
+//  Iterator::Next
+//----------------------------------------------
+LockFreeHashTable::Cell* LockFreeHashTable::Iterator::Next()
+{
+    // Already finished?
+    if (!m_cur)
+        return m_cur;
+
+    // Iterate past zero cell
+    if (m_cur == &m_table.m_zeroCell)
+        m_cur = &m_table.m_cells[-1];
+
+    // Iterate through the regular cells
+    Cell* end = m_table.m_cells + m_table.m_arraySize;
+    while (++m_cur != end)
+    {
+        if (m_cur->key)
+            return m_cur;
+    }
+
+    // Finished
+    return m_cur = NULL;
+}
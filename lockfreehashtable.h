@@ -0,0 +1,54 @@
+#pragma once
+
+
+//----------------------------------------------
+//  LockFreeHashTable
+//
+//  Thread-safe map with no locks, for comparison with ShardedHashTable.
+//  Uses open addressing with linear probing, like HashTable. A thread claims an unused cell
+//  by setting its key with compare-and-swap, and values are only changed with atomic adds.
+//  The price is a fixed-size array: it never resizes, so the capacity passed to the
+//  constructor must cover every key that will be inserted. Deletion is not supported.
+//  Like HashTable, key = 0 marks an unused cell, and the value for key 0 is stored in m_zeroCell.
+//----------------------------------------------
+class LockFreeHashTable
+{
+public:
+    struct Cell
+    {
+        volatile size_t key;
+        volatile size_t value;
+    };
+
+private:
+    Cell* m_cells;
+    size_t m_arraySize;
+    volatile LONG m_zeroUsed;
+    Cell m_zeroCell;
+
+public:
+    LockFreeHashTable(size_t capacity);
+    ~LockFreeHashTable();
+
+    // Basic operations
+    size_t Increment(size_t key);
+    bool Lookup(size_t key, size_t& value);
+
+    // Not thread-safe
+    void Clear();
+
+    // Iteration; not thread-safe
+    friend class Iterator;
+    class Iterator
+    {
+    private:
+        LockFreeHashTable& m_table;
+        Cell* m_cur;
+
+    public:
+        Iterator(LockFreeHashTable &table);
+        Cell* Next();
+        inline Cell* operator*() const { return m_cur; }
+        inline Cell* operator->() const { return m_cur; }
+    };
+};
@@ -6,6 +6,20 @@
 #include "test_lookup.h"
 #elif INTEGER_MAP_EXPERIMENT(MEMORY)
 #include "test_memory.h"
+#elif INTEGER_MAP_EXPERIMENT(ITERATE)
+#include "test_iterate.h"
+#elif INTEGER_MAP_EXPERIMENT(COLDSTART)
+#include "test_coldstart.h"
+#elif INTEGER_MAP_EXPERIMENT(SERIALIZE)
+#include "test_serialize.h"
+#elif INTEGER_MAP_EXPERIMENT(CONCURRENT)
+#include "test_concurrent.h"
+#elif INTEGER_MAP_EXPERIMENT(AGGREGATE)
+#include "test_aggregate.h"
+#elif INTEGER_MAP_EXPERIMENT(RADIX)
+#include "test_radix.h"
+#elif INTEGER_MAP_EXPERIMENT(HASH_QUALITY)
+#include "test_hash_quality.h"
 #endif
 
 TestParams g_Params;
@@ -14,27 +28,126 @@ TestParams g_Params;
 //---------------------------------------------------
 // GenerateKeys
 //---------------------------------------------------
-void GenerateKeys(std::vector<size_t>& m_keys, int keyCount, int M)
+#if (INTEGER_MAP_KEY_GENERATION(RANDOM_SEQUENCE_OF_UNIQUE_64) || INTEGER_MAP_KEY_GENERATION(CLUSTERED)) \
+    && (INTEGER_MAP_KEY_BITS < 1 || INTEGER_MAP_KEY_BITS > 64 || (!defined(_WIN64) && INTEGER_MAP_KEY_BITS > 32))
+    #error INTEGER_MAP_KEY_BITS must be from 1 to 64, and at most 32 in a 32-bit build.
+#endif
+
+void GenerateKeys(KeySequence& keys, size_t keyCount, int M)
 {
+    keys.m_count = keyCount;
+#if INTEGER_MAP_KEY_GENERATION(RANDOM_SEQUENCE_OF_UNIQUE)
+    if (keyCount > 0xffffffffull)
+    {
+        fputs("RANDOM_SEQUENCE_OF_UNIQUE only has 2^32 keys; use RANDOM_SEQUENCE_OF_UNIQUE_64\n", stderr);
+        exit(1);
+    }
+#elif INTEGER_MAP_KEY_GENERATION(RANDOM_SEQUENCE_OF_UNIQUE_64)
+    // Past 2^KEY_BITS keys, the sequence wraps around and repeats them
+    if (INTEGER_MAP_KEY_BITS < 64 && (unsigned long long) keyCount > (1ull << (INTEGER_MAP_KEY_BITS & 63)))
+    {
+        fprintf(stderr, "%llu unique keys don't fit in %d bits\n", (unsigned long long) keyCount, INTEGER_MAP_KEY_BITS);
+        exit(1);
+    }
+#endif
+
+#if INTEGER_MAP_LAZY_KEYS
+    // Each key is computed when it's read; see KeySequence
+#if INTEGER_MAP_KEY_GENERATION(RANDOM_SEQUENCE_OF_UNIQUE)
+    keys.m_sequence = RandomSequenceOfUnique(g_Params.seed + M, g_Params.seed + M);
+#elif INTEGER_MAP_KEY_GENERATION(RANDOM_SEQUENCE_OF_UNIQUE_64)
+    keys.m_sequence = RandomSequenceOfUnique64(g_Params.seed + M, g_Params.seed + M, INTEGER_MAP_KEY_BITS);
+#endif
+
+#else
+    std::vector<size_t>& m_keys = keys.m_keys;
     m_keys.resize(keyCount);
 
 #if INTEGER_MAP_KEY_GENERATION(LINEAR)
-    for (int i = 0; i < keyCount; i++)
+    for (size_t i = 0; i < keyCount; i++)
     {
         m_keys[i] = i;
     }
 
 #elif INTEGER_MAP_KEY_GENERATION(RANDOM_SEQUENCE_OF_UNIQUE)
     RandomSequenceOfUnique rsu(g_Params.seed + M, g_Params.seed + M);
-    for (int i = 0; i < keyCount; i++)
+    for (size_t i = 0; i < keyCount; i++)
     {
         m_keys[i] = rsu.next();
     }
 
+#elif INTEGER_MAP_KEY_GENERATION(RANDOM_SEQUENCE_OF_UNIQUE_64)
+    RandomSequenceOfUnique64 rsu(g_Params.seed + M, g_Params.seed + M, INTEGER_MAP_KEY_BITS);
+    for (size_t i = 0; i < keyCount; i++)
+    {
+        m_keys[i] = (size_t) rsu.next();
+    }
+
+#elif INTEGER_MAP_KEY_GENERATION(CLUSTERED)
+#if INTEGER_MAP_KEY_CLUSTER_COUNT < 1 || INTEGER_MAP_KEY_CLUSTER_STRIDE < 1
+    #error INTEGER_MAP_KEY_CLUSTER_COUNT and INTEGER_MAP_KEY_CLUSTER_STRIDE must be at least 1.
+#endif
+    // Dense ranges of IDs, like those of different tenants, separated by large gaps.
+    // Each key joins cluster c with probability proportional to 1 / (c + 1)^(ZIPF_PERCENT / 100),
+    // and takes that cluster's next ID, so every prefix of the keys is clustered the same way.
+    Xoshiro256 random(g_Params.seed + M);
+    const int clusterCount = INTEGER_MAP_KEY_CLUSTER_COUNT;
+    std::vector<double> cumulative(clusterCount);
+    double totalWeight = 0;
+    for (int c = 0; c < clusterCount; c++)
+    {
+        totalWeight += pow(c + 1.0, -INTEGER_MAP_KEY_CLUSTER_ZIPF_PERCENT / 100.0);
+        cumulative[c] = totalWeight;
+    }
+    std::vector<int> clusterOf(keyCount);
+    std::vector<unsigned long long> clusterSize(clusterCount);
+    for (size_t i = 0; i < keyCount; i++)
+    {
+        double u = (random.next64() >> 11) * (totalWeight / 9007199254740992.0);   // 2^53
+        int c = (int) (std::upper_bound(cumulative.begin(), cumulative.end(), u) - cumulative.begin());
+        if (c >= clusterCount)
+            c = clusterCount - 1;
+        clusterOf[i] = c;
+        m_keys[i] = (size_t) clusterSize[c]++;     // Index within the cluster, for now
+    }
+
+    // Lay the clusters out in random order, with a random gap before each.
+    // No gap is larger than an even share of the unused key space, so the last cluster still fits.
+    unsigned long long maxKey = INTEGER_MAP_KEY_BITS >= 64 ? ~0ull : (1ull << INTEGER_MAP_KEY_BITS) - 1;
+    unsigned long long span = (unsigned long long) keyCount * INTEGER_MAP_KEY_CLUSTER_STRIDE;
+    if (span > maxKey)
+    {
+        fprintf(stderr, "%llu keys with stride %d don't fit in %d bits\n", (unsigned long long) keyCount, INTEGER_MAP_KEY_CLUSTER_STRIDE, INTEGER_MAP_KEY_BITS);
+        exit(1);
+    }
+    unsigned long long maxGap = (maxKey - span) / clusterCount;
+    std::vector<int> order(clusterCount);
+    for (int c = 0; c < clusterCount; c++)
+        order[c] = c;
+    for (int c = 0; c < clusterCount; c++)
+    {
+        int swap = c + (int) (random.next64() % (clusterCount - c));
+        int temp = order[c];
+        order[c] = order[swap];
+        order[swap] = temp;
+    }
+    std::vector<unsigned long long> clusterBase(clusterCount);
+    unsigned long long next = 0;
+    for (int k = 0; k < clusterCount; k++)
+    {
+        next += random.next64() % (maxGap + 1);
+        clusterBase[order[k]] = next;
+        next += clusterSize[order[k]] * INTEGER_MAP_KEY_CLUSTER_STRIDE;
+    }
+    for (size_t i = 0; i < keyCount; i++)
+    {
+        m_keys[i] = (size_t) (clusterBase[clusterOf[i]] + m_keys[i] * (unsigned long long) INTEGER_MAP_KEY_CLUSTER_STRIDE);
+    }
+
 #elif INTEGER_MAP_KEY_GENERATION(SORTED_ADDRESSES) || INTEGER_MAP_KEY_GENERATION(SHUFFLED_ADDRESSES)
     // Inputs are simulated memory addresses
     size_t ptr = (g_Params.random.integer() % 0xfff0 + 0x10) * 0x10000;
-    for (int i = 0; i < keyCount; i++)
+    for (size_t i = 0; i < keyCount; i++)
     {
         m_keys[i] = ptr;
         ptr += g_Params.random.integer() % INTEGER_MAP_MAX_ADDRESS_BLOCK_SIZE;
@@ -43,9 +156,9 @@ void GenerateKeys(std::vector<size_t>& m_keys, int keyCount, int M)
 
 #if INTEGER_MAP_KEY_GENERATION(SHUFFLED_ADDRESSES)
     // Shuffle the addresses
-    for (int i = 0; i < keyCount; i++)
+    for (size_t i = 0; i < keyCount; i++)
     {
-        int swap = i + g_Params.random.integer() % (keyCount - i);
+        size_t swap = i + g_Params.RandomIndex(keyCount - i);
         size_t temp = m_keys[i];
         m_keys[i] = m_keys[swap];
         m_keys[swap] = temp;
@@ -55,19 +168,20 @@ void GenerateKeys(std::vector<size_t>& m_keys, int keyCount, int M)
 #else
     #error No such INTEGER_MAP_KEY_GENERATION type.
 #endif
+#endif // INTEGER_MAP_LAZY_KEYS
 }
 
 
 //---------------------------------------------------
 // DefineMarkers
 //---------------------------------------------------
-void TestParams::DefineMarkers(std::vector<int>& markers)
+void TestParams::DefineMarkers(std::vector<size_t>& markers)
 {
     markers.push_back(9);
-    int prevLimit = 9;
+    size_t prevLimit = 9;
     for (int m = 0;; m++)
     {
-        int limit = (int) (0.5f + powf(10, (float) m / this->granularity));
+        size_t limit = (size_t) (0.5f + powf(10, (float) m / this->granularity));
         if (limit > prevLimit)
         {
             markers.push_back(limit);
@@ -86,24 +200,150 @@ void ResultHolder::dump()
 {
     printf("{\n");
     printf("    'INTEGER_MAP_CACHE_STOMPER_ENABLED': %d,\n", INTEGER_MAP_CACHE_STOMPER_ENABLED);
+    printf("    'INTEGER_MAP_BACKGROUND_STOMPER': %d,\n", INTEGER_MAP_BACKGROUND_STOMPER);
     printf("    'INTEGER_MAP_TWEAK_PRIORITY_AFFINITY': %d,\n", INTEGER_MAP_TWEAK_PRIORITY_AFFINITY);
     printf("    'INTEGER_MAP_USE_DLMALLOC': %d,\n", INTEGER_MAP_USE_DLMALLOC);
+    printf("    'INTEGER_MAP_JUDY_SLAB_ALLOCATOR': %d,\n", INTEGER_MAP_JUDY_SLAB_ALLOCATOR);
+    printf("    'INTEGER_MAP_JUDY_SIMD_SEARCH': %d,\n", INTEGER_MAP_JUDY_SIMD_SEARCH);
+    printf("    'INTEGER_MAP_JUDY_CURSOR': %d,\n", INTEGER_MAP_JUDY_CURSOR);
+    printf("    'INTEGER_MAP_RADIX_PARTITIONED': %d,\n", INTEGER_MAP_RADIX_PARTITIONED);
+    printf("    'INTEGER_MAP_TABLE_STATS': %d,\n", INTEGER_MAP_TABLE_STATS);
+    printf("    'INTEGER_MAP_TABLE_BUCKETED': %d,\n", INTEGER_MAP_TABLE_BUCKETED);
+    printf("    'INTEGER_MAP_LAZY_KEYS': %d,\n", INTEGER_MAP_LAZY_KEYS);
+    printf("    'INTEGER_MAP_SAMPLED_MARKERS': %d,\n", INTEGER_MAP_SAMPLED_MARKERS);
     printf("    'INTEGER_MAP_TIMING_METHOD': '%s',\n", INTEGER_MAP_TIMING_METHOD_STR);
+    printf("    'INTEGER_MAP_TIMING_MODE': '%s',\n", INTEGER_MAP_TIMING_MODE_STR);
+    printf("    'INTEGER_MAP_CACHE_STOMPER_PATTERN': '%s',\n", INTEGER_MAP_CACHE_STOMPER_PATTERN_STR);
+    printf("    'INTEGER_MAP_COLD_CACHE': '%s',\n", INTEGER_MAP_COLD_CACHE_STR);
     printf("    'INTEGER_MAP_EXPERIMENT': '%s',\n", INTEGER_MAP_EXPERIMENT_STR);
     printf("    'INTEGER_MAP_CONTAINER': '%s',\n", INTEGER_MAP_CONTAINER_STR);
     printf("    'INTEGER_MAP_KEY_GENERATION': '%s',\n", INTEGER_MAP_KEY_GENERATION_STR);
+    printf("    'INTEGER_MAP_TABLE_HASH': '%s',\n", INTEGER_MAP_TABLE_HASH_STR);
     printf("    'INTEGER_MAP_MAX_ADDRESS_BLOCK_SIZE': %d,\n", INTEGER_MAP_MAX_ADDRESS_BLOCK_SIZE);
+    printf("    'INTEGER_MAP_KEY_BITS': %d,\n", INTEGER_MAP_KEY_BITS);
+    printf("    'INTEGER_MAP_KEY_CLUSTER_COUNT': %d,\n", INTEGER_MAP_KEY_CLUSTER_COUNT);
+    printf("    'INTEGER_MAP_KEY_CLUSTER_ZIPF_PERCENT': %d,\n", INTEGER_MAP_KEY_CLUSTER_ZIPF_PERCENT);
+    printf("    'INTEGER_MAP_KEY_CLUSTER_STRIDE': %d,\n", INTEGER_MAP_KEY_CLUSTER_STRIDE);
+    printf("    'INTEGER_MAP_JUDY_FREE_METHOD': '%s',\n", INTEGER_MAP_JUDY_FREE_METHOD_STR);
+    printf("    'INTEGER_MAP_JUDY_FREE_THREADS': %d,\n", INTEGER_MAP_JUDY_FREE_THREADS);
+    printf("    'INTEGER_MAP_THREADS': %d,\n", INTEGER_MAP_THREADS);
+    printf("    'INTEGER_MAP_TABLE_SHARD_BITS': %d,\n", INTEGER_MAP_TABLE_SHARD_BITS);
+    printf("    'INTEGER_MAP_L2_CACHE_SIZE': %d,\n", INTEGER_MAP_L2_CACHE_SIZE);
+    printf("    'INTEGER_MAP_TABLE_GROWTH_PERCENT': %d,\n", INTEGER_MAP_TABLE_GROWTH_PERCENT);
+    printf("    'INTEGER_MAP_TABLE_MAX_LOAD_PERCENT': %d,\n", INTEGER_MAP_TABLE_MAX_LOAD_PERCENT);
+    printf("    'INTEGER_MAP_BACKGROUND_STOMPER_CPU': %d,\n", INTEGER_MAP_BACKGROUND_STOMPER_CPU);
+    printf("    'INTEGER_MAP_BACKGROUND_STOMPER_BYTES': %d,\n", INTEGER_MAP_BACKGROUND_STOMPER_BYTES);
+    printf("    'INTEGER_MAP_BACKGROUND_STOMPER_MBPS': %d,\n", INTEGER_MAP_BACKGROUND_STOMPER_MBPS);
     printf("    'seed': %d,\n", g_Params.seed);
     printf("    'operationsPerGroup': %d,\n", g_Params.operationsPerGroup);
-    printf("    'keyCount': %d,\n", g_Params.keyCount);
+    printf("    'keyCount': %llu,\n", (unsigned long long) g_Params.keyCount);
     printf("    'granularity': %d,\n", g_Params.granularity);
     printf("    'stompBytes': %d,\n", g_Params.stompBytes);
     printf("    'results': [\n");
     for (int m = 0; m < results.size(); m++)
     {
-        printf("        (%d, %f),\n", results[m].marker, results[m].nanosecs);
+        printf("        (%llu, %f),\n", (unsigned long long) results[m].marker, results[m].nanosecs);
+    }
+    printf("    ],\n");
+    printf("    'teardown': [\n");
+    for (int m = 0; m < teardown.size(); m++)
+    {
+        printf("        (%llu, %f),\n", (unsigned long long) teardown[m].marker, teardown[m].nanosecs);
+    }
+    printf("    ],\n");
+    printf("    'warmup': [\n");
+    for (int m = 0; m < warmup.size(); m++)
+    {
+        printf("        (%llu, %f),\n", (unsigned long long) warmup[m].marker, warmup[m].nanosecs);
     }
     printf("    ],\n");
+    printf("    'load': [\n");
+    for (int m = 0; m < load.size(); m++)
+    {
+        printf("        (%llu, %f),\n", (unsigned long long) load[m].marker, load[m].nanosecs);
+    }
+    printf("    ],\n");
+    printf("    'filesize': [\n");
+    for (int m = 0; m < filesize.size(); m++)
+    {
+        printf("        (%llu, %f),\n", (unsigned long long) filesize[m].marker, filesize[m].nanosecs);
+    }
+    printf("    ],\n");
+#if INTEGER_MAP_BACKGROUND_STOMPER
+    printf("    'stompbandwidth': [\n");
+    for (int m = 0; m < stompBandwidth.size(); m++)
+    {
+        printf("        (%llu, %f),\n", (unsigned long long) stompBandwidth[m].marker, stompBandwidth[m].nanosecs);
+    }
+    printf("    ],\n");
+#endif
+#if !INTEGER_MAP_COLD_CACHE(NONE)
+    printf("    'resident': [\n");
+    for (int m = 0; m < resident.size(); m++)
+    {
+        printf("        (%llu, %f),\n", (unsigned long long) resident[m].marker, resident[m].nanosecs);
+    }
+    printf("    ],\n");
+    printf("    'pathnodes': [\n");
+    for (int m = 0; m < pathNodes.size(); m++)
+    {
+        printf("        (%llu, %f),\n", (unsigned long long) pathNodes[m].marker, pathNodes[m].nanosecs);
+    }
+    printf("    ],\n");
+#endif
+    printf("    'hashtime': [\n");
+    for (int m = 0; m < hashtime.size(); m++)
+    {
+        printf("        (%llu, %f),\n", (unsigned long long) hashtime[m].marker, hashtime[m].nanosecs);
+    }
+    printf("    ],\n");
+#if INTEGER_MAP_TABLE_STATS && INTEGER_MAP_CONTAINER(TABLE)
+    // Mean cells examined per search, as a series, then everything else
+    printf("    'probes': [\n");
+    for (int m = 0; m < tableStats.size(); m++)
+    {
+        const HashTable::Stats& s = tableStats[m].stats;
+        printf("        (%llu, %f),\n", (unsigned long long) tableStats[m].marker, s.lookups ? (double) s.lookupProbes / s.lookups : 0.0);
+    }
+    printf("    ],\n");
+    printf("    'maxprobe': [\n");
+    for (int m = 0; m < tableStats.size(); m++)
+    {
+        // Cells examined to find the stored key furthest from its hash's cell
+        printf("        (%llu, %llu),\n", (unsigned long long) tableStats[m].marker, (unsigned long long) tableStats[m].stats.maxProbeDistance + 1);
+    }
+    printf("    ],\n");
+    printf("    'tableStats': [\n");
+    for (int m = 0; m < tableStats.size(); m++)
+    {
+        const HashTable::Stats& s = tableStats[m].stats;
+        printf("        {'marker': %llu, 'population': %llu, 'arraySize': %llu, 'maxProbeDistance': %llu, 'resizes': %llu, 'bytesMoved': %llu, 'lookups': %llu, 'lookupProbes': %llu,\n",
+            (unsigned long long) tableStats[m].marker, (unsigned long long) s.population, (unsigned long long) s.arraySize, (unsigned long long) s.maxProbeDistance,
+            (unsigned long long) s.resizes, (unsigned long long) s.bytesMoved,
+            (unsigned long long) s.lookups, (unsigned long long) s.lookupProbes);
+        printf("            'probeDistance': [");
+        for (int b = 0; b < HashTable::Stats::kHistogramSize; b++)
+            printf("%llu, ", (unsigned long long) s.probeDistance[b]);
+        printf("],\n");
+        printf("            'clusterLength': [");
+        for (int b = 0; b < HashTable::Stats::kHistogramSize; b++)
+            printf("%llu, ", (unsigned long long) s.clusterLength[b]);
+        printf("]},\n");
+    }
+    printf("    ],\n");
+#endif
+#if INTEGER_MAP_CONTAINER(CUCKOO_TABLE)
+    printf("    'cuckooStats': [\n");
+    for (int m = 0; m < cuckooStats.size(); m++)
+    {
+        const CuckooHashTable::Stats& s = cuckooStats[m].stats;
+        printf("        {'marker': %llu, 'population': %llu, 'bucketCount': %llu, 'occupancy': %f, 'insertFailures': %llu, 'rehashes': %llu, 'displacements': %llu},\n",
+            (unsigned long long) cuckooStats[m].marker, (unsigned long long) s.population, (unsigned long long) s.bucketCount,
+            s.slotCount ? (double) s.population / s.slotCount : 0.0,
+            (unsigned long long) s.insertFailures, (unsigned long long) s.rehashes, (unsigned long long) s.displacements);
+    }
+    printf("    ],\n");
+#endif
     printf("}\n");
 }
 
@@ -119,8 +359,12 @@ int main(int argc, const char* argv[])
         return 1;
     }
 
-#if INTEGER_MAP_TWEAK_PRIORITY_AFFINITY
-    SetThreadAffinityMask(GetCurrentThread(), 1);
+#if INTEGER_MAP_TWEAK_PRIORITY_AFFINITY && !INTEGER_MAP_EXPERIMENT(CONCURRENT) && !INTEGER_MAP_EXPERIMENT(AGGREGATE)
+    // (Multithreaded experiments leave scheduling to the OS)
+    // Stay on the lowest processor we were launched with, so that gather_benchmarks.py can pin us elsewhere
+    DWORD_PTR processMask, systemMask;
+    GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+    SetThreadAffinityMask(GetCurrentThread(), processMask & (~processMask + 1));
     SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
 #endif
 
@@ -128,7 +372,7 @@ int main(int argc, const char* argv[])
 
     g_Params.seed = atoi(argv[1]);
     g_Params.operationsPerGroup = atoi(argv[2]);
-    g_Params.keyCount = atoi(argv[3]);
+    g_Params.keyCount = (size_t) _strtoui64(argv[3], NULL, 10);
     g_Params.granularity = atoi(argv[4]);
     g_Params.stompBytes = atoi(argv[5]);
     g_Params.random.reseed(g_Params.seed);
@@ -0,0 +1,116 @@
+#include <config.h>
+#include <windows.h>
+#include "parallelcounter.h"
+#include "util.h"
+#include <assert.h>
+
+
+//----------------------------------------------
+//  ParallelCounter::ParallelCounter
+//----------------------------------------------
+ParallelCounter::ParallelCounter(WorkerPool& pool, int partitionBits) : m_pool(pool)
+{
+    assert(partitionBits >= 0 && partitionBits < 16);
+    m_partitionBits = partitionBits;
+    m_local = new HashTable[m_pool.ThreadCount() * PartitionCount()];
+    m_merged = new HashTable[PartitionCount()];
+    m_keys = NULL;
+    m_keyCount = 0;
+}
+
+//----------------------------------------------
+//  ParallelCounter::~ParallelCounter
+//----------------------------------------------
+ParallelCounter::~ParallelCounter()
+{
+    delete[] m_local;
+    delete[] m_merged;
+}
+
+//----------------------------------------------
+//  ParallelCounter::PartitionFor
+//----------------------------------------------
+size_t ParallelCounter::PartitionFor(size_t key) const
+{
+    // HashTable picks cells using the top bits of the same hash, so use the low bits here
+    return (size_t) integerHash(key) & (PartitionCount() - 1);
+}
+
+//----------------------------------------------
+//  ParallelCounter::CountJob
+//----------------------------------------------
+void ParallelCounter::CountJob(int thread, int threadCount, void* arg)
+{
+    ParallelCounter* self = (ParallelCounter*) arg;
+    HashTable* local = self->m_local + thread * self->PartitionCount();
+
+    // Each thread counts a contiguous slice of the input
+    size_t begin = self->m_keyCount * thread / threadCount;
+    size_t end = self->m_keyCount * (thread + 1) / threadCount;
+    for (size_t i = begin; i < end; i++)
+    {
+        size_t key = self->m_keys[i];
+        local[self->PartitionFor(key)].Insert(key)->value++;
+    }
+}
+
+//----------------------------------------------
+//  ParallelCounter::MergeJob
+//----------------------------------------------
+void ParallelCounter::MergeJob(int thread, int threadCount, void* arg)
+{
+    ParallelCounter* self = (ParallelCounter*) arg;
+    size_t partitionCount = self->PartitionCount();
+
+    for (size_t p = thread; p < partitionCount; p += threadCount)
+    {
+        HashTable& merged = self->m_merged[p];
+        for (int t = 0; t < threadCount; t++)
+        {
+            // Add this thread's counts to the partition, then empty its table for the next Count()
+            HashTable& local = self->m_local[t * partitionCount + p];
+            for (HashTable::Iterator it(local); *it; it.Next())
+                merged.Insert(it->key)->value += it->value;
+            local.Clear();
+        }
+    }
+}
+
+//----------------------------------------------
+//  ParallelCounter::Count
+//----------------------------------------------
+void ParallelCounter::Count(const size_t* keys, size_t keyCount)
+{
+    m_keys = keys;
+    m_keyCount = keyCount;
+    m_pool.Run(CountJob, this);
+    m_pool.Run(MergeJob, this);
+    m_keys = NULL;
+    m_keyCount = 0;
+}
+
+//----------------------------------------------
+//  ParallelCounter::Lookup
+//----------------------------------------------
+bool ParallelCounter::Lookup(size_t key, size_t& value)
+{
+    HashTable::Cell* cell = m_merged[PartitionFor(key)].Lookup(key);
+    if (cell)
+        value = cell->value;
+    return cell != NULL;
+}
+
+//----------------------------------------------
+//  ParallelCounter::Clear
+//----------------------------------------------
+void ParallelCounter::Clear()
+{
+    size_t partitionCount = PartitionCount();
+    for (size_t p = 0; p < partitionCount; p++)
+    {
+        m_merged[p].Clear();
+        m_merged[p].Compact();
+    }
+    for (size_t i = 0; i < m_pool.ThreadCount() * partitionCount; i++)
+        m_local[i].Compact();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "hashtable.h"
+#include "workerpool.h"
+
+
+//----------------------------------------------
+//  ParallelCounter
+//
+//  Counts occurrences of each key in an input array, using every thread in a WorkerPool.
+//  First, each thread counts its own slice of the input into private HashTables, one per
+//  partition, where the low bits of the key's hash select the partition. Then each thread
+//  merges whole partitions: all the threads' tables for one partition are added into the
+//  result table for that partition. No two threads ever touch the same table, so there are
+//  no locks, and the merge never sees the same key in two partitions.
+//  Counts accumulate across calls to Count(), until Clear().
+//----------------------------------------------
+class ParallelCounter
+{
+private:
+    WorkerPool& m_pool;
+    int m_partitionBits;
+    HashTable* m_local;     // [thread * partitionCount + partition]
+    HashTable* m_merged;    // [partition]
+    const size_t* m_keys;
+    size_t m_keyCount;
+
+    size_t PartitionFor(size_t key) const;
+    static void CountJob(int thread, int threadCount, void* arg);
+    static void MergeJob(int thread, int threadCount, void* arg);
+
+public:
+    ParallelCounter(WorkerPool& pool, int partitionBits);
+    ~ParallelCounter();
+
+    void Count(const size_t* keys, size_t keyCount);
+    bool Lookup(size_t key, size_t& value);
+    void Clear();
+
+    size_t PartitionCount() const { return (size_t) 1 << m_partitionBits; }
+};
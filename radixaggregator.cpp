@@ -0,0 +1,182 @@
+#include <config.h>
+#include "radixaggregator.h"
+#include "util.h"
+#include <assert.h>
+#include <string.h>
+#include <emmintrin.h>
+
+
+// Rounds p up to the next cache line; new[] only guarantees word alignment
+#define ALIGN_TO_CACHE_LINE(p) (((size_t) (p) + RadixAggregator::kCacheLineSize - 1) & ~(RadixAggregator::kCacheLineSize - 1))
+
+
+//----------------------------------------------
+//  RadixAggregator::RadixAggregator
+//----------------------------------------------
+RadixAggregator::RadixAggregator(size_t cacheSize)
+{
+    size_t maxPartitions = (size_t) 1 << kMaxPartitionBits;
+    m_cacheSize = cacheSize;
+    m_partitionBits = -1;
+    m_tables = new HashTable[maxPartitions];
+
+    m_scatterMemory = NULL;
+    m_scatter = NULL;
+    m_scatterCapacity = 0;
+
+    m_lineMemory = new char[kCacheLineSize * maxPartitions + kCacheLineSize - 1];
+    m_lines = (size_t (*)[kLineKeys]) ALIGN_TO_CACHE_LINE(m_lineMemory);
+    m_begin = new size_t[maxPartitions];
+    m_end = new size_t[maxPartitions];
+}
+
+//----------------------------------------------
+//  RadixAggregator::~RadixAggregator
+//----------------------------------------------
+RadixAggregator::~RadixAggregator()
+{
+    delete[] m_tables;
+    delete[] m_scatterMemory;
+    delete[] m_lineMemory;
+    delete[] m_begin;
+    delete[] m_end;
+}
+
+//----------------------------------------------
+//  RadixAggregator::PartitionFor
+//----------------------------------------------
+size_t RadixAggregator::PartitionFor(size_t key) const
+{
+    // HashTable picks cells using the top bits of the same hash, so use the low bits here
+    return (size_t) integerHash(key) & (PartitionCount() - 1);
+}
+
+//----------------------------------------------
+//  RadixAggregator::ChoosePartitionBits
+//----------------------------------------------
+void RadixAggregator::ChoosePartitionBits(size_t keyCount)
+{
+    // With the default growth settings, a HashTable is between 3/8 and 3/4 full, so allow two cells per key
+    m_partitionBits = 0;
+    while (m_partitionBits < kMaxPartitionBits
+        && (keyCount >> m_partitionBits) * sizeof(HashTable::Cell) * 2 > m_cacheSize)
+        m_partitionBits++;
+}
+
+//----------------------------------------------
+//  RadixAggregator::ReserveScatter
+//----------------------------------------------
+void RadixAggregator::ReserveScatter(size_t capacity)
+{
+    if (capacity <= m_scatterCapacity)
+        return;
+    delete[] m_scatterMemory;
+    m_scatterMemory = new char[capacity * sizeof(size_t) + kCacheLineSize - 1];
+    m_scatter = (size_t*) ALIGN_TO_CACHE_LINE(m_scatterMemory);
+    m_scatterCapacity = capacity;
+}
+
+//----------------------------------------------
+//  RadixAggregator::Scatter
+//----------------------------------------------
+void RadixAggregator::Scatter(const size_t* keys, size_t keyCount)
+{
+    size_t partitionCount = PartitionCount();
+
+    // Histogram of partition sizes
+    memset(m_end, 0, sizeof(size_t) * partitionCount);
+    for (size_t i = 0; i < keyCount; i++)
+        m_end[PartitionFor(keys[i])]++;
+
+    // Lay out the partitions, each starting on a cache line
+    size_t offset = 0;
+    for (size_t p = 0; p < partitionCount; p++)
+    {
+        size_t size = m_end[p];
+        m_begin[p] = offset;
+        m_end[p] = offset;
+        offset += (size + kLineKeys - 1) & ~(kLineKeys - 1);
+    }
+    ReserveScatter(offset);
+
+    // Stage each key in its partition's line, and stream out each line once it's full.
+    // Since each partition starts on a cache line, m_end[p] mod kLineKeys is the key's slot in the line.
+    for (size_t i = 0; i < keyCount; i++)
+    {
+        size_t key = keys[i];
+        size_t p = PartitionFor(key);
+        size_t slot = m_end[p]++ & (kLineKeys - 1);
+        m_lines[p][slot] = key;
+        if (slot == kLineKeys - 1)
+        {
+            __m128i* src = (__m128i*) m_lines[p];
+            __m128i* dst = (__m128i*) (m_scatter + m_end[p] - kLineKeys);
+            for (size_t j = 0; j < kCacheLineSize / sizeof(__m128i); j++)
+                _mm_stream_si128(dst + j, _mm_load_si128(src + j));
+        }
+    }
+
+    // Copy out the partially filled lines
+    for (size_t p = 0; p < partitionCount; p++)
+    {
+        size_t remaining = m_end[p] & (kLineKeys - 1);
+        memcpy(m_scatter + m_end[p] - remaining, m_lines[p], sizeof(size_t) * remaining);
+    }
+
+    // Make the non-temporal stores visible before the partitions are read back
+    _mm_sfence();
+}
+
+//----------------------------------------------
+//  RadixAggregator::Count
+//----------------------------------------------
+void RadixAggregator::Count(const size_t* keys, size_t keyCount)
+{
+    if (m_partitionBits < 0)
+        ChoosePartitionBits(keyCount);
+
+    // A single partition already fits in cache, so count directly
+    if (m_partitionBits == 0)
+    {
+        for (size_t i = 0; i < keyCount; i++)
+            m_tables[0].Insert(keys[i])->value++;
+        return;
+    }
+
+    Scatter(keys, keyCount);
+
+    size_t partitionCount = PartitionCount();
+    for (size_t p = 0; p < partitionCount; p++)
+    {
+        HashTable& table = m_tables[p];
+        for (size_t i = m_begin[p]; i < m_end[p]; i++)
+            table.Insert(m_scatter[i])->value++;
+    }
+}
+
+//----------------------------------------------
+//  RadixAggregator::Lookup
+//----------------------------------------------
+bool RadixAggregator::Lookup(size_t key, size_t& value)
+{
+    if (m_partitionBits < 0)
+        return false;
+    HashTable::Cell* cell = m_tables[PartitionFor(key)].Lookup(key);
+    if (cell)
+        value = cell->value;
+    return cell != NULL;
+}
+
+//----------------------------------------------
+//  RadixAggregator::Clear
+//----------------------------------------------
+void RadixAggregator::Clear()
+{
+    size_t partitionCount = PartitionCount();
+    for (size_t p = 0; p < partitionCount; p++)
+    {
+        m_tables[p].Clear();
+        m_tables[p].Compact();
+    }
+    m_partitionBits = -1;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "hashtable.h"
+
+
+//----------------------------------------------
+//  RadixAggregator
+//
+//  Counts occurrences of each key in an input array, in two passes, so that no pass works
+//  on more memory than the cache holds at once.
+//  First, the keys are scattered into partitions, where the low bits of the key's hash select
+//  the partition. Keys are staged in a cache-line-sized write-combining buffer per partition,
+//  and each full line is written out with non-temporal stores, so the scatter doesn't read the
+//  destination lines or evict the buffers from cache.
+//  Then each partition is counted into its own HashTable, which stays in a cache of
+//  cacheSize bytes while that partition is processed.
+//  The number of partitions is chosen by the first Count() after construction or Clear(),
+//  assuming every input key is distinct, and is capped at 2^kMaxPartitionBits, beyond which
+//  the write-combining buffers themselves no longer fit in L1.
+//  Counts accumulate across calls to Count(), until Clear().
+//----------------------------------------------
+class RadixAggregator
+{
+public:
+    static const size_t kCacheLineSize = 64;
+    static const int kMaxPartitionBits = 10;
+
+private:
+    static const size_t kLineKeys = kCacheLineSize / sizeof(size_t);
+
+    size_t m_cacheSize;
+    int m_partitionBits;        // -1 until the first Count()
+    HashTable* m_tables;        // [partition]
+
+    // Scatter buffer, with each partition starting on a cache line
+    char* m_scatterMemory;
+    size_t* m_scatter;
+    size_t m_scatterCapacity;
+
+    // Write-combining buffers, one cache line per partition
+    char* m_lineMemory;
+    size_t (*m_lines)[kLineKeys];
+    size_t* m_begin;            // [partition] Index of the partition's first key in m_scatter
+    size_t* m_end;              // [partition] Index past the partition's last key in m_scatter
+
+    size_t PartitionFor(size_t key) const;
+    void ChoosePartitionBits(size_t keyCount);
+    void ReserveScatter(size_t capacity);
+    void Scatter(const size_t* keys, size_t keyCount);
+
+public:
+    RadixAggregator(size_t cacheSize);
+    ~RadixAggregator();
+
+    void Count(const size_t* keys, size_t keyCount);
+    bool Lookup(size_t key, size_t& value);
+    void Clear();
+
+    size_t PartitionCount() const { return m_partitionBits > 0 ? (size_t) 1 << m_partitionBits : 1; }
+};
@@ -18,7 +18,7 @@ private:
     }
 
 public:
-    RandomSequenceOfUnique(unsigned int seedBase, unsigned int seedOffset)
+    RandomSequenceOfUnique(unsigned int seedBase = 0, unsigned int seedOffset = 0)
     {
         m_index = shuffleQPR(shuffleQPR(seedBase) + 0x682f0161);
         m_intermediateOffset = shuffleQPR(shuffleQPR(seedOffset) + 0x46790905);
@@ -28,7 +28,89 @@ public:
     {
         return shuffleQPR((shuffleQPR(m_index++) + m_intermediateOffset) ^ 0x5bf03635);
     }
+
+    // The value next() will return after another position calls
+    unsigned int at(unsigned int position) const
+    {
+        return shuffleQPR((shuffleQPR(m_index + position) + m_intermediateOffset) ^ 0x5bf03635);
+    }
 };
 
 
+//----------------------------------------------
+//  RandomSequenceOfUnique64
+//
+//  Like RandomSequenceOfUnique, but visits every value of up to 64 bits, so the keys can use
+//  the whole word. A 4-round Feistel network permutes a counter, with the MurmurHash3 finalizer
+//  as the round function. For an odd number of bits, the network is one bit wider, and any
+//  result out of range is put through it again until it lands in range, which still gives a
+//  permutation.
+//----------------------------------------------
+class RandomSequenceOfUnique64
+{
+private:
+    static const int kRounds = 4;
+
+    unsigned long long m_index;
+    unsigned long long m_mask;      // All values have only these bits
+    int m_halfBits;
+    unsigned long long m_halfMask;
+    unsigned long long m_roundKeys[kRounds];
+
+    static unsigned long long mix(unsigned long long k)
+    {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdull;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ull;
+        k ^= k >> 33;
+        return k;
+    }
+
+    unsigned long long feistel(unsigned long long x) const
+    {
+        unsigned long long left = x >> m_halfBits;
+        unsigned long long right = x & m_halfMask;
+        for (int r = 0; r < kRounds; r++)
+        {
+            unsigned long long next = left ^ (mix(right ^ m_roundKeys[r]) & m_halfMask);
+            left = right;
+            right = next;
+        }
+        return (left << m_halfBits) | right;
+    }
+
+    unsigned long long permute(unsigned long long x) const
+    {
+        do
+            x = feistel(x);
+        while (x & ~m_mask);
+        return x;
+    }
+
+public:
+    RandomSequenceOfUnique64(unsigned int seedBase = 0, unsigned int seedOffset = 0, int bits = 64)
+    {
+        m_mask = bits >= 64 ? ~(unsigned long long) 0 : ((unsigned long long) 1 << bits) - 1;
+        m_halfBits = (bits + 1) / 2;
+        m_halfMask = ((unsigned long long) 1 << m_halfBits) - 1;
+        m_index = mix((unsigned long long) seedBase + 0x682f0161) & m_mask;
+        for (int r = 0; r < kRounds; r++)
+            m_roundKeys[r] = mix(((unsigned long long) seedOffset << 8) + r + 0x46790905);
+    }
+
+    unsigned long long next()
+    {
+        unsigned long long result = permute(m_index);
+        m_index = (m_index + 1) & m_mask;
+        return result;
+    }
+
+    // The value next() will return after another position calls
+    unsigned long long at(unsigned long long position) const
+    {
+        return permute((m_index + position) & m_mask);
+    }
+};
+
 #endif // __RANDOM_SEQUENCE_H__
@@ -2,6 +2,8 @@ import subprocess
 import shelve
 import os
 import cPickle
+import hashlib
+import threading
 import time
 
 
@@ -19,16 +21,44 @@ class CMakeBuilder:
         finally:
             os.chdir(prevDir)
         self.prevDefs = None
+        self.srcPath = absSrcPath
         self.buildPath = buildPath
+        self.generator = generator
         self.config = config
+        self.separateBuilds = False
+        self.frozen = False     # With separateBuilds, refuse to build any configuration not built yet
+        self.builtPaths = {}
+        self.lock = threading.Lock()
             
     def build(self, **defs):
-        """If the definitions (defs) have changed, use CMake to reconfigure and build the project."""
+        """If the definitions (defs) have changed, use CMake to reconfigure and build the project.
+        With separateBuilds, each set of definitions is built once, in its own folder, so that several
+        configurations can run at the same time. Once frozen, asking for a configuration which wasn't
+        built before is an error. Returns the folder."""
+        if self.separateBuilds:
+            return self.buildSeparately(**defs)
         if self.prevDefs == None or defs != self.prevDefs:
             defines = ['-D%s=%s' % (k, str(v)) for k, v in defs.iteritems()]
             subprocess.check_output(['cmake'] + defines + [self.buildPath])
             subprocess.check_output(['cmake', '--build', self.buildPath, '--config', self.config])
             self.prevDefs = defs        
+        return self.buildPath
+
+    def buildSeparately(self, **defs):
+        key = repr(sorted(defs.items()))
+        with self.lock:
+            if key not in self.builtPaths:
+                if self.frozen:
+                    raise RuntimeError('Configuration was not built before the runs started: %s' % key)
+                path = os.path.join(self.buildPath + '_configs', hashlib.md5(key).hexdigest()[:12])
+                if not os.path.exists(path):
+                    os.makedirs(path)
+                args = ['-G', self.generator] if self.generator else []
+                defines = ['-D%s=%s' % (k, str(v)) for k, v in defs.iteritems()]
+                subprocess.check_output(['cmake'] + args + defines + [self.srcPath], cwd=path)
+                subprocess.check_output(['cmake', '--build', path, '--config', self.config])
+                self.builtPaths[key] = path
+            return self.builtPaths[key]
 
 
 class CMakeLauncher:
@@ -41,17 +71,29 @@ class CMakeLauncher:
         self.exeName = exeName
         self.ignoreCache = False
         self.configName = configName
+        # Optional function returning (core, command prefix) for the calling thread, to pin the executable to a core
+        self.placement = None
+        self.lock = threading.Lock()    # shelve isn't thread-safe
 
     def run(self, *args, **defs):        
         """First check for existing results in the persistent cache. If they don't exist, build/run the executable."""
+        return self.runWithCore(*args, **defs)[0]
+
+    def runWithCore(self, *args, **defs):
+        """Like run, but also returns the core which produced the value, or None if it wasn't pinned.
+        The core is cached along with the value, under a separate key."""
         key = cPickle.dumps((args, defs))
-        if not self.ignoreCache:
-            if key in self.cachedResults:
-                return self.cachedResults[key]
-        self.cmakeBuilder.build(**defs)
+        with self.lock:
+            if not self.ignoreCache:
+                if key in self.cachedResults:
+                    return self.cachedResults[key], self.cachedResults.get('core:' + key)
+        buildPath = self.cmakeBuilder.build(**defs)
         # It would be cool if CMake could tell us the name of the output executable.
-        pathToExe = os.path.join(self.cmakeBuilder.buildPath, self.configName, self.exeName)
+        pathToExe = os.path.join(buildPath, self.configName, self.exeName)
+        core, prefix = self.placement() if self.placement else (None, [])
         time.sleep(0.2)  # In case the OS steals some CPU time refreshing the display from previous print statements.
-        value = subprocess.check_output([pathToExe] + [str(a) for a in args])
-        self.cachedResults[key] = value
-        return value
+        value = subprocess.check_output(prefix + [pathToExe] + [str(a) for a in args])
+        with self.lock:
+            self.cachedResults[key] = value
+            self.cachedResults['core:' + key] = core
+        return value, core
@@ -2,22 +2,45 @@
 # Perform a bunch of experiments using CompareIntegerMaps.exe, and writes the results to results.txt.
 # You can filter the experiments by name by passing a regular expression as a script argument.
 # For example: run_tests.py LOOKUP_0_.*
+# Pass --64bit when GENERATOR makes a 64-bit build, to also run the experiments with keys wider than
+# 32 bits. Pass --huge to also run the billion-key experiments, which need a 64-bit build and a machine
+# with hundreds of GB of memory.
 # Results are also cached in an intermediate directory, temp, so you can add new results to results.txt
 # without redoing previous experiments.
+# Pass --jobs=N to run N experiments at a time, each pinned to its own core, or --cores=2-9,12 to pick
+# the cores yourself.
 #---------------------------------------------------
 
 import cmake_launcher
+import ctypes
+import glob
 import math
+import multiprocessing
 import os
+import random
 import re
 import sys
-from collections import defaultdict
+import threading
+import time
+from collections import defaultdict, deque
 from pprint import pprint
 
 
 #GENERATOR = 'Visual Studio 10'
 IGNORE_CACHE = False
 
+# Experiments with more than one seed keep running more seeds until the bootstrap confidence interval of
+# every marker is narrower than CI_TARGET times its value, or until they've used CI_BUDGET seconds or
+# CI_MAX_SEEDS seeds. The number of seeds each experiment asks for is then a minimum, raised to
+# CI_MIN_SEEDS, since a bootstrap from fewer seeds can look narrow by chance. Set CI_TARGET to 0, or
+# pass --ci=0, to run exactly the requested seeds.
+CI_TARGET = 0.05
+CI_LEVEL = 0.95
+CI_MIN_SEEDS = 5
+CI_MAX_SEEDS = 64
+CI_BUDGET = 600
+CI_RESAMPLES = 200
+
 
 #---------------------------------------------------
 #  TestLauncher
@@ -27,8 +50,32 @@ class TestLauncher:
     
     DEFAULT_DEFS = {
         'CACHE_STOMPER_ENABLED': 0,
+        'CACHE_STOMPER_PATTERN': 'LINES',
+        'BACKGROUND_STOMPER': 0,
+        'BACKGROUND_STOMPER_BYTES': 67108864,
+        'TIMING_MODE': 'LATENCY',
+        'COLD_CACHE': 'NONE',
         'EXPERIMENT': 'INSERT',
         'CONTAINER': 'TABLE',
+        'USE_DLMALLOC': 1,
+        'JUDY_SLAB_ALLOCATOR': 0,
+        'JUDY_SIMD_SEARCH': 1,
+        'JUDY_CURSOR': 1,
+        'JUDY_FREE_METHOD': 'SYNC',
+        'THREADS': 4,
+        'RADIX_PARTITIONED': 1,
+        'TABLE_STATS': 0,
+        'TABLE_BUCKETED': 0,
+        'TABLE_GROWTH_PERCENT': 200,
+        'TABLE_MAX_LOAD_PERCENT': 75,
+        'TABLE_HASH': 'MURMUR',
+        'KEY_GENERATION': 'RANDOM_SEQUENCE_OF_UNIQUE',
+        'KEY_BITS': 64,
+        'KEY_CLUSTER_COUNT': 1000,
+        'KEY_CLUSTER_ZIPF_PERCENT': 100,
+        'KEY_CLUSTER_STRIDE': 1,
+        'LAZY_KEYS': 0,
+        'SAMPLED_MARKERS': 0,
     }
 
     def __init__(self):
@@ -36,14 +83,39 @@ class TestLauncher:
         # It would be cool to get CMake to tell us the path to the executable instead.
         self.launcher = cmake_launcher.CMakeLauncher(cmakeBuilder, 'CompareIntegerMaps.exe')
 
+    def fullDefs(self, defs):
+        mergedDefs = dict(self.DEFAULT_DEFS)
+        mergedDefs.update(defs)
+        return dict([('INTEGER_MAP_' + k, v) for k, v in mergedDefs.iteritems()])
+
     def run(self, seed, operationsPerGroup, keyCount, granularity, stompBytes, **defs):
+        """ Returns the output of one run, with the core it ran on under 'core'. """
         args = [seed, operationsPerGroup, keyCount, granularity, stompBytes]
+        self.launcher.ignoreCache = IGNORE_CACHE
+        output, core = self.launcher.runWithCore(*args, **self.fullDefs(defs))
+        r = eval(output)
+        r['core'] = core
+        return r
+
+    def requirements(self, **defs):
+        """ Returns (cores, exclusive): how many cores a run uses, including its stomper's, and whether it
+        must run alone, because it uses more than one core or thrashes the shared last-level cache. """
         mergedDefs = dict(self.DEFAULT_DEFS)
         mergedDefs.update(defs)
-        fullDefs = dict([('INTEGER_MAP_' + k, v) for k, v in mergedDefs.iteritems()])
-        self.launcher.ignoreCache = IGNORE_CACHE
-        output = self.launcher.run(*args, **fullDefs)
-        return eval(output)
+        cores = 1
+        if mergedDefs['EXPERIMENT'] in ('CONCURRENT', 'AGGREGATE'):
+            cores = mergedDefs['THREADS']
+        elif mergedDefs['CONTAINER'] == 'JUDY' and mergedDefs['JUDY_FREE_METHOD'] != 'SYNC':
+            cores = 1 + mergedDefs.get('JUDY_FREE_THREADS', 4)
+        if mergedDefs['BACKGROUND_STOMPER']:
+            # The stomper runs on the BACKGROUND_STOMPER_CPU'th processor the run is given
+            cores = max(cores, mergedDefs.get('BACKGROUND_STOMPER_CPU', 1) + 1)
+        return cores, cores > 1 or mergedDefs['COLD_CACHE'] == 'THRASH'
+
+    def prepare(self, **defs):
+        """ Builds the configuration for an experiment. Even if its requested seeds are all cached, an
+        adaptive experiment may need more of them, so it's always built. """
+        self.launcher.cmakeBuilder.build(**self.fullDefs(defs))
 
 
 #---------------------------------------------------
@@ -51,6 +123,9 @@ class TestLauncher:
 #---------------------------------------------------
 class Experiment:
     """ A group of CompareIntegerMaps runs using similar options but different seeds. """
+
+    # Secondary result lists some experiments output, each stored as a dataset named <name>_<KEY>
+    EXTRA_SERIES = ['teardown', 'warmup', 'load', 'filesize', 'probes', 'maxprobe', 'hashtime', 'stompbandwidth', 'resident', 'pathnodes']
     
     def __init__(self, testLauncher, name, seeds, *args, **kwargs):
         self.testLauncher = testLauncher
@@ -59,18 +134,213 @@ class Experiment:
         self.args = args
         self.kwargs = kwargs
 
+    @staticmethod
+    def medianAverage(values):
+        if len(values) >= 4:
+            values = sorted(values)[1:-1]
+        return sum(values) / len(values)
+
+    @classmethod
+    def bootstrapInterval(cls, values, rng):
+        """ Percentile bootstrap confidence interval of medianAverage(values), at CI_LEVEL. """
+        n = len(values)
+        estimates = sorted(cls.medianAverage([values[rng.randrange(n)] for i in xrange(n)]) for r in xrange(CI_RESAMPLES))
+        tail = (1 - CI_LEVEL) / 2
+        return estimates[int(tail * (CI_RESAMPLES - 1))], estimates[int((1 - tail) * (CI_RESAMPLES - 1) + 0.5)]
+
+    def widestInterval(self, groups, rng):
+        """ Largest width of any marker's confidence interval, relative to its value. """
+        widest = 0
+        for marker, units in groups.items():
+            estimate = self.medianAverage(units)
+            if estimate > 0:
+                lo, hi = self.bootstrapInterval(units, rng)
+                widest = max(widest, (hi - lo) / estimate)
+        return widest
+
     def run(self, results):
         allGroups = defaultdict(list)
-        for seed in xrange(self.seeds):
+        extraGroups = dict((key, defaultdict(list)) for key in self.EXTRA_SERIES)
+        cores = []
+        # A single seed means the experiment is deterministic, so there's nothing to estimate
+        adaptive = CI_TARGET > 0 and self.seeds > 1
+        minSeeds = max(self.seeds, CI_MIN_SEEDS) if adaptive else self.seeds
+        rng = random.Random(self.name)
+        start = time.time()
+        seed = 0
+        while True:
+            if seed >= minSeeds:
+                if not adaptive:
+                    break
+                width = self.widestInterval(allGroups, rng)
+                if width <= CI_TARGET or seed >= CI_MAX_SEEDS or time.time() - start >= CI_BUDGET:
+                    print('%s: %d seeds, widest interval %.1f%%' % (self.name, seed, width * 100))
+                    break
             print('Running %s #%d/%d...' % (self.name, seed + 1, self.seeds))
             r = self.testLauncher.run(seed, *self.args, **self.kwargs)
             for marker, units in r['results']:
                 allGroups[marker].append(units)
-        def medianAverage(values):
-            if len(values) >= 4:
-                values = sorted(values)[1:-1]
-            return sum(values) / len(values)
-        results[self.name] = [(marker, medianAverage(units)) for marker, units in sorted(allGroups.items())]
+            for key in self.EXTRA_SERIES:
+                for marker, units in r.get(key, []):
+                    extraGroups[key][marker].append(units)
+            if r['core'] is not None:
+                cores.append((seed, r['core']))
+            seed += 1
+        results[self.name] = [(marker, self.medianAverage(units)) for marker, units in sorted(allGroups.items())]
+        if adaptive:
+            results[self.name + '_CI'] = [(marker, self.bootstrapInterval(units, rng)) for marker, units in sorted(allGroups.items())]
+        for key, groups in extraGroups.items():
+            if groups:
+                results[self.name + '_' + key.upper()] = [(marker, self.medianAverage(units)) for marker, units in sorted(groups.items())]
+        if cores:
+            results[self.name + '_CORES'] = cores
+
+
+#---------------------------------------------------
+#  Core placement
+#---------------------------------------------------
+def parseCpuList(text):
+    """ Parses a list of CPUs in Linux's format, such as '2-9,12'. """
+    cpus = []
+    for part in text.strip().split(','):
+        if '-' in part:
+            lo, hi = part.split('-')
+            cpus.extend(range(int(lo), int(hi) + 1))
+        elif part:
+            cpus.append(int(part))
+    return cpus
+
+class SYSTEM_LOGICAL_PROCESSOR_INFORMATION(ctypes.Structure):
+    # The union after Relationship is 16 bytes, aligned like a ULONGLONG
+    _fields_ = [('ProcessorMask', ctypes.c_size_t), ('Relationship', ctypes.c_int), ('Union', ctypes.c_ulonglong * 2)]
+
+def windowsPhysicalCores():
+    """ The first logical processor of each physical core, from GetLogicalProcessorInformation. """
+    RelationProcessorCore = 0
+    getInfo = ctypes.windll.kernel32.GetLogicalProcessorInformation
+    length = ctypes.c_ulong(0)
+    getInfo(None, ctypes.byref(length))     # Fails, but sets the length needed
+    infos = (SYSTEM_LOGICAL_PROCESSOR_INFORMATION * (length.value // ctypes.sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION)))()
+    if not getInfo(infos, ctypes.byref(length)):
+        raise ctypes.WinError()
+    firstThreads = []
+    for info in infos:
+        if info.Relationship == RelationProcessorCore:
+            firstThreads.append((info.ProcessorMask & -info.ProcessorMask).bit_length() - 1)
+    return sorted(firstThreads)
+
+def isolatedCores():
+    """ Logical CPUs to run experiments on. On Linux, the CPUs isolated with isolcpus if there are any,
+    otherwise the first hardware thread of each physical core, so that no two experiments share a core.
+    On Windows, the first hardware thread of each physical core. Either way, CPU 0 is left to the OS
+    and this script. """
+    if os.name == 'nt':
+        cpus = windowsPhysicalCores()
+    else:
+        try:
+            cpus = parseCpuList(open('/sys/devices/system/cpu/isolated').read())
+            if not cpus:
+                firstThreads = set()
+                for path in glob.glob('/sys/devices/system/cpu/cpu[0-9]*/topology/thread_siblings_list'):
+                    firstThreads.add(parseCpuList(open(path).read())[0])
+                cpus = sorted(firstThreads)
+        except IOError:
+            cpus = range(multiprocessing.cpu_count())
+    return [cpu for cpu in cpus if cpu != 0]
+
+def numaNode(cpu):
+    """ NUMA node of a logical CPU, or None if it isn't known. """
+    nodes = glob.glob('/sys/devices/system/cpu/cpu%d/node[0-9]*' % cpu)
+    return int(nodes[0].rsplit('node', 1)[1]) if nodes else None
+
+def pinningPrefix(cpus):
+    """ Command line prefix which runs a program on a list of CPUs, with its memory on the first one's NUMA node. """
+    if os.name == 'nt':
+        # start /b /wait runs the program in this console, so its output is still captured
+        return ['cmd', '/c', 'start', '/b', '/wait', '/affinity', '%x' % sum(1 << cpu for cpu in cpus)]
+    cpuList = ','.join(str(cpu) for cpu in cpus)
+    node = numaNode(cpus[0])
+    if node is not None and any(os.path.exists(os.path.join(d, 'numactl')) for d in os.environ.get('PATH', '').split(os.pathsep)):
+        return ['numactl', '--physcpubind=%s' % cpuList, '--membind=%d' % node]
+    return ['taskset', '-c', cpuList]
+
+
+#---------------------------------------------------
+#  Scheduler
+#---------------------------------------------------
+class Scheduler:
+    """ Runs experiments in the order they were added. With no cores, it runs them one at a time, unpinned.
+    Otherwise, it first builds every configuration they need, each in its own folder, so that no compiler
+    competes with the timed runs. Then it runs the experiments that use a single core and leave the shared
+    cache alone, one per core on worker threads, pinning each run to its worker's core. Afterwards, it runs
+    the rest one at a time, each pinned to as many cores as it uses: multithreaded experiments, experiments
+    with a background stomper, and experiments that thrash the last-level cache. Each dataset's cores are
+    stored in a <name>_CORES dataset, as (seed, first core) pairs. """
+
+    def __init__(self, testLauncher, cores):
+        self.testLauncher = testLauncher
+        self.cores = cores
+        self.experiments = []
+        self.local = threading.local()
+
+    def add(self, experiment):
+        self.experiments.append(experiment)
+
+    def placement(self):
+        cores = self.local.cores
+        return cores[0], pinningPrefix(cores)
+
+    def run(self, results):
+        if not self.cores:
+            for experiment in self.experiments:
+                experiment.run(results)
+            return
+
+        launcher = self.testLauncher.launcher
+        launcher.cmakeBuilder.separateBuilds = True
+        for experiment in self.experiments:
+            print('Building %s...' % experiment.name)
+            self.testLauncher.prepare(**experiment.kwargs)
+        # From here on, the workers only run what's already built
+        launcher.cmakeBuilder.frozen = True
+        launcher.placement = self.placement
+
+        shared = []
+        exclusive = []
+        for experiment in self.experiments:
+            count, alone = self.testLauncher.requirements(**experiment.kwargs)
+            if alone:
+                exclusive.append((experiment, count))
+            else:
+                shared.append(experiment)
+
+        queue = deque(shared)
+        lock = threading.Lock()
+        errors = []
+        def worker(core):
+            self.local.cores = [core]
+            while not errors:
+                with lock:
+                    if not queue:
+                        return
+                    experiment = queue.popleft()
+                try:
+                    experiment.run(results)
+                except Exception as e:
+                    errors.append(e)
+        threads = [threading.Thread(target=worker, args=(core,)) for core in self.cores]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        if errors:
+            raise errors[0]
+
+        for experiment, count in exclusive:
+            if count > len(self.cores):
+                print('Warning: %s uses %d cores, but only %d are available' % (experiment.name, count, len(self.cores)))
+            self.local.cores = self.cores[:count]
+            experiment.run(results)
 
 
 #---------------------------------------------------
@@ -84,20 +354,96 @@ if __name__ == '__main__':
     filter = re.compile((sys.argv + ['.*'])[1])
     if '--nocache' in sys.argv[1:]:
         IGNORE_CACHE = True
+    runHuge = '--huge' in sys.argv[1:]
+    run64Bit = runHuge or '--64bit' in sys.argv[1:]
+    jobs = None
+    cores = None
+    for arg in sys.argv[1:]:
+        if arg.startswith('--ci='):
+            CI_TARGET = float(arg[5:])
+        elif arg.startswith('--budget='):
+            CI_BUDGET = float(arg[9:])
+        elif arg.startswith('--jobs='):
+            jobs = int(arg[7:])
+        elif arg.startswith('--cores='):
+            cores = parseCpuList(arg[8:])
     results = {}
 
     testLauncher = TestLauncher()
+    if cores is None and jobs is not None and jobs > 1:
+        cores = isolatedCores()
+        if len(cores) < jobs:
+            print('Only %d cores are free to run experiments on' % len(cores))
+    if cores and jobs:
+        cores = cores[:jobs]
+    scheduler = Scheduler(testLauncher, cores)
     maxKeys = 18000000
     granularity = 200
     
-    for container in ['TABLE', 'JUDY']:
+    for container in ['TABLE', 'JUDY', 'STD_UNORDERED_MAP', 'STD_MAP', 'DENSE_HASH']:
+        # Only Judy's memory usage depends on the seed; the other containers allocate the same way every time.
         experiment = Experiment(testLauncher,
             'MEMORY_%s' % container,
             8 if container == 'JUDY' else 1, 0, maxKeys, granularity, 0,
             CONTAINER=container,
             EXPERIMENT='MEMORY')
         if filter.match(experiment.name):
-            experiment.run(results)
+            scheduler.add(experiment)
+
+        if container == 'JUDY':
+            # Judy nodes allocated from slabs, which are in turn allocated from DLMalloc
+            experiment = Experiment(testLauncher,
+                'MEMORY_JUDY_SLAB',
+                8, 0, maxKeys, granularity, 0,
+                CONTAINER=container,
+                EXPERIMENT='MEMORY',
+                JUDY_SLAB_ALLOCATOR=1)
+            if filter.match(experiment.name):
+                scheduler.add(experiment)
+
+        # Full scans, in ns per entry visited; each marker repeats passes until 100000 entries are visited.
+        # DenseHashTable has no iterator, so test_iterate.h rejects it.
+        if container != 'DENSE_HASH':
+            experiment = Experiment(testLauncher,
+                'ITERATE_%s' % container,
+                8, 100000, maxKeys, granularity, 0,
+                CONTAINER=container,
+                EXPERIMENT='ITERATE')
+            if filter.match(experiment.name):
+                scheduler.add(experiment)
+
+        if container == 'TABLE':
+            # Time to map a snapshot and do the first lookup, and the lookups that follow (COLDSTART_TABLE_WARMUP).
+            # Coarser markers than usual, since the table is saved to disk at every marker.
+            experiment = Experiment(testLauncher,
+                'COLDSTART_TABLE',
+                3, 8000, maxKeys, 10, 0,
+                CONTAINER=container,
+                EXPERIMENT='COLDSTART')
+            if filter.match(experiment.name):
+                scheduler.add(experiment)
+
+        if container in ['TABLE', 'JUDY']:
+            # Save and load times per item (SERIALIZE_*_LOAD), and file sizes (SERIALIZE_*_FILESIZE).
+            # Coarser markers than usual, since the whole map is written to disk at every marker.
+            experiment = Experiment(testLauncher,
+                'SERIALIZE_%s' % container,
+                3, 0, maxKeys, 10, 0,
+                CONTAINER=container,
+                EXPERIMENT='SERIALIZE')
+            if filter.match(experiment.name):
+                scheduler.add(experiment)
+
+        if container == 'JUDY':
+            # Baseline for the JudyL cursor: JudyLNext descends from the root for every entry
+            experiment = Experiment(testLauncher,
+                'ITERATE_JUDY_NEXT',
+                8, 100000, maxKeys, granularity, 0,
+                CONTAINER=container,
+                EXPERIMENT='ITERATE',
+                JUDY_CURSOR=0)
+            if filter.match(experiment.name):
+                scheduler.add(experiment)
             
         for stomp in [0, 1000, 10000]:
             experiment = Experiment(testLauncher,
@@ -107,7 +453,7 @@ if __name__ == '__main__':
                 EXPERIMENT='INSERT',
                 CACHE_STOMPER_ENABLED=1 if stomp > 0 else 0)
             if filter.match(experiment.name):
-                experiment.run(results)
+                scheduler.add(experiment)
                 
             experiment = Experiment(testLauncher,
                 'LOOKUP_%d_%s' % (stomp, container),
@@ -116,7 +462,278 @@ if __name__ == '__main__':
                 EXPERIMENT='LOOKUP',
                 CACHE_STOMPER_ENABLED=1 if stomp > 0 else 0)
             if filter.match(experiment.name):
-                experiment.run(results)
+                scheduler.add(experiment)
+
+            if stomp == 0:
+                # Whole groups timed at once, so independent operations overlap; compare with the per-operation times above
+                for experimentName in ['INSERT', 'LOOKUP']:
+                    experiment = Experiment(testLauncher,
+                        '%s_0_%s_THROUGHPUT' % (experimentName, container),
+                        8, 8000, maxKeys, granularity, 0,
+                        CONTAINER=container,
+                        EXPERIMENT=experimentName,
+                        TIMING_MODE='THROUGHPUT')
+                    if filter.match(experiment.name):
+                        scheduler.add(experiment)
+
+            if container == 'JUDY':
+                # Judy insert times with the slab allocator, and with the platform malloc instead of DLMalloc
+                for suffix, allocDefs in [('SLAB', {'JUDY_SLAB_ALLOCATOR': 1}), ('MALLOC', {'USE_DLMALLOC': 0})]:
+                    experiment = Experiment(testLauncher,
+                        'INSERT_%d_JUDY_%s' % (stomp, suffix),
+                        8, 8000, maxKeys, granularity, stomp,
+                        CONTAINER=container,
+                        EXPERIMENT='INSERT',
+                        CACHE_STOMPER_ENABLED=1 if stomp > 0 else 0,
+                        **allocDefs)
+                    if filter.match(experiment.name):
+                        scheduler.add(experiment)
+
+                # Judy teardown freeing the array on worker threads; only the stomp-free run is needed
+                if stomp == 0:
+                    for method in ['ASYNC', 'PARALLEL']:
+                        experiment = Experiment(testLauncher,
+                            'INSERT_0_JUDY_%s_FREE' % method,
+                            8, 8000, maxKeys, granularity, 0,
+                            CONTAINER=container,
+                            EXPERIMENT='INSERT',
+                            JUDY_FREE_METHOD=method)
+                        if filter.match(experiment.name):
+                            scheduler.add(experiment)
+
+                # Baseline for the SIMD leaf search
+                experiment = Experiment(testLauncher,
+                    'LOOKUP_%d_JUDY_SCALAR' % stomp,
+                    8, 8000, maxKeys, granularity, stomp,
+                    CONTAINER=container,
+                    EXPERIMENT='LOOKUP',
+                    CACHE_STOMPER_ENABLED=1 if stomp > 0 else 0,
+                    JUDY_SIMD_SEARCH=0)
+                if filter.match(experiment.name):
+                    scheduler.add(experiment)
+
+            if container == 'TABLE':
+                # Cache-line-aligned buckets searched with SIMD, against the flat layout above
+                for experimentName in ['INSERT', 'LOOKUP']:
+                    experiment = Experiment(testLauncher,
+                        '%s_%d_TABLE_BUCKETED' % (experimentName, stomp),
+                        8, 8000, maxKeys, granularity, stomp,
+                        CONTAINER=container,
+                        EXPERIMENT=experimentName,
+                        CACHE_STOMPER_ENABLED=1 if stomp > 0 else 0,
+                        TABLE_BUCKETED=1)
+                    if filter.match(experiment.name):
+                        scheduler.add(experiment)
+
+            if container == 'TABLE' and stomp == 0:
+                # Cells examined per lookup, to explain the lookup times; the counters slow it down a little
+                experiment = Experiment(testLauncher,
+                    'LOOKUP_0_TABLE_STATS',
+                    3, 8000, maxKeys, granularity, 0,
+                    CONTAINER=container,
+                    EXPERIMENT='LOOKUP',
+                    TABLE_STATS=1)
+                if filter.match(experiment.name):
+                    scheduler.add(experiment)
             
+    # The benchmark's own overhead: the same loops with no container, so nothing but the timing, stomping
+    # and fetching of each key remains. Subtract these from the other datasets for the cost of the map alone.
+    for stomp in [0, 1000, 10000]:
+        for experimentName in ['INSERT', 'LOOKUP']:
+            experiment = Experiment(testLauncher,
+                '%s_%d_NONE' % (experimentName, stomp),
+                8, 8000, maxKeys, granularity, stomp,
+                CONTAINER='NONE',
+                EXPERIMENT=experimentName,
+                CACHE_STOMPER_ENABLED=1 if stomp > 0 else 0)
+            if filter.match(experiment.name):
+                scheduler.add(experiment)
+
+    # Hash table growing by less than 2x: less memory overshoot after each resize, in exchange for more resizes
+    for growth in [125, 150]:
+        for experimentName, seeds, operations in [('MEMORY', 1, 0), ('INSERT', 8, 8000), ('LOOKUP', 8, 8000)]:
+            experiment = Experiment(testLauncher,
+                '%s_%sTABLE_GROWTH_%d' % (experimentName, '' if experimentName == 'MEMORY' else '0_', growth),
+                seeds, operations, maxKeys, granularity, 0,
+                CONTAINER='TABLE',
+                EXPERIMENT=experimentName,
+                TABLE_GROWTH_PERCENT=growth)
+            if filter.match(experiment.name):
+                scheduler.add(experiment)
+
+    # A noisy neighbor sweeping memory on another core the whole time: 64 MB flat out, then 4 MB, which mostly fits in the LLC
+    for container in ['TABLE', 'JUDY']:
+        for experimentName in ['INSERT', 'LOOKUP']:
+            for suffix, workingSet in [('', 67108864), ('_4MB', 4194304)]:
+                experiment = Experiment(testLauncher,
+                    '%s_0_%s_NOISY%s' % (experimentName, container, suffix),
+                    8, 8000, maxKeys, granularity, 0,
+                    CONTAINER=container,
+                    EXPERIMENT=experimentName,
+                    BACKGROUND_STOMPER=1,
+                    BACKGROUND_STOMPER_BYTES=workingSet)
+                if filter.match(experiment.name):
+                    scheduler.add(experiment)
+
+    # Every lookup from a cold cache: after sweeping twice the LLC, or after flushing just the lookup's own lines.
+    # Each THRASH sweeps hundreds of MB, so those runs get far fewer operations.
+    for container in ['TABLE', 'JUDY']:
+        for method, seeds, operations in [('THRASH', 4, 200), ('FLUSH', 8, 2000)]:
+            experiment = Experiment(testLauncher,
+                'LOOKUP_0_%s_COLD_%s' % (container, method),
+                seeds, operations, maxKeys, granularity, 0,
+                CONTAINER=container,
+                EXPERIMENT='LOOKUP',
+                COLD_CACHE=method)
+            if filter.match(experiment.name):
+                scheduler.add(experiment)
+
+    # Stomping one line in each of 4096 pages between lookups evicts the TLB without much cache traffic.
+    # Adding it to FLUSH gives lookups with both the cache and the TLB cold, to compare with THRASH.
+    for container in ['TABLE', 'JUDY']:
+        for suffix, seeds, operations, coldDefs in [('', 8, 8000, {}), ('_COLD_FLUSH', 8, 2000, {'COLD_CACHE': 'FLUSH'})]:
+            experiment = Experiment(testLauncher,
+                'LOOKUP_4096_%s_PAGES%s' % (container, suffix),
+                seeds, operations, maxKeys, granularity, 4096,
+                CONTAINER=container,
+                EXPERIMENT='LOOKUP',
+                CACHE_STOMPER_ENABLED=1,
+                CACHE_STOMPER_PATTERN='PAGES',
+                **coldDefs)
+            if filter.match(experiment.name):
+                scheduler.add(experiment)
+
+    # Keys spread over 32 to 64 significant bits, so Judy has to decode more of each key on the way down.
+    # More than 32 bits needs a 64-bit build, so only the 32-bit baseline runs without --64bit.
+    for experimentName, seeds, operations in [('MEMORY', 1, 0), ('LOOKUP', 8, 8000)]:
+        for container, bitsList in [('JUDY', [32, 40, 48, 56, 64]), ('TABLE', [64])]:
+            for bits in bitsList:
+                if bits > 32 and not run64Bit:
+                    continue
+                experiment = Experiment(testLauncher,
+                    '%s_%s%s_BITS_%d' % (experimentName, '' if experimentName == 'MEMORY' else '0_', container, bits),
+                    seeds, operations, maxKeys, granularity, 0,
+                    CONTAINER=container,
+                    EXPERIMENT=experimentName,
+                    KEY_GENERATION='RANDOM_SEQUENCE_OF_UNIQUE_64',
+                    KEY_BITS=bits)
+                if filter.match(experiment.name):
+                    scheduler.add(experiment)
+
+    # Dense, Zipf-sized ranges of 32-bit IDs: Judy packs these into compressed leaves, until the stride
+    # between IDs or the number of clusters spreads them out. The hash table shouldn't care either way.
+    for clusters, stride in [(1000, 1), (1000, 16), (1000, 256), (10, 1), (100000, 1)]:
+        for experimentName, seeds, operations in [('MEMORY', 1, 0), ('LOOKUP', 8, 8000)]:
+            for container in ['JUDY', 'TABLE']:
+                experiment = Experiment(testLauncher,
+                    '%s_%s%s_CLUSTERED_%d_%d' % (experimentName, '' if experimentName == 'MEMORY' else '0_', container, clusters, stride),
+                    seeds, operations, maxKeys, granularity, 0,
+                    CONTAINER=container,
+                    EXPERIMENT=experimentName,
+                    KEY_GENERATION='CLUSTERED',
+                    KEY_BITS=32,
+                    KEY_CLUSTER_COUNT=clusters,
+                    KEY_CLUSTER_STRIDE=stride)
+                if filter.match(experiment.name):
+                    scheduler.add(experiment)
+
+    # Up to 4 billion keys, computed from their position instead of stored, and timing only the first
+    # operationsPerGroup inserts of each group so that a run doesn't take days. Needs a 64-bit GENERATOR.
+    if runHuge:
+        hugeKeys = 4000000000
+        for experimentName, seeds, operations in [('MEMORY', 1, 0), ('INSERT', 2, 100000), ('LOOKUP', 2, 100000)]:
+            for container in ['TABLE', 'JUDY']:
+                experiment = Experiment(testLauncher,
+                    '%s_%s%s_HUGE' % (experimentName, '' if experimentName == 'MEMORY' else '0_', container),
+                    seeds, operations, hugeKeys, 20, 0,
+                    CONTAINER=container,
+                    EXPERIMENT=experimentName,
+                    KEY_GENERATION='RANDOM_SEQUENCE_OF_UNIQUE_64',
+                    KEY_BITS=64,
+                    LAZY_KEYS=1,
+                    SAMPLED_MARKERS=1)
+                if filter.match(experiment.name):
+                    scheduler.add(experiment)
+
+    # Cuckoo hashing fills to about 97% before growing; compare it to the linear probing table held at 90% load
+    for experimentName, seeds, operations in [('MEMORY', 1, 0), ('INSERT', 8, 8000), ('LOOKUP', 8, 8000), ('ITERATE', 8, 100000)]:
+        prefix = '' if experimentName in ('MEMORY', 'ITERATE') else '0_'
+        experiment = Experiment(testLauncher,
+            '%s_%sCUCKOO_TABLE' % (experimentName, prefix),
+            seeds, operations, maxKeys, granularity, 0,
+            CONTAINER='CUCKOO_TABLE',
+            EXPERIMENT=experimentName)
+        if filter.match(experiment.name):
+            scheduler.add(experiment)
+
+        if experimentName != 'INSERT':
+            experiment = Experiment(testLauncher,
+                '%s_%sTABLE_LOAD_90' % (experimentName, prefix),
+                seeds, operations, maxKeys, granularity, 0,
+                CONTAINER='TABLE',
+                EXPERIMENT=experimentName,
+                TABLE_MAX_LOAD_PERCENT=90)
+            if filter.match(experiment.name):
+                scheduler.add(experiment)
+
+    # Each HashTable hash function on each kind of key: lookup time, probe lengths and hashing time.
+    # IDENTITY only spreads keys which are already random; on the others, its probes grow with the table.
+    for keyGeneration in ['LINEAR', 'SORTED_ADDRESSES', 'SHUFFLED_ADDRESSES', 'RANDOM_SEQUENCE_OF_UNIQUE']:
+        for tableHash in ['MURMUR', 'FIBONACCI', 'CRC32C', 'XXH3', 'IDENTITY']:
+            if tableHash == 'IDENTITY' and keyGeneration != 'RANDOM_SEQUENCE_OF_UNIQUE':
+                continue
+            experiment = Experiment(testLauncher,
+                'HASH_QUALITY_%s_%s' % (tableHash, keyGeneration),
+                3, 8000, maxKeys, granularity, 0,
+                CONTAINER='TABLE',
+                EXPERIMENT='HASH_QUALITY',
+                TABLE_STATS=1,
+                TABLE_HASH=tableHash,
+                KEY_GENERATION=keyGeneration)
+            if filter.match(experiment.name):
+                scheduler.add(experiment)
+
+    # INTEGER_MAP_THREADS threads incrementing entries of one shared map, in wall-clock ns per operation
+    for container in ['SHARDED_TABLE', 'LOCKED_TABLE', 'LOCKFREE_TABLE']:
+        experiment = Experiment(testLauncher,
+            'CONCURRENT_%s' % container,
+            8, 80000, maxKeys, granularity, 0,
+            CONTAINER=container,
+            EXPERIMENT='CONCURRENT')
+        if filter.match(experiment.name):
+            scheduler.add(experiment)
+
+        # A single-threaded scan of the same map; LOCKFREE_TABLE's array is sized for maxKeys from the start
+        experiment = Experiment(testLauncher,
+            'ITERATE_%s' % container,
+            8, 100000, maxKeys, granularity, 0,
+            CONTAINER=container,
+            EXPERIMENT='ITERATE')
+        if filter.match(experiment.name):
+            scheduler.add(experiment)
+
+    # Counting 1000000 random keys with thread-local tables and a partitioned merge, in wall-clock ns per key
+    for threads in [1, 2, 4, 8]:
+        experiment = Experiment(testLauncher,
+            'AGGREGATE_%dT' % threads,
+            3, 1000000, maxKeys, 10, 0,
+            CONTAINER='TABLE',
+            EXPERIMENT='AGGREGATE',
+            THREADS=threads)
+        if filter.match(experiment.name):
+            scheduler.add(experiment)
+
+    # Counting 1000000 random keys in one HashTable vs. through cache-sized partitions, in ns per key
+    for name, partitioned in [('DIRECT', 0), ('PARTITIONED', 1)]:
+        experiment = Experiment(testLauncher,
+            'RADIX_%s' % name,
+            3, 1000000, maxKeys, 10, 0,
+            CONTAINER='TABLE',
+            EXPERIMENT='RADIX',
+            RADIX_PARTITIONED=partitioned)
+        if filter.match(experiment.name):
+            scheduler.add(experiment)
+
+    scheduler.run(results)
     pprint(results, open('results.txt', 'w'))
     print('Elapsed time: %s' % (datetime.now() - start))
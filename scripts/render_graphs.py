@@ -16,6 +16,10 @@ import cairo
 # Smoothing looks good but runs slowly in Python, so you can disable it by specifying --nosmooth
 SMOOTHING_ENABLED = True
 
+# Datasets gathered adaptively have a confidence interval, <name>_CI, drawn as a faint band around the
+# curve. Specify --nobands to leave them out.
+BANDS_ENABLED = True
+
 
 #---------------------------------------------------
 #  Cairo drawing helpers
@@ -138,17 +142,24 @@ class Graph:
         if resultName not in results:
             print('*** %s is missing' % resultName)
             return
-        points = results[resultName]
-        if 'MEMORY' in resultName:
-            points = [(x, y / x) for x, y in points]
+        perItem = 'MEMORY' in resultName or resultName.endswith('_FILESIZE')
         xattribs = self.xattribs
         yattribs = self.yattribs
-        points = [(xattribs.toAxis(x), yattribs.toAxis(y)) for x, y in points]
-        if self.smoothing and SMOOTHING_ENABLED:
-            points = list(smoothPoints(floatrange(xattribs.min, xattribs.max, .01), points, k=.0005))
+        def toCurve(points):
+            if perItem:
+                points = [(x, y / x) for x, y in points]
+            points = [(xattribs.toAxis(x), yattribs.toAxis(y)) for x, y in points]
+            if self.smoothing and SMOOTHING_ENABLED:
+                points = list(smoothPoints(floatrange(xattribs.min, xattribs.max, .01), points, k=.0005))
+            return points
+        points = toCurve(results[resultName])
+        band = None
+        if BANDS_ENABLED and resultName + '_CI' in results:
+            intervals = results[resultName + '_CI']
+            band = (toCurve([(x, lo) for x, (lo, hi) in intervals]), toCurve([(x, hi) for x, (lo, hi) in intervals]))
         if not width:
             width = 1.2 if self.small else 2.5
-        self.curves.append((label, color, points, width, labelNudge))
+        self.curves.append((label, color, points, width, labelNudge, band))
 
     def render(self):
         xattribs = self.xattribs
@@ -205,13 +216,23 @@ class Graph:
                 fillAlignedText(cr, -4, -pos + 4, labelFont, label, 1)
 
         # Draw curves
-        for label, color, points, width, labelNudge in self.curves:
+        for label, color, points, width, labelNudge, band in self.curves:
             with Saved(cr):
                 cr.set_line_width(width)
                 cr.set_source_rgba(*color)
                 with Saved(cr):
                     cr.rectangle(0, 5, xattribs.size, -yattribs.size - 15)
                     cr.clip()
+                    if band:
+                        # Lower edge left to right, then upper edge back
+                        lower, upper = band
+                        cr.set_source_rgba(color[0], color[1], color[2], (color[3] if len(color) > 3 else 1) * .25)
+                        cr.move_to(xattribs.mapAxisValue(lower[0][0]), -yattribs.mapAxisValue(lower[0][1]))
+                        for x, y in lower[1:] + upper[::-1]:
+                            cr.line_to(xattribs.mapAxisValue(x), -yattribs.mapAxisValue(y))
+                        cr.close_path()
+                        cr.fill()
+                        cr.set_source_rgba(*color)
                     cr.move_to(xattribs.mapAxisValue(points[0][0]), -yattribs.mapAxisValue(points[0][1]))
                     for x, y in points[1:]:
                         cr.line_to(xattribs.mapAxisValue(x) + 0.5, -yattribs.mapAxisValue(y) - 0.5)
@@ -252,6 +273,8 @@ if __name__ == '__main__':
     filter = re.compile((sys.argv + ['.*'])[1])
     if '--nosmooth' in sys.argv[1:]:
         SMOOTHING_ENABLED = False
+    if '--nobands' in sys.argv[1:]:
+        BANDS_ENABLED = False
     results = eval(open('results.txt', 'r').read())
 
     graph = Graph('lookup.png', 'Lookup Time')
@@ -259,13 +282,160 @@ if __name__ == '__main__':
         print('Rendering %s...' % graph.filename)
         graph.addSmoothCurve('Hash Table', (1, .4, .4), results, 'LOOKUP_0_TABLE')
         graph.addSmoothCurve('Judy Array', (.4, .4, .9), results, 'LOOKUP_0_JUDY')
+        graph.addSmoothCurve('Judy (scalar)', (.4, .4, .9, .4), results, 'LOOKUP_0_JUDY_SCALAR', width=1.2)
+        graph.addSmoothCurve('unordered_map', (.3, .7, .3), results, 'LOOKUP_0_STD_UNORDERED_MAP')
+        graph.addSmoothCurve('std::map', (.8, .6, .2), results, 'LOOKUP_0_STD_MAP')
+        graph.addSmoothCurve('Dense Hash', (.6, .3, .7), results, 'LOOKUP_0_DENSE_HASH')
+        graph.addSmoothCurve('No container', (.6, .6, .6), results, 'LOOKUP_0_NONE', width=1.2)
+        graph.render()
+
+    for experimentName, suffix in [('LOOKUP', 'lookup'), ('INSERT', 'insert')]:
+        graph = Graph('%s-throughput.png' % suffix, '%s Time, Overlapped' % experimentName.capitalize())
+        if filter.match(graph.filename):
+            print('Rendering %s...' % graph.filename)
+            graph.addSmoothCurve('Hash Table', (1, .4, .4), results, '%s_0_TABLE_THROUGHPUT' % experimentName)
+            graph.addSmoothCurve('Judy Array', (.4, .4, .9), results, '%s_0_JUDY_THROUGHPUT' % experimentName)
+            graph.addSmoothCurve('unordered_map', (.3, .7, .3), results, '%s_0_STD_UNORDERED_MAP_THROUGHPUT' % experimentName)
+            graph.addSmoothCurve('std::map', (.8, .6, .2), results, '%s_0_STD_MAP_THROUGHPUT' % experimentName)
+            graph.addSmoothCurve('Dense Hash', (.6, .3, .7), results, '%s_0_DENSE_HASH_THROUGHPUT' % experimentName)
+            graph.render()
+
+    graph = Graph('lookup-probes.png', 'Cells Per Lookup')
+    if filter.match(graph.filename):
+        print('Rendering %s...' % graph.filename)
+        graph.yattribs = AxisAttribs(150, 0, 4, 1, False)
+        graph.addSmoothCurve('Hash Table', (1, .4, .4), results, 'LOOKUP_0_TABLE_STATS_PROBES')
+        graph.render()
+
+    graph = Graph('table-growth.png', 'Time Per Operation')
+    if filter.match(graph.filename):
+        print('Rendering %s...' % graph.filename)
+        graph.addSmoothCurve('Insert, grow 2x', (1, .4, .4), results, 'INSERT_0_TABLE')
+        graph.addSmoothCurve('Insert, grow 1.5x', (.8, .6, .2), results, 'INSERT_0_TABLE_GROWTH_150')
+        graph.addSmoothCurve('Insert, grow 1.25x', (.4, .4, .9), results, 'INSERT_0_TABLE_GROWTH_125')
+        graph.addSmoothCurve('Lookup, grow 2x', (1, .4, .4, .4), results, 'LOOKUP_0_TABLE', width=1.2)
+        graph.addSmoothCurve('Lookup, grow 1.5x', (.8, .6, .2, .4), results, 'LOOKUP_0_TABLE_GROWTH_150', width=1.2)
+        graph.addSmoothCurve('Lookup, grow 1.25x', (.4, .4, .9, .4), results, 'LOOKUP_0_TABLE_GROWTH_125', width=1.2)
+        graph.render()
+
+    graph = Graph('cuckoo.png', 'Time Per Operation')
+    if filter.match(graph.filename):
+        print('Rendering %s...' % graph.filename)
+        graph.addSmoothCurve('Lookup, table', (1, .4, .4), results, 'LOOKUP_0_TABLE')
+        graph.addSmoothCurve('Lookup, table 90%', (.8, .6, .2), results, 'LOOKUP_0_TABLE_LOAD_90')
+        graph.addSmoothCurve('Lookup, cuckoo', (.4, .4, .9), results, 'LOOKUP_0_CUCKOO_TABLE')
+        graph.addSmoothCurve('Insert, table', (1, .4, .4, .4), results, 'INSERT_0_TABLE', width=1.2)
+        graph.addSmoothCurve('Insert, cuckoo', (.4, .4, .9, .4), results, 'INSERT_0_CUCKOO_TABLE', width=1.2)
         graph.render()
 
+    hashCurves = [('Murmur', (1, .4, .4), 'MURMUR'),
+                  ('Fibonacci', (.8, .6, .2), 'FIBONACCI'),
+                  ('CRC32C', (.3, .7, .3), 'CRC32C'),
+                  ('XXH3', (.4, .4, .9), 'XXH3'),
+                  ('Identity', (.6, .3, .7), 'IDENTITY')]
+    for keyGeneration, suffix in [('SORTED_ADDRESSES', 'sorted-addresses'), ('RANDOM_SEQUENCE_OF_UNIQUE', 'random')]:
+        graph = Graph('hash-quality-%s.png' % suffix, 'Lookup Time')
+        if filter.match(graph.filename):
+            print('Rendering %s...' % graph.filename)
+            for label, color, tableHash in hashCurves:
+                graph.addSmoothCurve(label, color, results, 'HASH_QUALITY_%s_%s' % (tableHash, keyGeneration))
+            graph.render()
+
+        graph = Graph('hash-quality-%s-probes.png' % suffix, 'Cells Per Lookup')
+        if filter.match(graph.filename):
+            print('Rendering %s...' % graph.filename)
+            graph.yattribs = AxisAttribs(150, 0, 4, 1, False)
+            for label, color, tableHash in hashCurves:
+                graph.addSmoothCurve(label, color, results, 'HASH_QUALITY_%s_%s_PROBES' % (tableHash, keyGeneration))
+            graph.render()
+
     graph = Graph('insert.png', 'Insert Time')
     if filter.match(graph.filename):
         print('Rendering %s...' % graph.filename)
         graph.addSmoothCurve('Hash Table', (1, .4, .4), results, 'INSERT_0_TABLE')
         graph.addSmoothCurve('Judy Array', (.4, .4, .9), results, 'INSERT_0_JUDY')
+        graph.addSmoothCurve('unordered_map', (.3, .7, .3), results, 'INSERT_0_STD_UNORDERED_MAP')
+        graph.addSmoothCurve('std::map', (.8, .6, .2), results, 'INSERT_0_STD_MAP')
+        graph.addSmoothCurve('Dense Hash', (.6, .3, .7), results, 'INSERT_0_DENSE_HASH')
+        graph.addSmoothCurve('No container', (.6, .6, .6), results, 'INSERT_0_NONE', width=1.2)
+        graph.render()
+
+    graph = Graph('insert-judy-allocator.png', 'Insert Time')
+    if filter.match(graph.filename):
+        print('Rendering %s...' % graph.filename)
+        graph.addSmoothCurve('DLMalloc', (.4, .4, .9), results, 'INSERT_0_JUDY')
+        graph.addSmoothCurve('Slab', (.2, .6, .6), results, 'INSERT_0_JUDY_SLAB')
+        graph.addSmoothCurve('malloc', (.6, .6, .6), results, 'INSERT_0_JUDY_MALLOC')
+        graph.render()
+
+    graph = Graph('iterate.png', 'Time Per Item Visited')
+    if filter.match(graph.filename):
+        print('Rendering %s...' % graph.filename)
+        graph.addSmoothCurve('Hash Table', (1, .4, .4), results, 'ITERATE_TABLE')
+        graph.addSmoothCurve('Judy (cursor)', (.4, .4, .9), results, 'ITERATE_JUDY')
+        graph.addSmoothCurve('Judy (JudyLNext)', (.4, .4, .9, .4), results, 'ITERATE_JUDY_NEXT', width=1.2)
+        graph.addSmoothCurve('unordered_map', (.3, .7, .3), results, 'ITERATE_STD_UNORDERED_MAP')
+        graph.addSmoothCurve('std::map', (.8, .6, .2), results, 'ITERATE_STD_MAP')
+        graph.render()
+
+    graph = Graph('teardown.png', 'Teardown Time Per Item')
+    if filter.match(graph.filename):
+        print('Rendering %s...' % graph.filename)
+        graph.addSmoothCurve('Hash Table', (1, .4, .4), results, 'INSERT_0_TABLE_TEARDOWN')
+        graph.addSmoothCurve('Judy Array', (.4, .4, .9), results, 'INSERT_0_JUDY_TEARDOWN')
+        graph.addSmoothCurve('Judy (parallel)', (.2, .6, .6), results, 'INSERT_0_JUDY_PARALLEL_FREE_TEARDOWN')
+        graph.addSmoothCurve('Judy (async)', (.6, .6, .6), results, 'INSERT_0_JUDY_ASYNC_FREE_TEARDOWN')
+        graph.render()
+
+    graph = Graph('serialize.png', 'Save/Load Time Per Item')
+    if filter.match(graph.filename):
+        print('Rendering %s...' % graph.filename)
+        graph.addSmoothCurve('Hash Table save', (1, .4, .4), results, 'SERIALIZE_TABLE')
+        graph.addSmoothCurve('Hash Table map', (1, .4, .4, .4), results, 'SERIALIZE_TABLE_LOAD', width=1.2)
+        graph.addSmoothCurve('Judy save', (.4, .4, .9), results, 'SERIALIZE_JUDY')
+        graph.addSmoothCurve('Judy load', (.4, .4, .9, .4), results, 'SERIALIZE_JUDY_LOAD', width=1.2)
+        graph.render()
+
+    graph = Graph('serialize-size.png', 'File Bytes Per Item')
+    if filter.match(graph.filename):
+        print('Rendering %s...' % graph.filename)
+        graph.yattribs = AxisAttribs(150, 0, 60, 10, False)
+        graph.smoothing = False
+        graph.addSmoothCurve('Hash Table', (1, .4, .4), results, 'SERIALIZE_TABLE_FILESIZE')
+        graph.addSmoothCurve('Judy Array', (.4, .4, .9), results, 'SERIALIZE_JUDY_FILESIZE')
+        graph.render()
+
+    graph = Graph('concurrent.png', 'Time Per Increment, 4 Threads')
+    if filter.match(graph.filename):
+        print('Rendering %s...' % graph.filename)
+        graph.yattribs = AxisAttribs(150, 0, 200, 50, False, lambda x: '%d ns' % int(x + 0.5))
+        graph.addSmoothCurve('1 thread, no lock', (1, .4, .4), results, 'LOOKUP_0_TABLE')
+        graph.addSmoothCurve('Sharded', (.2, .6, .6), results, 'CONCURRENT_SHARDED_TABLE')
+        graph.addSmoothCurve('Single lock', (.6, .6, .6), results, 'CONCURRENT_LOCKED_TABLE')
+        graph.addSmoothCurve('Lock-free', (.8, .6, .2), results, 'CONCURRENT_LOCKFREE_TABLE')
+        graph.render()
+
+    graph = Graph('aggregate.png', 'Aggregation Time Per Key')
+    if filter.match(graph.filename):
+        print('Rendering %s...' % graph.filename)
+        graph.addSmoothCurve('1 thread', (1, .4, .4), results, 'AGGREGATE_1T')
+        graph.addSmoothCurve('2 threads', (.8, .6, .2), results, 'AGGREGATE_2T')
+        graph.addSmoothCurve('4 threads', (.2, .6, .6), results, 'AGGREGATE_4T')
+        graph.addSmoothCurve('8 threads', (.4, .4, .9), results, 'AGGREGATE_8T')
+        graph.render()
+
+    graph = Graph('radix.png', 'Counting Time Per Key')
+    if filter.match(graph.filename):
+        print('Rendering %s...' % graph.filename)
+        graph.addSmoothCurve('Direct', (1, .4, .4), results, 'RADIX_DIRECT')
+        graph.addSmoothCurve('Partitioned', (.4, .4, .9), results, 'RADIX_PARTITIONED')
+        graph.render()
+
+    graph = Graph('coldstart.png', 'Lookup Time After Mapping')
+    if filter.match(graph.filename):
+        print('Rendering %s...' % graph.filename)
+        graph.addSmoothCurve('Warm table', (1, .4, .4), results, 'LOOKUP_0_TABLE')
+        graph.addSmoothCurve('Mapped snapshot', (.6, .6, .6), results, 'COLDSTART_TABLE_WARMUP')
         graph.render()
 
     graph = Graph('lookup-cache-stomp.png', 'Lookup Times')
@@ -280,8 +450,118 @@ if __name__ == '__main__':
         #graph.addSmoothCurve('', (.4, .4, .9, .5), results, 'LOOKUP_0_JUDY', width=0.35)
         graph.addSmoothCurve('', (.4, .4, .9, .6), results, 'LOOKUP_1000_JUDY')
         graph.addSmoothCurve('', (.4, .4, .9), results, 'LOOKUP_10000_JUDY', width=1.8)
+        graph.addSmoothCurve('', (.3, .7, .3, .6), results, 'LOOKUP_1000_STD_UNORDERED_MAP')
+        graph.addSmoothCurve('', (.3, .7, .3), results, 'LOOKUP_10000_STD_UNORDERED_MAP', width=1.8)
+        graph.addSmoothCurve('', (.8, .6, .2, .6), results, 'LOOKUP_1000_STD_MAP')
+        graph.addSmoothCurve('', (.8, .6, .2), results, 'LOOKUP_10000_STD_MAP', width=1.8)
+        graph.addSmoothCurve('', (.6, .3, .7, .6), results, 'LOOKUP_1000_DENSE_HASH')
+        graph.addSmoothCurve('', (.6, .3, .7), results, 'LOOKUP_10000_DENSE_HASH', width=1.8)
+        graph.render()
+
+    for experimentName, suffix in [('LOOKUP', 'lookup'), ('INSERT', 'insert')]:
+        graph = Graph('table-bucketed-%s.png' % suffix, '%s Time' % experimentName.capitalize())
+        if filter.match(graph.filename):
+            print('Rendering %s...' % graph.filename)
+            graph.addSmoothCurve('Flat', (1, .4, .4, .4), results, '%s_0_TABLE' % experimentName, width=1.2)
+            graph.addSmoothCurve('', (1, .4, .4, .6), results, '%s_1000_TABLE' % experimentName)
+            graph.addSmoothCurve('', (1, .4, .4), results, '%s_10000_TABLE' % experimentName, width=1.8)
+            graph.addSmoothCurve('Bucketed', (.4, .4, .9, .4), results, '%s_0_TABLE_BUCKETED' % experimentName, width=1.2)
+            graph.addSmoothCurve('', (.4, .4, .9, .6), results, '%s_1000_TABLE_BUCKETED' % experimentName)
+            graph.addSmoothCurve('', (.4, .4, .9), results, '%s_10000_TABLE_BUCKETED' % experimentName, width=1.8)
+            graph.render()
+
+    for experimentName, suffix in [('LOOKUP', 'lookup'), ('INSERT', 'insert')]:
+        graph = Graph('%s-noisy-neighbor.png' % suffix, '%s Time' % experimentName.capitalize())
+        if filter.match(graph.filename):
+            print('Rendering %s...' % graph.filename)
+            graph.addSmoothCurve('Hash Table', (1, .4, .4, .4), results, '%s_0_TABLE' % experimentName, width=1.2)
+            graph.addSmoothCurve('', (1, .4, .4, .6), results, '%s_0_TABLE_NOISY_4MB' % experimentName)
+            graph.addSmoothCurve('', (1, .4, .4), results, '%s_0_TABLE_NOISY' % experimentName, width=1.8)
+            graph.addSmoothCurve('Judy Array', (.4, .4, .9, .4), results, '%s_0_JUDY' % experimentName, width=1.2)
+            graph.addSmoothCurve('', (.4, .4, .9, .6), results, '%s_0_JUDY_NOISY_4MB' % experimentName)
+            graph.addSmoothCurve('', (.4, .4, .9), results, '%s_0_JUDY_NOISY' % experimentName, width=1.8)
+            graph.render()
+
+    graph = Graph('lookup-cold.png', 'Lookup Time')
+    if filter.match(graph.filename):
+        print('Rendering %s...' % graph.filename)
+        graph.yattribs = AxisAttribs(150, 0, 1000, 200, False, lambda x: '%d ns' % int(x + 0.5))
+        graph.addSmoothCurve('Hash Table', (1, .4, .4, .4), results, 'LOOKUP_0_TABLE', width=1.2)
+        graph.addSmoothCurve('', (1, .4, .4, .6), results, 'LOOKUP_0_TABLE_COLD_FLUSH')
+        graph.addSmoothCurve('', (1, .4, .4), results, 'LOOKUP_0_TABLE_COLD_THRASH', width=1.8)
+        graph.addSmoothCurve('Judy Array', (.4, .4, .9, .4), results, 'LOOKUP_0_JUDY', width=1.2)
+        graph.addSmoothCurve('', (.4, .4, .9, .6), results, 'LOOKUP_0_JUDY_COLD_FLUSH')
+        graph.addSmoothCurve('', (.4, .4, .9), results, 'LOOKUP_0_JUDY_COLD_THRASH', width=1.8)
+        graph.render()
+
+    graph = Graph('lookup-cold-resident.png', 'Nodes Per Lookup')
+    if filter.match(graph.filename):
+        print('Rendering %s...' % graph.filename)
+        graph.yattribs = AxisAttribs(150, 0, 8, 2, False)
+        graph.addSmoothCurve('Judy path', (.4, .4, .9, .4), results, 'LOOKUP_0_JUDY_COLD_THRASH_PATHNODES', width=1.2)
+        graph.addSmoothCurve('Judy resident', (.4, .4, .9), results, 'LOOKUP_0_JUDY_COLD_THRASH_RESIDENT')
+        graph.addSmoothCurve('Hash Table resident', (1, .4, .4), results, 'LOOKUP_0_TABLE_COLD_THRASH_RESIDENT')
+        graph.render()
+
+    for container, suffix, label in [('TABLE', 'table', 'Hash Table'), ('JUDY', 'judy', 'Judy Array')]:
+        graph = Graph('lookup-tlb-%s.png' % suffix, '%s Lookup Time' % label)
+        if filter.match(graph.filename):
+            print('Rendering %s...' % graph.filename)
+            graph.yattribs = AxisAttribs(150, 0, 1000, 200, False, lambda x: '%d ns' % int(x + 0.5))
+            graph.addSmoothCurve('Warm', (.6, .6, .6), results, 'LOOKUP_0_%s' % container)
+            graph.addSmoothCurve('TLB cold', (.8, .6, .2), results, 'LOOKUP_4096_%s_PAGES' % container)
+            graph.addSmoothCurve('Cache cold', (.2, .6, .6), results, 'LOOKUP_0_%s_COLD_FLUSH' % container)
+            graph.addSmoothCurve('Both cold', (.4, .4, .9), results, 'LOOKUP_4096_%s_PAGES_COLD_FLUSH' % container)
+            graph.addSmoothCurve('Thrashed', (1, .4, .4), results, 'LOOKUP_0_%s_COLD_THRASH' % container)
+            graph.render()
+
+    graph = Graph('lookup-key-bits.png', 'Lookup Time')
+    if filter.match(graph.filename):
+        print('Rendering %s...' % graph.filename)
+        graph.addSmoothCurve('Hash Table', (1, .4, .4), results, 'LOOKUP_0_TABLE_BITS_64')
+        graph.addSmoothCurve('Judy, 32 bits', (.4, .4, .9, .4), results, 'LOOKUP_0_JUDY_BITS_32', width=1.2)
+        graph.addSmoothCurve('', (.4, .4, .9, .6), results, 'LOOKUP_0_JUDY_BITS_48')
+        graph.addSmoothCurve('Judy, 64 bits', (.4, .4, .9), results, 'LOOKUP_0_JUDY_BITS_64', width=1.8)
         graph.render()
 
+    graph = Graph('memory-key-bits.png', 'Total Bytes Per Item')
+    if filter.match(graph.filename):
+        print('Rendering %s...' % graph.filename)
+        graph.yattribs = AxisAttribs(150, 0, 60, 10, False)
+        graph.smoothing = False
+        graph.addSmoothCurve('Hash Table', (1, .4, .4), results, 'MEMORY_TABLE_BITS_64')
+        graph.addSmoothCurve('Judy, 32 bits', (.4, .4, .9, .4), results, 'MEMORY_JUDY_BITS_32', width=1.2)
+        graph.addSmoothCurve('', (.4, .4, .9, .6), results, 'MEMORY_JUDY_BITS_48')
+        graph.addSmoothCurve('Judy, 64 bits', (.4, .4, .9), results, 'MEMORY_JUDY_BITS_64', width=1.8)
+        graph.render()
+
+    for experimentName, prefix, suffix, title in [('LOOKUP', 'LOOKUP_0_', 'lookup', 'Lookup Time'), ('MEMORY', 'MEMORY_', 'memory', 'Total Bytes Per Item')]:
+        graph = Graph('%s-clustered.png' % suffix, title)
+        if filter.match(graph.filename):
+            print('Rendering %s...' % graph.filename)
+            if experimentName == 'MEMORY':
+                graph.yattribs = AxisAttribs(150, 0, 60, 10, False)
+                graph.smoothing = False
+            graph.addSmoothCurve('Hash Table', (1, .4, .4), results, '%sTABLE_CLUSTERED_1000_1' % prefix)
+            graph.addSmoothCurve('Judy, stride 1', (.4, .4, .9, .4), results, '%sJUDY_CLUSTERED_1000_1' % prefix, width=1.2)
+            graph.addSmoothCurve('Judy, stride 16', (.4, .4, .9, .6), results, '%sJUDY_CLUSTERED_1000_16' % prefix)
+            graph.addSmoothCurve('Judy, stride 256', (.4, .4, .9), results, '%sJUDY_CLUSTERED_1000_256' % prefix, width=1.8)
+            graph.addSmoothCurve('Judy, 10 clusters', (.2, .6, .6), results, '%sJUDY_CLUSTERED_10_1' % prefix)
+            graph.addSmoothCurve('Judy, 100000 clusters', (.8, .6, .2), results, '%sJUDY_CLUSTERED_100000_1' % prefix)
+            graph.render()
+
+    for experimentName, prefix, suffix, title in [('INSERT', 'INSERT_0_', 'insert', 'Insert Time'), ('LOOKUP', 'LOOKUP_0_', 'lookup', 'Lookup Time'), ('MEMORY', 'MEMORY_', 'memory', 'Total Bytes Per Item')]:
+        graph = Graph('%s-huge.png' % suffix, title)
+        if filter.match(graph.filename):
+            print('Rendering %s...' % graph.filename)
+            graph.xattribs = AxisAttribs(400, 55, 4000000000, 10, True)
+            if experimentName == 'MEMORY':
+                graph.yattribs = AxisAttribs(150, 0, 60, 10, False)
+                graph.smoothing = False
+            graph.addSmoothCurve('Hash Table', (1, .4, .4), results, '%sTABLE_HUGE' % prefix)
+            graph.addSmoothCurve('Judy', (.4, .4, .9), results, '%sJUDY_HUGE' % prefix)
+            graph.render()
+
     graph = Graph('insert-cache-stomp.png', 'Insert Times')
     if filter.match(graph.filename):
         print('Rendering %s...' % graph.filename)
@@ -294,16 +574,46 @@ if __name__ == '__main__':
         #graph.addSmoothCurve('', (.4, .4, .9, .5), results, 'INSERT_0_JUDY', width=0.5)
         graph.addSmoothCurve('', (.4, .4, .9, .6), results, 'INSERT_1000_JUDY')
         graph.addSmoothCurve('', (.4, .4, .9), results, 'INSERT_10000_JUDY', width=1.8)
+        graph.addSmoothCurve('', (.3, .7, .3, .6), results, 'INSERT_1000_STD_UNORDERED_MAP')
+        graph.addSmoothCurve('', (.3, .7, .3), results, 'INSERT_10000_STD_UNORDERED_MAP', width=1.8)
+        graph.addSmoothCurve('', (.8, .6, .2, .6), results, 'INSERT_1000_STD_MAP')
+        graph.addSmoothCurve('', (.8, .6, .2), results, 'INSERT_10000_STD_MAP', width=1.8)
+        graph.addSmoothCurve('', (.6, .3, .7, .6), results, 'INSERT_1000_DENSE_HASH')
+        graph.addSmoothCurve('', (.6, .3, .7), results, 'INSERT_10000_DENSE_HASH', width=1.8)
+        graph.render()
+
+    graph = Graph('table-growth-memory.png', 'Total Bytes Per Item')
+    if filter.match(graph.filename):
+        print('Rendering %s...' % graph.filename)
+        graph.yattribs = AxisAttribs(150, 0, 60, 10, False)
+        graph.smoothing = False
+        graph.addSmoothCurve('Grow 2x', (1, .4, .4), results, 'MEMORY_TABLE')
+        graph.addSmoothCurve('Grow 1.5x', (.8, .6, .2), results, 'MEMORY_TABLE_GROWTH_150')
+        graph.addSmoothCurve('Grow 1.25x', (.4, .4, .9), results, 'MEMORY_TABLE_GROWTH_125')
+        graph.render()
+
+    graph = Graph('cuckoo-memory.png', 'Total Bytes Per Item')
+    if filter.match(graph.filename):
+        print('Rendering %s...' % graph.filename)
+        graph.yattribs = AxisAttribs(150, 0, 60, 10, False)
+        graph.smoothing = False
+        graph.addSmoothCurve('Hash Table', (1, .4, .4), results, 'MEMORY_TABLE')
+        graph.addSmoothCurve('Table, 90% load', (.8, .6, .2), results, 'MEMORY_TABLE_LOAD_90')
+        graph.addSmoothCurve('Cuckoo', (.4, .4, .9), results, 'MEMORY_CUCKOO_TABLE')
         graph.render()
 
     graph = Graph('memory.png', 'Total Bytes Per Item')
     if filter.match(graph.filename):
         print('Rendering %s...' % graph.filename)
-        graph.yattribs = AxisAttribs(150, 0, 25, 5, False)
+        graph.yattribs = AxisAttribs(150, 0, 60, 10, False)
         graph.smoothing = False
         graph.xlabelshift = 21
         graph.addSmoothCurve('Hash Table', (1, .4, .4), results, 'MEMORY_TABLE', -3)
         graph.addSmoothCurve('Judy Array', (.4, .4, .9), results, 'MEMORY_JUDY')
+        graph.addSmoothCurve('Judy (slab)', (.2, .6, .6), results, 'MEMORY_JUDY_SLAB')
+        graph.addSmoothCurve('unordered_map', (.3, .7, .3), results, 'MEMORY_STD_UNORDERED_MAP')
+        graph.addSmoothCurve('std::map', (.8, .6, .2), results, 'MEMORY_STD_MAP')
+        graph.addSmoothCurve('Dense Hash', (.6, .3, .7), results, 'MEMORY_DENSE_HASH')
         graph.render()
     
     print('Elapsed time: %s' % (datetime.now() - start))
@@ -0,0 +1,108 @@
+#include <config.h>
+#include <windows.h>
+#include "shardedhashtable.h"
+#include "util.h"
+#include <assert.h>
+#include <new>
+
+
+//----------------------------------------------
+//  ShardedHashTable::ShardedHashTable
+//----------------------------------------------
+ShardedHashTable::ShardedHashTable(int shardBits)
+{
+    assert(shardBits >= 0 && shardBits < 16);
+    m_shardBits = shardBits;
+
+    // Align the shard array to a cache line; new[] only guarantees word alignment
+    size_t count = ShardCount();
+    m_memory = new char[sizeof(Shard) * count + kCacheLineSize - 1];
+    m_shards = (Shard*) (((size_t) m_memory + kCacheLineSize - 1) & ~(kCacheLineSize - 1));
+    for (size_t i = 0; i < count; i++)
+        new (&m_shards[i]) Shard;
+}
+
+//----------------------------------------------
+//  ShardedHashTable::~ShardedHashTable
+//----------------------------------------------
+ShardedHashTable::~ShardedHashTable()
+{
+    size_t count = ShardCount();
+    for (size_t i = 0; i < count; i++)
+        m_shards[i].~Shard();
+    delete[] m_memory;
+}
+
+//----------------------------------------------
+//  ShardedHashTable::ShardFor
+//----------------------------------------------
+ShardedHashTable::Shard& ShardedHashTable::ShardFor(size_t key)
+{
+    // HashTable picks cells using the top bits of the same hash, so use the low bits here
+    return m_shards[(size_t) integerHash(key) & (ShardCount() - 1)];
+}
+
+//----------------------------------------------
+//  ShardedHashTable::Increment
+//----------------------------------------------
+size_t ShardedHashTable::Increment(size_t key)
+{
+    Shard& shard = ShardFor(key);
+    shard.lock.Lock();
+    size_t value = ++shard.table.Insert(key)->value;
+    shard.lock.Unlock();
+    return value;
+}
+
+//----------------------------------------------
+//  ShardedHashTable::Lookup
+//----------------------------------------------
+bool ShardedHashTable::Lookup(size_t key, size_t& value)
+{
+    Shard& shard = ShardFor(key);
+    shard.lock.Lock();
+    HashTable::Cell* cell = shard.table.Lookup(key);
+    if (cell)
+        value = cell->value;
+    shard.lock.Unlock();
+    return cell != NULL;
+}
+
+//----------------------------------------------
+//  ShardedHashTable::Delete
+//----------------------------------------------
+void ShardedHashTable::Delete(size_t key)
+{
+    Shard& shard = ShardFor(key);
+    shard.lock.Lock();
+    shard.table.Delete(key);
+    shard.lock.Unlock();
+}
+
+//----------------------------------------------
+//  ShardedHashTable::Clear
+//----------------------------------------------
+void ShardedHashTable::Clear()
+{
+    size_t count = ShardCount();
+    for (size_t i = 0; i < count; i++)
+    {
+        m_shards[i].lock.Lock();
+        m_shards[i].table.Clear();
+        m_shards[i].lock.Unlock();
+    }
+}
+
+//----------------------------------------------
+//  ShardedHashTable::Compact
+//----------------------------------------------
+void ShardedHashTable::Compact()
+{
+    size_t count = ShardCount();
+    for (size_t i = 0; i < count; i++)
+    {
+        m_shards[i].lock.Lock();
+        m_shards[i].table.Compact();
+        m_shards[i].lock.Unlock();
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "hashtable.h"
+#include "spinlock.h"
+
+
+//----------------------------------------------
+//  ShardedHashTable
+//
+//  Thread-safe map built from 2^shardBits independent HashTables.
+//  The low bits of the key's hash select the shard, and each shard has its own SpinLock,
+//  so threads only contend when they touch the same shard, and each shard resizes on its own.
+//  With shardBits = 0, it's a single HashTable behind a single lock.
+//  Operations take the key's shard lock for their whole duration, so they return values, not Cells.
+//----------------------------------------------
+class ShardedHashTable
+{
+public:
+    static const size_t kCacheLineSize = 64;
+
+private:
+    // Each shard starts on its own cache line, so locking one doesn't invalidate its neighbors
+    struct Shard
+    {
+        SpinLock lock;
+        HashTable table;
+        char padding[kCacheLineSize - (sizeof(SpinLock) + sizeof(HashTable)) % kCacheLineSize];
+    };
+
+    char* m_memory;
+    Shard* m_shards;
+    int m_shardBits;
+
+    Shard& ShardFor(size_t key);
+
+public:
+    ShardedHashTable(int shardBits);
+    ~ShardedHashTable();
+
+    // Basic operations
+    size_t Increment(size_t key);
+    bool Lookup(size_t key, size_t& value);
+    void Delete(size_t key);
+    void Clear();
+    void Compact();
+
+    size_t ShardCount() const { return (size_t) 1 << m_shardBits; }
+
+    // Not thread-safe; for scanning every shard with HashTable::Iterator
+    HashTable& ShardTable(size_t index) { return m_shards[index].table; }
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+
+//----------------------------------------------
+//  SpinLock
+//
+//  Test-and-test-and-set lock for short critical sections.
+//  Waiters spin on a plain read, so the cache line isn't written until the lock looks free,
+//  and give up their time slice after a while in case the holder has been preempted.
+//----------------------------------------------
+class SpinLock
+{
+private:
+    volatile LONG m_locked;
+
+public:
+    SpinLock() : m_locked(0) {}
+
+    void Lock()
+    {
+        while (InterlockedExchange(&m_locked, 1) != 0)
+        {
+            for (int spins = 0; m_locked != 0; spins++)
+            {
+                if (spins < 1000)
+                    YieldProcessor();
+                else
+                    SwitchToThread();
+            }
+        }
+    }
+
+    void Unlock()
+    {
+        InterlockedExchange(&m_locked, 0);
+    }
+};
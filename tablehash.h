@@ -0,0 +1,65 @@
+#pragma once
+
+#include "util.h"
+#include <nmmintrin.h>
+
+
+//----------------------------------------------
+//  tableHash
+//
+//  The hash HashTable places keys with, chosen at build time by INTEGER_MAP_TABLE_HASH.
+//  FIRST_CELL maps it to a cell using its top bits, so every choice must mix the key into those.
+//  MURMUR is integerHash, the MurmurHash3 finalizer. FIBONACCI is a single multiply by
+//  2^N / phi. CRC32C uses the SSE4.2 instruction. XXH3 is the rrmxmx mixer XXH3 applies to
+//  8-byte inputs, or the XXH32 avalanche in 32-bit builds.
+//  CRC32C and IDENTITY produce only 32 bits, which are moved to the top of the word. IDENTITY
+//  doesn't mix at all, so it only suits keys which are already uniformly random 32-bit values,
+//  such as those made by RANDOM_SEQUENCE_OF_UNIQUE.
+//----------------------------------------------
+inline size_t tableHash(size_t key)
+{
+#if INTEGER_MAP_TABLE_HASH(MURMUR)
+    return (size_t) integerHash(key);
+
+#elif INTEGER_MAP_TABLE_HASH(FIBONACCI)
+#ifdef _WIN64
+    return key * 0x9e3779b97f4a7c15ull;
+#else
+    return key * 0x9e3779b9u;
+#endif
+
+#elif INTEGER_MAP_TABLE_HASH(CRC32C)
+#ifdef _WIN64
+    return (size_t) _mm_crc32_u64(0, key) << 32;
+#else
+    return _mm_crc32_u32(0, key);
+#endif
+
+#elif INTEGER_MAP_TABLE_HASH(XXH3)
+#ifdef _WIN64
+    uint64_t h = key;
+    h ^= ((h << 49) | (h >> 15)) ^ ((h << 24) | (h >> 40));
+    h *= 0x9fb21c651e98df25ull;
+    h ^= (h >> 35) + sizeof(size_t);
+    h *= 0x9fb21c651e98df25ull;
+    return h ^ (h >> 28);
+#else
+    uint32_t h = key;
+    h ^= h >> 15;
+    h *= 0x85ebca77u;
+    h ^= h >> 13;
+    h *= 0xc2b2ae3du;
+    return h ^ (h >> 16);
+#endif
+
+#elif INTEGER_MAP_TABLE_HASH(IDENTITY)
+#ifdef _WIN64
+    return key << 32;
+#else
+    return key;
+#endif
+
+#else
+    #error No such INTEGER_MAP_TABLE_HASH type.
+#endif
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#if !INTEGER_MAP_CONTAINER(TABLE)
+#error INTEGER_MAP_CONTAINER must be TABLE to use INTEGER_MAP_EXPERIMENT(AGGREGATE)
+#endif
+
+#include "parallelcounter.h"
+
+
+//---------------------------------------------------
+// TestCase for AGGREGATE operation
+//
+// Counts operationsPerGroup random keys, drawn from the first population keys, with a
+// ParallelCounter running on INTEGER_MAP_THREADS threads. The result is the wall-clock time
+// of the whole count, merge included, per input key. Each marker starts from empty tables.
+//---------------------------------------------------
+void TestBody()
+{
+    ResultHolder rh;
+    WorkerPool pool(INTEGER_MAP_THREADS);
+    ParallelCounter counter(pool, INTEGER_MAP_TABLE_SHARD_BITS);
+
+    // Determine markers
+    std::vector<size_t> markers;
+    g_Params.DefineMarkers(markers);
+
+    KeySequence keys;
+    GenerateKeys(keys, markers[markers.size() - 1], 0);
+
+    rh.results.resize(markers.size());
+
+    int mustCount = g_Params.operationsPerGroup;
+    std::vector<size_t> input(mustCount);
+
+    for (int m = 0; m < markers.size(); m++)
+    {
+        size_t population = markers[m];
+
+        // Make sequence of keys to count
+        for (int j = 0; j < mustCount; j++)
+            input[j] = keys[g_Params.RandomIndex(population)];
+
+        Timer::Tick start = Timer::Sample();
+        counter.Count(&input[0], mustCount);
+        Timer::Tick end = Timer::Sample();
+
+        ResultHolder::Result& r = rh.results[m];
+        r.marker = population;
+        r.nanosecs = (end - start - Timer::overhead) * Timer::ticksToNanosecs / mustCount;
+
+        counter.Clear();
+    }
+
+    rh.dump();
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#if !INTEGER_MAP_CONTAINER(TABLE)
+#error INTEGER_MAP_CONTAINER must be TABLE to use INTEGER_MAP_EXPERIMENT(COLDSTART)
+#endif
+
+#include <stdio.h>
+
+
+//---------------------------------------------------
+// TestCase for COLDSTART operation
+//
+// For each marker, saves the table to a snapshot file, then measures the
+// time to map it back in and complete the first lookup (results), and the
+// average time of the lookups which follow while its pages are faulted in
+// (warmup). The file was just written, so it is still in the OS file cache;
+// these are soft page faults, not disk reads.
+//---------------------------------------------------
+#define COLDSTART_SNAPSHOT_PATH "coldstart.snapshot"
+
+void TestBody()
+{
+    ResultHolder rh;
+
+    // Determine markers
+    std::vector<size_t> markers;
+    g_Params.DefineMarkers(markers);
+
+    KeySequence keys;
+    GenerateKeys(keys, markers[markers.size() - 1], 0);
+    std::vector<size_t> lookupKeys;
+
+    rh.results.resize(markers.size());
+    rh.warmup.resize(markers.size());
+
+    MAP_DECLARE;
+    MAP_INITIALIZE();
+
+    size_t i = 0;
+    for (int m = 0; m < markers.size(); m++)
+    {
+        size_t population = markers[m];
+        for (; i < population; i++)
+        {
+            // Insert & increment the table entry
+            MAP_INCREMENT(keys[i]);
+        }
+
+        if (!ht.Save(COLDSTART_SNAPSHOT_PATH))
+        {
+            fprintf(stderr, "Can't write %s\n", COLDSTART_SNAPSHOT_PATH);
+            exit(1);
+        }
+
+        HashTable mapped;
+
+        // Map the snapshot and look up one key
+        size_t key = keys[g_Params.RandomIndex(population)];
+        Timer::Tick start = Timer::Sample();
+        bool ok = mapped.MapFromFile(COLDSTART_SNAPSHOT_PATH);
+        ok = ok && mapped.Lookup(key) != NULL;
+        Timer::Tick end = Timer::Sample();
+        if (!ok)
+        {
+            fprintf(stderr, "Can't map %s\n", COLDSTART_SNAPSHOT_PATH);
+            exit(1);
+        }
+        double firstLookup = (end - start - Timer::overhead) * Timer::ticksToNanosecs;
+
+        // Follow with random lookups, most of which touch pages not yet faulted in
+        int mustLookup = g_Params.operationsPerGroup;
+        lookupKeys.resize(mustLookup);
+        for (int j = 0; j < mustLookup; j++)
+            lookupKeys[j] = keys[g_Params.RandomIndex(population)];
+        Timer::Tick accum = 0;
+        for (int j = 0; j < mustLookup; j++)
+        {
+            size_t key = lookupKeys[j];
+            start = Timer::Sample();
+            mapped.Lookup(key);
+            end = Timer::Sample();
+            accum += end - start - Timer::overhead;
+        }
+
+        ResultHolder::Result& r = rh.results[m];
+        r.marker = population;
+        r.nanosecs = firstLookup;
+
+        ResultHolder::Result& w = rh.warmup[m];
+        w.marker = population;
+        w.nanosecs = accum * Timer::ticksToNanosecs / mustLookup;
+    }
+
+    remove(COLDSTART_SNAPSHOT_PATH);
+    MAP_CLEAR();
+
+    rh.dump();
+};
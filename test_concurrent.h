@@ -0,0 +1,102 @@
+#pragma once
+
+#if !INTEGER_MAP_CONTAINER(SHARDED_TABLE) && !INTEGER_MAP_CONTAINER(LOCKED_TABLE) && !INTEGER_MAP_CONTAINER(LOCKFREE_TABLE)
+#error INTEGER_MAP_CONTAINER must be SHARDED_TABLE, LOCKED_TABLE or LOCKFREE_TABLE to use INTEGER_MAP_EXPERIMENT(CONCURRENT)
+#endif
+
+#include "workerpool.h"
+
+
+//---------------------------------------------------
+// TestCase for CONCURRENT operation
+//
+// The multi-threaded version of LOOKUP: INTEGER_MAP_THREADS threads increment random
+// existing entries of the same map at once. The keys between markers are inserted by
+// all the threads too, so the map grows (and shards resize) while shared.
+// The result is the wall-clock time of each group of operations divided by its size,
+// so it falls as threads are added, until they start to contend.
+//---------------------------------------------------
+struct ConcurrentJob
+{
+    ConcurrentMap* map;
+    const KeySequence* keys;
+    const size_t* indices;  // Into keys, or NULL to increment keys[begin..end) in order
+    size_t begin;
+    size_t end;
+};
+
+static void ConcurrentIncrement(int thread, int threadCount, void* arg)
+{
+    ConcurrentJob* job = (ConcurrentJob*) arg;
+    ConcurrentMap& cmap = *job->map;
+    const KeySequence& keys = *job->keys;
+
+    // Interleave the operations between threads
+    if (job->indices)
+    {
+        for (size_t j = job->begin + thread; j < job->end; j += threadCount)
+            MAP_INCREMENT(keys[job->indices[j]]);
+    }
+    else
+    {
+        for (size_t i = job->begin + thread; i < job->end; i += threadCount)
+            MAP_INCREMENT(keys[i]);
+    }
+}
+
+void TestBody()
+{
+    ResultHolder rh;
+    WorkerPool pool(INTEGER_MAP_THREADS);
+
+    // Determine markers
+    std::vector<size_t> markers;
+    g_Params.DefineMarkers(markers);
+
+    KeySequence keys;
+    GenerateKeys(keys, markers[markers.size() - 1], 0);
+
+    rh.results.resize(markers.size());
+
+    MAP_DECLARE;
+    MAP_INITIALIZE();
+
+    ConcurrentJob job;
+    job.map = &cmap;
+    job.keys = &keys;
+
+    int mustIncrement = g_Params.operationsPerGroup;
+    std::vector<size_t> indices(mustIncrement);
+
+    size_t i = 0;
+    for (int m = 0; m < markers.size(); m++)
+    {
+        size_t population = markers[m];
+
+        // Insert & increment the new entries
+        job.indices = NULL;
+        job.begin = i;
+        job.end = population;
+        pool.Run(ConcurrentIncrement, &job);
+        i = population;
+
+        // Make sequence of keys to increment
+        for (int j = 0; j < mustIncrement; j++)
+            indices[j] = g_Params.RandomIndex(population);
+
+        job.indices = &indices[0];
+        job.begin = 0;
+        job.end = mustIncrement;
+        Timer::Tick start = Timer::Sample();
+        pool.Run(ConcurrentIncrement, &job);
+        Timer::Tick end = Timer::Sample();
+
+        ResultHolder::Result& r = rh.results[m];
+        r.marker = population;
+        r.nanosecs = (end - start - Timer::overhead) * Timer::ticksToNanosecs / mustIncrement;
+    }
+
+    MAP_CLEAR();
+
+    rh.dump();
+};
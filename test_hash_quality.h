@@ -0,0 +1,85 @@
+#pragma once
+
+#if !INTEGER_MAP_CONTAINER(TABLE) || !INTEGER_MAP_TABLE_STATS
+#error INTEGER_MAP_CONTAINER must be TABLE and INTEGER_MAP_TABLE_STATS must be true to use INTEGER_MAP_EXPERIMENT(HASH_QUALITY)
+#endif
+
+#include "tablehash.h"
+
+
+//---------------------------------------------------
+// TestCase for HASH_QUALITY operation
+//
+// Measures how well INTEGER_MAP_TABLE_HASH spreads the keys made by INTEGER_MAP_KEY_GENERATION.
+// The results are lookup times, as in LOOKUP. At each marker, it also outputs the mean cells
+// examined per lookup in 'probes', the longest probe of any stored key in 'maxprobe', and the
+// time to compute tableHash alone, in 'hashtime'.
+//---------------------------------------------------
+volatile size_t g_hashSink;     // Keeps the compiler from skipping the hashes it times
+
+void TestBody()
+{
+    ResultHolder rh;
+
+    // Determine markers
+    std::vector<size_t> markers;
+    g_Params.DefineMarkers(markers);
+
+    KeySequence keys;
+    GenerateKeys(keys, markers[markers.size() - 1], 0);
+
+    rh.results.resize(markers.size());
+    rh.hashtime.resize(markers.size());
+
+    MAP_DECLARE;
+    MAP_INITIALIZE();
+
+    int mustLookup = g_Params.operationsPerGroup;
+    std::vector<size_t> lookups(mustLookup);
+
+    size_t i = 0;
+    for (int m = 0; m < markers.size(); m++)
+    {
+        size_t population = markers[m];
+        for (; i < population; i++)
+        {
+            // Insert & increment the table entry
+            MAP_INCREMENT(keys[i]);
+        }
+
+        // Make sequence of keys to get
+        for (int j = 0; j < mustLookup; j++)
+            lookups[j] = keys[g_Params.RandomIndex(population)];
+
+        // Time the hash function by itself, all at once, since it's too quick to time one call
+        size_t sum = 0;
+        Timer::Tick start = Timer::Sample();
+        for (int j = 0; j < mustLookup; j++)
+            sum += tableHash(lookups[j]);
+        Timer::Tick end = Timer::Sample();
+        g_hashSink = sum;
+        ResultHolder::Result& h = rh.hashtime[m];
+        h.marker = population;
+        h.nanosecs = (end - start - Timer::overhead) * Timer::ticksToNanosecs / mustLookup;
+
+        // Time the lookups one at a time, as LOOKUP does
+        MAP_RESET_LOOKUP_STATS();
+        Timer::Tick accum = 0;
+        for (int j = 0; j < mustLookup; j++)
+        {
+            start = Timer::Sample();
+            MAP_INCREMENT(lookups[j]);
+            end = Timer::Sample();
+            accum += end - start - Timer::overhead;
+        }
+        ResultHolder::Result& r = rh.results[m];
+        r.marker = population;
+        r.nanosecs = accum * Timer::ticksToNanosecs / mustLookup;
+
+        MAP_GATHER_STATS(rh, population);
+    }
+
+    MAP_CLEAR();
+
+    rh.dump();
+};
@@ -1,5 +1,22 @@
 #pragma once
 
+#if INTEGER_MAP_TIMING_MODE(THROUGHPUT) && INTEGER_MAP_CACHE_STOMPER_ENABLED
+#error INTEGER_MAP_CACHE_STOMPER_ENABLED can't be used with INTEGER_MAP_TIMING_MODE(THROUGHPUT), which would time the stomping too
+#endif
+
+//---------------------------------------------------
+// Inserts timed between two markers. With INTEGER_MAP_SAMPLED_MARKERS, only
+// the last operationsPerGroup before each marker are timed.
+//---------------------------------------------------
+inline size_t TimedInserts(size_t begin, size_t limit)
+{
+#if INTEGER_MAP_SAMPLED_MARKERS
+    size_t sample = g_Params.operationsPerGroup;
+    return limit - begin > sample ? sample : limit - begin;
+#else
+    return limit - begin;
+#endif
+}
 
 //---------------------------------------------------
 // TestCase for INSERT operation
@@ -8,11 +25,12 @@ void TestBody()
 {
     ResultHolder rh;
     CacheStomper stomper(g_Params.stompBytes);
+    BackgroundStomper neighbor;
 
     // Determine markers
-    std::vector<int> markers;
+    std::vector<size_t> markers;
     g_Params.DefineMarkers(markers);
-    std::vector<size_t> keys;
+    KeySequence keys;
     int keySeed = 0;
 
     struct TimeGroup
@@ -24,10 +42,15 @@ void TestBody()
     };
     std::vector<TimeGroup> timeGroups;
     timeGroups.resize(markers.size());
+    std::vector<TimeGroup> teardownGroups;
+    teardownGroups.resize(markers.size());
+    std::vector<TimeGroup> bandwidthGroups;
+    bandwidthGroups.resize(markers.size());
 
     std::vector<Timer::Tick> ticks;
     ticks.resize(markers.size());
 
+    neighbor.Start();
     int M = markers.size();
     int R = 0;
     int r = 0;
@@ -38,7 +61,12 @@ void TestBody()
             if (--M <= 0)
                 break;
             int prevR = R;
+#if INTEGER_MAP_SAMPLED_MARKERS
+            // Each group's sample is already operationsPerGroup inserts, so one map, built up to every marker, is enough
+            R = 1;
+#else
             R = g_Params.operationsPerGroup / (M > 0 ? markers[M] - markers[M - 1] : 1) + 1;
+#endif
             r = R - prevR;
             continue;
         }
@@ -48,12 +76,24 @@ void TestBody()
         MAP_DECLARE;
         MAP_INITIALIZE();
 
-        int i = 0;
+        size_t i = 0;
         Timer::Tick* tick = &ticks[0];
         Timer::Tick accum = 0;
         for (int m = 0; m <= M; m++)
         {
-            int limit = markers[m];
+            size_t limit = markers[m];
+            // Untimed inserts, up to the sample
+            for (size_t sampleStart = limit - TimedInserts(i, limit); i < sampleStart; i++)
+                MAP_INCREMENT(keys[i]);
+#if INTEGER_MAP_TIMING_MODE(THROUGHPUT)
+            // One sample at each end of the group, so consecutive inserts can overlap
+            Timer::Tick start = Timer::Sample();
+            for (; i < limit; i++)
+                MAP_INCREMENT(keys[i]);
+            Timer::Tick end = Timer::Sample();
+            accum += end - start - Timer::overhead;
+#else
+            stomper.PrepareRandomStomps(limit - i);
             for (; i < limit; i++)
             {
                 // Insert & increment the table entry
@@ -65,9 +105,16 @@ void TestBody()
 
                 stomper.RandomStomp();
             }
+#endif
 
             // Time measurement between each group of operations
             *tick++ = accum;
+            bandwidthGroups[m].sum += neighbor.TakeBandwidth();
+            bandwidthGroups[m].count++;
+
+            // Table internals, from the first pass only, since it reaches every marker
+            if (keySeed == 1)
+                MAP_GATHER_STATS(rh, limit);
         }
 
         for (int m = 1; m <= M; m++)
@@ -77,18 +124,45 @@ void TestBody()
             timeGroups[m].count++;
         }
 
+        // Time the teardown of all markers[M] entries
+        Timer::Tick start = Timer::Sample();
         MAP_CLEAR();
+        Timer::Tick end = Timer::Sample();
+        teardownGroups[M].sum += (end - start - Timer::overhead) * Timer::ticksToNanosecs;
+        teardownGroups[M].count++;
+        // Untimed: ASYNC's workers must be done before the next pass's timed inserts
+        MAP_CLEAR_WAIT();
         r--;
     }
+    neighbor.Stop();
 
     rh.results.resize(markers.size() - 1);
     for (int m = 1; m < markers.size(); m++)
     {
         ResultHolder::Result& r = rh.results[m - 1];
         r.marker = markers[m];
-        int span = markers[m] - markers[m - 1];
-        r.nanosecs = timeGroups[m].sum / timeGroups[m].count / span;
+        size_t timed = TimedInserts(markers[m - 1], markers[m]);
+        r.nanosecs = timeGroups[m].sum / timeGroups[m].count / timed;
+    }
+    for (int m = 1; m < markers.size(); m++)
+    {
+        if (teardownGroups[m].count > 0)
+        {
+            ResultHolder::Result t;
+            t.marker = markers[m];
+            t.nanosecs = teardownGroups[m].sum / teardownGroups[m].count / markers[m];
+            rh.teardown.push_back(t);
+        }
+    }
+#if INTEGER_MAP_BACKGROUND_STOMPER
+    for (int m = 1; m < markers.size(); m++)
+    {
+        ResultHolder::Result b;
+        b.marker = markers[m];
+        b.nanosecs = bandwidthGroups[m].sum / bandwidthGroups[m].count;
+        rh.stompBandwidth.push_back(b);
     }
+#endif
     
     rh.dump();
 };
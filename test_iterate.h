@@ -0,0 +1,70 @@
+#pragma once
+
+#if !INTEGER_MAP_CONTAINER(JUDY) && !INTEGER_MAP_CONTAINER(TABLE) && !INTEGER_MAP_CONTAINER(STD_UNORDERED_MAP) && !INTEGER_MAP_CONTAINER(STD_MAP) \
+    && !INTEGER_MAP_CONTAINER(CUCKOO_TABLE) && !INTEGER_MAP_CONTAINER(SHARDED_TABLE) && !INTEGER_MAP_CONTAINER(LOCKED_TABLE) && !INTEGER_MAP_CONTAINER(LOCKFREE_TABLE)
+#error INTEGER_MAP_CONTAINER must have an iterator to use INTEGER_MAP_EXPERIMENT(ITERATE), which NONE and DENSE_HASH lack
+#endif
+
+
+//---------------------------------------------------
+// TestCase for ITERATE operation
+//---------------------------------------------------
+volatile size_t g_iterateSum;
+
+void TestBody()
+{
+    ResultHolder rh;
+    CacheStomper stomper(g_Params.stompBytes);
+
+    // Determine markers
+    std::vector<size_t> markers;
+    g_Params.DefineMarkers(markers);
+
+    KeySequence keys;
+    GenerateKeys(keys, markers[markers.size() - 1], 0);
+
+    rh.results.resize(markers.size());
+
+    MAP_DECLARE;
+    MAP_INITIALIZE();
+
+    size_t sum = 0;
+    size_t i = 0;
+    for (int m = 0; m < markers.size(); m++)
+    {
+        size_t population = markers[m];
+        for (; i < population; i++)
+        {
+            // Insert & increment the table entry
+            MAP_INCREMENT(keys[i]);
+        }
+
+        // Visit every entry, repeating full passes until at least
+        // operationsPerGroup entries have been visited
+        int passes = (g_Params.operationsPerGroup + population - 1) / population;
+        Timer::Tick start, end;
+        Timer::Tick accum = 0;
+        stomper.PrepareRandomStomps(passes);
+        for (int j = 0; j < passes; j++)
+        {
+            start = Timer::Sample();
+            MAP_ITERATE(sum);
+            end = Timer::Sample();
+            accum += end - start - Timer::overhead;
+
+            stomper.RandomStomp();
+        }
+
+        ResultHolder::Result& r = rh.results[m];
+        r.marker = population;
+        r.nanosecs = accum * Timer::ticksToNanosecs / ((double) passes * population);
+    }
+
+    // Keep the visited values live so the scans aren't optimized away
+    g_iterateSum = sum;
+
+    MAP_CLEAR();
+    MAP_CLEAR_WAIT();
+
+    rh.dump();
+};
@@ -1,5 +1,30 @@
 #pragma once
 
+#if INTEGER_MAP_TIMING_MODE(THROUGHPUT) && INTEGER_MAP_CACHE_STOMPER_ENABLED
+#error INTEGER_MAP_CACHE_STOMPER_ENABLED can't be used with INTEGER_MAP_TIMING_MODE(THROUGHPUT), which would time the stomping too
+#endif
+
+#if INTEGER_MAP_TIMING_MODE(THROUGHPUT) && !INTEGER_MAP_COLD_CACHE(NONE)
+#error INTEGER_MAP_COLD_CACHE must be NONE with INTEGER_MAP_TIMING_MODE(THROUGHPUT), which can't evict between operations
+#endif
+
+#if INTEGER_MAP_COLD_CACHE(FLUSH) && !defined(MAP_LOOKUP_PATH)
+#error INTEGER_MAP_CONTAINER must be JUDY or TABLE to use INTEGER_MAP_COLD_CACHE(FLUSH)
+#endif
+
+#if !INTEGER_MAP_COLD_CACHE(NONE)
+//---------------------------------------------------
+// Evict a lookup's memory from the cache; THRASH doesn't need its path
+//---------------------------------------------------
+inline void MakeCold(CacheStomper& stomper, const CachePath& path)
+{
+#if INTEGER_MAP_COLD_CACHE(FLUSH)
+    CacheStomper::Flush(path);
+#else
+    stomper.Thrash();
+#endif
+}
+#endif
 
 //---------------------------------------------------
 // TestCase for LOOKUP operation
@@ -8,23 +33,26 @@ void TestBody()
 {
     ResultHolder rh;
     CacheStomper stomper(g_Params.stompBytes);
+    BackgroundStomper neighbor;
 
     // Determine markers
-    std::vector<int> markers;
+    std::vector<size_t> markers;
     g_Params.DefineMarkers(markers);
 
-    std::vector<size_t> keys;
+    KeySequence keys;
     GenerateKeys(keys, markers[markers.size() - 1], 0);
+    std::vector<size_t> lookupKeys;
 
     rh.results.resize(markers.size());
 
     MAP_DECLARE;
     MAP_INITIALIZE();
+    neighbor.Start();
 
-    int i = 0;
+    size_t i = 0;
     for (int m = 0; m < markers.size(); m++)
     {
-        int population = markers[m];
+        size_t population = markers[m];
         for (; i < population; i++)
         {
             // Insert & increment the table entry
@@ -32,26 +60,92 @@ void TestBody()
         }
 
         // Make sequence of keys to get
+        MAP_RESET_LOOKUP_STATS();
         int mustLookup = g_Params.operationsPerGroup;
         Timer::Tick start, end;
         Timer::Tick accum = 0;
+        // Pick the keys and stomps up front, so no random numbers are drawn between the timed lookups
+        lookupKeys.resize(mustLookup);
+        for (int j = 0; j < mustLookup; j++)
+            lookupKeys[j] = keys[g_Params.RandomIndex(population)];
+        stomper.PrepareRandomStomps(mustLookup);
+#if INTEGER_MAP_TIMING_MODE(THROUGHPUT)
+        // Time the whole group with one sample at each end,
+        // so the CPU can overlap the cache misses of consecutive lookups
+        start = Timer::Sample();
+        for (int j = 0; j < mustLookup; j++)
+            MAP_INCREMENT(lookupKeys[j]);
+        end = Timer::Sample();
+        accum = end - start - Timer::overhead;
+#else
         for (int j = 0; j < mustLookup; j++)
         {
-            size_t key = keys[g_Params.random.integer() % population];
+            size_t key = lookupKeys[j];
+#if !INTEGER_MAP_COLD_CACHE(NONE)
+            CachePath path;
+#if INTEGER_MAP_COLD_CACHE(FLUSH)
+            MAP_LOOKUP_PATH(key, path);
+#endif
+            MakeCold(stomper, path);
+            // Flushing loads the TLB entries for the path's pages, so stomp after it
+            stomper.RandomStomp();
+#endif
             start = Timer::Sample();
             MAP_INCREMENT(key);
             end = Timer::Sample();
             accum += end - start - Timer::overhead;
 
+#if INTEGER_MAP_COLD_CACHE(NONE)
             stomper.RandomStomp();
+#endif
+        }
+#endif
+#if !INTEGER_MAP_COLD_CACHE(NONE) && defined(MAP_LOOKUP_PATH)
+        // Checking which nodes are cached brings them into the cache, so it can't be done on the
+        // timed lookups. Instead, evict the paths of as many more keys the same way, and check those.
+        // FLUSH evicts exactly the nodes on the path, so only THRASH can leave any of them resident.
+        {
+#if INTEGER_MAP_COLD_CACHE(THRASH)
+            int resident = 0;
+#endif
+            int pathNodes = 0;
+            for (int j = 0; j < mustLookup; j++)
+            {
+                size_t key = keys[g_Params.RandomIndex(population)];
+                CachePath path;
+                MAP_LOOKUP_PATH(key, path);
+#if INTEGER_MAP_COLD_CACHE(THRASH)
+                MakeCold(stomper, path);
+                resident += CacheStomper::CountResident(path);
+#endif
+                pathNodes += path.count;
+            }
+            ResultHolder::Result r;
+            r.marker = population;
+#if INTEGER_MAP_COLD_CACHE(THRASH)
+            r.nanosecs = (double) resident / mustLookup;
+            rh.resident.push_back(r);
+#endif
+            r.nanosecs = (double) pathNodes / mustLookup;
+            rh.pathNodes.push_back(r);
         }
+#endif
 
         ResultHolder::Result& r = rh.results[m];
         r.marker = population;
         r.nanosecs = accum * Timer::ticksToNanosecs / mustLookup;
+#if INTEGER_MAP_BACKGROUND_STOMPER
+        ResultHolder::Result b;
+        b.marker = population;
+        b.nanosecs = neighbor.TakeBandwidth();
+        rh.stompBandwidth.push_back(b);
+#endif
+        MAP_GATHER_STATS(rh, population);
     }
 
+    neighbor.Stop();
     MAP_CLEAR();
+    MAP_CLEAR_WAIT();
     
     rh.dump();
 };
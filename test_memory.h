@@ -25,11 +25,11 @@ void TestBody()
     ResultHolder rh;
 
     // Determine markers
-    std::vector<int> markers;
+    std::vector<size_t> markers;
     g_Params.DefineMarkers(markers);
     rh.results.resize(markers.size());
 
-    std::vector<size_t> keys;
+    KeySequence keys;
     GenerateKeys(keys, markers[markers.size() - 1], 0);
 
     dlmalloc_stats_t stats;
@@ -39,10 +39,10 @@ void TestBody()
     MAP_DECLARE;
     MAP_INITIALIZE();
 
-    int i = 0;
+    size_t i = 0;
     for (int m = 0; m < markers.size(); m++)
     {
-        int limit = markers[m];
+        size_t limit = markers[m];
         for (; i < limit; i++)
         {
             // Insert & increment the table entry
@@ -58,6 +58,7 @@ void TestBody()
     }
 
     MAP_CLEAR();
+    MAP_CLEAR_WAIT();
 
     rh.dump();
 };
@@ -0,0 +1,72 @@
+#pragma once
+
+#if !INTEGER_MAP_CONTAINER(TABLE)
+#error INTEGER_MAP_CONTAINER must be TABLE to use INTEGER_MAP_EXPERIMENT(RADIX)
+#endif
+
+#if INTEGER_MAP_RADIX_PARTITIONED
+#include "radixaggregator.h"
+#endif
+
+
+//---------------------------------------------------
+// TestCase for RADIX operation
+//
+// Counts operationsPerGroup random keys, drawn from the first population keys, either by
+// incrementing each one directly in a single HashTable, or, when INTEGER_MAP_RADIX_PARTITIONED
+// is set, with a RadixAggregator whose partitions fit in INTEGER_MAP_L2_CACHE_SIZE bytes.
+// The result is the time of the whole count, per input key. Each marker starts from empty tables.
+//---------------------------------------------------
+void TestBody()
+{
+    ResultHolder rh;
+
+    // Determine markers
+    std::vector<size_t> markers;
+    g_Params.DefineMarkers(markers);
+
+    KeySequence keys;
+    GenerateKeys(keys, markers[markers.size() - 1], 0);
+
+    rh.results.resize(markers.size());
+
+#if INTEGER_MAP_RADIX_PARTITIONED
+    RadixAggregator aggregator(INTEGER_MAP_L2_CACHE_SIZE);
+#else
+    MAP_DECLARE;
+    MAP_INITIALIZE();
+#endif
+
+    int mustCount = g_Params.operationsPerGroup;
+    std::vector<size_t> input(mustCount);
+
+    for (int m = 0; m < markers.size(); m++)
+    {
+        size_t population = markers[m];
+
+        // Make sequence of keys to count
+        for (int j = 0; j < mustCount; j++)
+            input[j] = keys[g_Params.RandomIndex(population)];
+
+        Timer::Tick start = Timer::Sample();
+#if INTEGER_MAP_RADIX_PARTITIONED
+        aggregator.Count(&input[0], mustCount);
+#else
+        for (int j = 0; j < mustCount; j++)
+            MAP_INCREMENT(input[j]);
+#endif
+        Timer::Tick end = Timer::Sample();
+
+        ResultHolder::Result& r = rh.results[m];
+        r.marker = population;
+        r.nanosecs = (end - start - Timer::overhead) * Timer::ticksToNanosecs / mustCount;
+
+#if INTEGER_MAP_RADIX_PARTITIONED
+        aggregator.Clear();
+#else
+        MAP_CLEAR();
+#endif
+    }
+
+    rh.dump();
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+#if !INTEGER_MAP_CONTAINER(JUDY) && !INTEGER_MAP_CONTAINER(TABLE)
+#error INTEGER_MAP_CONTAINER must be JUDY or TABLE to use INTEGER_MAP_EXPERIMENT(SERIALIZE)
+#endif
+
+#include <stdio.h>
+
+
+//---------------------------------------------------
+// TestCase for SERIALIZE operation
+//
+// For each marker, saves the map to a file and loads the file into a new map. Records
+// the save time per item (results), the load time per item (load) and the size of the
+// file in bytes (filesize). Judy arrays are saved with JudyLSave() and rebuilt with
+// JudyLLoad(); the hash table is saved with Save() and loaded with MapFromFile(), which
+// maps the file rather than reading it.
+//---------------------------------------------------
+#define SERIALIZE_PATH "serialize.snapshot"
+
+#if INTEGER_MAP_CONTAINER(JUDY)
+static Word_t SerializeWrite(const void* buf, Word_t bytes, void* context)
+{
+    return fwrite(buf, 1, bytes, (FILE*) context);
+}
+
+static Word_t SerializeRead(void* buf, Word_t bytes, void* context)
+{
+    return fread(buf, 1, bytes, (FILE*) context);
+}
+
+static bool SerializeSave(Pcvoid_t judy)
+{
+    FILE* f = fopen(SERIALIZE_PATH, "wb");
+    if (!f)
+        return false;
+    bool ok = JudyLSave(judy, SerializeWrite, f, PJE0) != JERR;
+    return (fclose(f) == 0) && ok;
+}
+
+static bool SerializeLoad(Pvoid_t* judy, Word_t population)
+{
+    FILE* f = fopen(SERIALIZE_PATH, "rb");
+    if (!f)
+        return false;
+    bool ok = JudyLLoad(judy, SerializeRead, f, PJE0) == population;
+    fclose(f);
+    return ok;
+}
+#endif
+
+// With GetFileSizeEx, since long and ftell are 32-bit on Windows and large snapshots pass 2 GB
+static unsigned long long SerializeFileSize()
+{
+    HANDLE file = CreateFileA(SERIALIZE_PATH, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER fileSize;
+    bool ok = file != INVALID_HANDLE_VALUE && GetFileSizeEx(file, &fileSize);
+    if (file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+    if (!ok)
+    {
+        fprintf(stderr, "Can't get the size of %s\n", SERIALIZE_PATH);
+        exit(1);
+    }
+    return (unsigned long long) fileSize.QuadPart;
+}
+
+void TestBody()
+{
+    ResultHolder rh;
+
+    // Determine markers
+    std::vector<size_t> markers;
+    g_Params.DefineMarkers(markers);
+
+    KeySequence keys;
+    GenerateKeys(keys, markers[markers.size() - 1], 0);
+
+    rh.results.resize(markers.size());
+    rh.load.resize(markers.size());
+    rh.filesize.resize(markers.size());
+
+    MAP_DECLARE;
+    MAP_INITIALIZE();
+
+    size_t i = 0;
+    for (int m = 0; m < markers.size(); m++)
+    {
+        size_t population = markers[m];
+        for (; i < population; i++)
+        {
+            // Insert & increment the table entry
+            MAP_INCREMENT(keys[i]);
+        }
+
+        // Save
+        Timer::Tick start = Timer::Sample();
+#if INTEGER_MAP_CONTAINER(JUDY)
+        bool ok = SerializeSave(judy);
+#else
+        bool ok = ht.Save(SERIALIZE_PATH);
+#endif
+        Timer::Tick end = Timer::Sample();
+        if (!ok)
+        {
+            fprintf(stderr, "Can't write %s\n", SERIALIZE_PATH);
+            exit(1);
+        }
+        double saveTime = (end - start - Timer::overhead) * Timer::ticksToNanosecs;
+
+        // Load into a new map, which is discarded untimed
+#if INTEGER_MAP_CONTAINER(JUDY)
+        Pvoid_t loaded = NULL;
+        start = Timer::Sample();
+        ok = SerializeLoad(&loaded, population);
+        end = Timer::Sample();
+        JudyLFreeArray(&loaded, PJE0);
+#else
+        {
+            HashTable loaded;
+            start = Timer::Sample();
+            ok = loaded.MapFromFile(SERIALIZE_PATH);
+            end = Timer::Sample();
+        }
+#endif
+        if (!ok)
+        {
+            fprintf(stderr, "Can't load %s\n", SERIALIZE_PATH);
+            exit(1);
+        }
+        double loadTime = (end - start - Timer::overhead) * Timer::ticksToNanosecs;
+
+        ResultHolder::Result& r = rh.results[m];
+        r.marker = population;
+        r.nanosecs = saveTime / population;
+
+        ResultHolder::Result& l = rh.load[m];
+        l.marker = population;
+        l.nanosecs = loadTime / population;
+
+        ResultHolder::Result& s = rh.filesize[m];
+        s.marker = population;
+        s.nanosecs = (double) SerializeFileSize();
+    }
+
+    remove(SERIALIZE_PATH);
+    MAP_CLEAR();
+    MAP_CLEAR_WAIT();
+
+    rh.dump();
+};
@@ -39,13 +39,8 @@ namespace RDTSC_Timer
         frequency = (endTsc - startTsc) * 10;
         ticksToNanosecs = 1000000000.0 / frequency;
 
-        __asm
-        {
-            mov eax, 0
-            cpuid
-            mov eax, 0
-            cpuid
-        }
+        Serialize();
+        Serialize();
         // Take the median average of a bunch of CPUID timings and consider that the overhead.
         // Pretty sure I've seen a few magic fast CPUIDs, and a few slow ones.
         // Median average seems to produce the most consistent overhead measurement between runs.
@@ -53,11 +48,7 @@ namespace RDTSC_Timer
         for (int i = 0; i < 128; i++)
         {
             startTsc = __rdtsc();
-            __asm
-            {
-                mov eax, 0
-                cpuid
-            }
+            Serialize();
             endTsc = __rdtsc();
             timings[i] = endTsc - startTsc;
         }
@@ -28,13 +28,18 @@ namespace RDTSC_Timer
 
     void Initialize();
 
+    // CPUID waits for every earlier instruction to retire, so RDTSC can't read the counter early.
+    // Intrinsics instead of inline assembly, which x64 builds don't support.
+    inline void Serialize()
+    {
+        int cpuInfo[4];
+        __cpuid(cpuInfo, 0);
+        _mm_lfence();
+    }
+
     inline Tick Sample()
     {
-        __asm
-        {
-            mov eax, 0
-            cpuid
-        }
+        Serialize();
         return __rdtsc();
     }
 }
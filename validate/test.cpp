@@ -1,3 +1,4 @@
+#include <config.h>
 #include "../hashtable.h"
 #include <stdio.h>
 #include <string.h>
@@ -50,6 +51,24 @@ int main(int argc, const char* argv[])
         {
             ht.Compact();
         }
+        else if (strcmp(command, "probe") == 0)
+        {
+            // Print the lengths of the runs of cells a lookup of key reads, as a Python list
+            sscanf(strtok(NULL, whitespace), "%u", &key);
+            const HashTable::Cell* runs[2];
+            size_t runLengths[2];
+            int count = ht.GetProbeRuns(key, runs, runLengths);
+            printf("[");
+            for (int i = 0; i < count; i++)
+                printf("%u, ", (unsigned int) runLengths[i]);
+            printf("]\n");
+        }
+        else if (strcmp(command, "reserve") == 0)
+        {
+            unsigned int population;
+            sscanf(strtok(NULL, whitespace), "%u", &population);
+            ht.Reserve(population);
+        }
         fflush(stdout);
     }
 
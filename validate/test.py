@@ -19,6 +19,11 @@ class HashTableWrapper:
         self.p.stdin.write('clear\n')
     def compact(self):
         self.p.stdin.write('compact\n')
+    def reserve(self, population):
+        self.p.stdin.write('reserve %d\n' % population)
+    def probeRuns(self, key):
+        self.p.stdin.write('probe %d\n' % key)
+        return eval(self.p.stdout.readline())
     def run(self, test, *args):
         r = test(self, *args)
         self.p.stdin.close()
@@ -40,6 +45,8 @@ class DictionaryWrapper:
         self.d.clear()
     def compact(self):
         pass
+    def reserve(self, population):
+        pass
     def run(self, test, *args):
         return test(self, *args), self.d
 
@@ -70,6 +77,75 @@ def RandomizedTest(w, seed, keys, loops):
             w.compact()
     return r
 
+def ReserveTest(w, seed, keys, loops):
+    # Reserve room for more or fewer keys than are there, then fill it up, so that inserts land in
+    # arrays of every size Reserve picks, including ones a resize would never have made
+    random.seed(seed + 2)
+    r = []
+    for i in xrange(loops):
+        w.reserve(random.randint(0, len(keys) * 2))
+        for key in random.sample(keys, random.randint(0, len(keys))):
+            w[key] = random.randint(0, 0xffffffff)
+        for j in xrange(random.randint(0, len(keys))):
+            del w[random.choice(keys)]
+        for key in keys:
+            r.append(w[key])
+        if random.randint(0, 3) == 0:
+            w.clear()
+    return r
+
+def SpreadTest(pathToExe, seed):
+    # Every hash must mix keys into the top bits of the word, which pick the cell. One which left
+    # them zero, like CRC32C without its shift in 64-bit builds, would still find every key, but
+    # only by probing from the same cell.
+    random.seed(seed + 3)
+    keys = random.sample(xrange(1, 0x100000000), 1000)
+    w = HashTableWrapper(pathToExe)
+    for key in keys:
+        w[key] = key
+    probed = sum(sum(w.probeRuns(key)) for key in keys)
+    w.run(lambda w: None)
+    assert probed < len(keys) * 16, 'keys are bunched up: %d cells probed to find %d keys' % (probed, len(keys))
+
+def FindWrappingKeySets(pathToExe, seed, count, population):
+    # Reserving room for population keys sizes the array so that they fit without it growing. Look
+    # for sets of that many keys in which some key's probe wraps past the end of the array.
+    random.seed(seed + 4)
+    w = HashTableWrapper(pathToExe)
+    w.reserve(population)
+    found = []
+    for attempt in xrange(2000):
+        keys = random.sample(xrange(1, 0x100000000), population)
+        for key in keys:
+            w[key] = key
+        if any(len(w.probeRuns(key)) == 2 for key in keys):
+            found.append(keys)
+            if len(found) == count:
+                break
+        w.clear()
+    w.run(lambda w: None)
+    assert len(found) == count, 'found only %d sets of wrapping keys' % len(found)
+    return found
+
+def WrapTest(w, seed, keySets, loops):
+    # Deleting a key before the end of the array has to pull wrapped keys back across it
+    random.seed(seed + 5)
+    r = []
+    for keys in keySets:
+        w.clear()
+        w.reserve(len(keys))
+        for key in keys:
+            w[key] = key
+        for i in xrange(loops):
+            key = random.choice(keys)
+            if random.randint(0, 1) == 0:
+                del w[key]
+            else:
+                w[key] = random.randint(0, 0xffffffff)
+            for key in keys:
+                r.append(w[key])
+    return r
+
 if __name__ == '__main__':
     pathToExe = sys.argv[1]
     seed = int(sys.argv[2])
@@ -85,7 +161,14 @@ if __name__ == '__main__':
         [0] + [random.randint(1, 0xffffffff) for i in xrange(100)],
         [random.randint(0, 0xffffffff) for i in xrange(200)],
     ]
-    for keys in keySets:
-        r1 = HashTableWrapper(pathToExe).run(RandomizedTest, seed, keys, 4)
-        r2 = DictionaryWrapper().run(RandomizedTest, seed, keys, 4)
+    for test in [RandomizedTest, ReserveTest]:
+        for keys in keySets:
+            r1 = HashTableWrapper(pathToExe).run(test, seed, keys, 4)
+            r2 = DictionaryWrapper().run(test, seed, keys, 4)
+            assert r1 == r2
+    SpreadTest(pathToExe, seed)
+    for population in [5, 11]:
+        wrapping = FindWrappingKeySets(pathToExe, seed, 10, population)
+        r1 = HashTableWrapper(pathToExe).run(WrapTest, seed, wrapping, 20)
+        r2 = DictionaryWrapper().run(WrapTest, seed, wrapping, 20)
         assert r1 == r2
@@ -0,0 +1,206 @@
+#include <config.h>
+#include "../cuckoohashtable.h"
+#include "../mersennetwister.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+
+
+//----------------------------------------------
+//  Runs random inserts, increments, lookups, Clear() and Compact() on CuckooHashTables, and
+//  after every step that changes one, checks it against a std::map: every key must be found
+//  with its value, the population must match, and the Iterator must visit each key exactly once.
+//  Key ranges go from a few dozen keys, so that most keys come back, to the full word, and the
+//  tables fill far enough to shift keys along long paths and to fail inserts, which grows them,
+//  sometimes through rehashes which have to retry.
+//  Usage: ValidateCuckooHashTable <seed>. Prints the first mismatch and returns 1, or returns 0.
+//----------------------------------------------
+static MersenneTwister g_random;
+
+typedef std::map<size_t, size_t> Reference;
+
+static size_t RandomKey(size_t range)
+{
+    size_t key = g_random.integer();
+    if (sizeof(size_t) > 4)
+        key = (key << 16 << 16) | g_random.integer();
+    return range ? key % range : key;
+}
+
+static bool Check(CuckooHashTable& table, const Reference& reference, const char* context)
+{
+    for (Reference::const_iterator it = reference.begin(); it != reference.end(); ++it)
+    {
+        CuckooHashTable::Cell* cell = table.Lookup(it->first);
+        if (!cell || cell->key != it->first || cell->value != it->second)
+        {
+            printf("%s: key %llx has %s, expected %llx\n", context, (unsigned long long) it->first,
+                cell ? "the wrong value" : "gone missing", (unsigned long long) it->second);
+            return false;
+        }
+    }
+
+    CuckooHashTable::Stats stats;
+    table.GetStats(stats);
+    if (stats.population != reference.size())
+    {
+        printf("%s: population is %llu, expected %llu\n", context, (unsigned long long) stats.population, (unsigned long long) reference.size());
+        return false;
+    }
+
+    size_t visited = 0;
+    for (CuckooHashTable::Iterator it(table); *it; it.Next())
+    {
+        Reference::const_iterator found = reference.find(it->key);
+        if (found == reference.end() || found->second != it->value)
+        {
+            printf("%s: iterator visited key %llx, which isn't in the map with that value\n", context, (unsigned long long) it->key);
+            return false;
+        }
+        visited++;
+    }
+    if (visited != reference.size())
+    {
+        printf("%s: iterator visited %llu cells, expected %llu\n", context, (unsigned long long) visited, (unsigned long long) reference.size());
+        return false;
+    }
+    return true;
+}
+
+static bool RunTable(size_t range, int initialBuckets, int steps, CuckooHashTable::Stats& totals)
+{
+    char context[64];
+    sprintf(context, "range %llx, step", (unsigned long long) range);
+    char* stepText = context + strlen(context);
+
+    CuckooHashTable table(initialBuckets);
+    Reference reference;
+    bool ok = true;
+    for (int s = 0; s < steps && ok; s++)
+    {
+        sprintf(stepText, " %d", s);
+        unsigned int r = g_random.integer() % 10000;
+        size_t key = RandomKey(range);
+        if (r < 7000)
+        {
+            // Insert, which may shift keys or grow the table
+            size_t value = RandomKey(0);
+            table.Insert(key)->value = value;
+            reference[key] = value;
+        }
+        else if (r < 8500)
+        {
+            table.Insert(key)->value++;
+            reference[key]++;
+        }
+        else if (r < 9990)
+        {
+            // Look up a key which may or may not be there
+            CuckooHashTable::Cell* cell = table.Lookup(key);
+            Reference::const_iterator found = reference.find(key);
+            if ((cell != NULL) != (found != reference.end()) || (cell && cell->value != found->second))
+            {
+                printf("%s: lookup of %llx disagrees with the map\n", context, (unsigned long long) key);
+                return false;
+            }
+            continue;
+        }
+        else if (r < 9998)
+        {
+            table.Compact();
+        }
+        else
+        {
+            table.Clear();
+            reference.clear();
+            if (g_random.integer() % 2)
+                table.Compact();
+        }
+        // Checking everything after every step would be quadratic; check often while small, then every so often
+        if (reference.size() < 64 || s % 512 == 0)
+            ok = Check(table, reference, context);
+    }
+    if (ok)
+    {
+        strcpy(stepText, " end");
+        ok = Check(table, reference, context);
+        table.Compact();
+        strcpy(stepText, " end, compacted");
+        ok = ok && Check(table, reference, context);
+    }
+
+    CuckooHashTable::Stats stats;
+    table.GetStats(stats);
+    totals.insertFailures += stats.insertFailures;
+    totals.rehashes += stats.rehashes;
+    totals.displacements += stats.displacements;
+    return ok;
+}
+
+// Compacts many small tables. With only a few buckets, the keys often don't fit in the size Compact()
+// picks, so Repopulate has to give up on that size and retry with twice as many buckets.
+static bool CompactSmallTables(int tables, CuckooHashTable::Stats& totals)
+{
+    for (int t = 0; t < tables; t++)
+    {
+        char context[64];
+        sprintf(context, "small table %d", t);
+        CuckooHashTable table(1);
+        Reference reference;
+        int population = 1 + g_random.integer() % 24;
+        for (int i = 0; i < population; i++)
+        {
+            size_t key = RandomKey(0);
+            table.Insert(key)->value = i;
+            reference[key] = i;
+        }
+        CuckooHashTable::Stats before;
+        table.GetStats(before);
+        table.Compact();
+        if (!Check(table, reference, context))
+            return false;
+
+        CuckooHashTable::Stats stats;
+        table.GetStats(stats);
+        totals.insertFailures += stats.insertFailures;
+        totals.rehashes += stats.rehashes - before.rehashes - 1;   // Only the retries
+        totals.displacements += stats.displacements;
+    }
+    return true;
+}
+
+int main(int argc, const char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: ValidateCuckooHashTable <seed>\n");
+        return 2;
+    }
+    g_random.reseed(atoi(argv[1]));
+
+    // 0 is the full word
+    static const size_t ranges[] = { 40, 1000, 30000, 1000000, 0 };
+    static const int initialBuckets[] = { 1, 2, 64 };
+    CuckooHashTable::Stats totals = {};
+    if (!CompactSmallTables(20000, totals))
+        return 1;
+    size_t retries = totals.rehashes;
+    for (int r = 0; r < sizeof(ranges) / sizeof(ranges[0]); r++)
+    {
+        for (int b = 0; b < sizeof(initialBuckets) / sizeof(initialBuckets[0]); b++)
+        {
+            if (!RunTable(ranges[r], initialBuckets[b], 40000, totals))
+                return 1;
+        }
+    }
+
+    // Make sure the tricky paths actually ran
+    if (!totals.displacements || !totals.insertFailures || !retries)
+    {
+        printf("%llu keys displaced, %llu inserts failed, %llu rehashes retried; the test needs fuller tables\n",
+            (unsigned long long) totals.displacements, (unsigned long long) totals.insertFailures, (unsigned long long) retries);
+        return 1;
+    }
+    return 0;
+}
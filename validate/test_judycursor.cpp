@@ -0,0 +1,135 @@
+#include <config.h>
+#include <Judy.h>
+#include "../mersennetwister.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+
+//----------------------------------------------
+//  Walks random JudyL arrays with a JudyLCursor_t, stepping forward and backward and inserting and
+//  deleting keys along the way, and checks that every step returns the same Index and value slot
+//  as JudyLNext or JudyLPrev from the same place. The arrays range from a handful of keys in a
+//  root leaf to enough keys, spread over enough bits, to need branches of every kind.
+//  Usage: ValidateJudyCursor <seed>. Prints the first mismatch and returns 1, or returns 0.
+//----------------------------------------------
+static MersenneTwister g_random;
+
+static Word_t RandomKey(int bits)
+{
+    Word_t key = g_random.integer();
+    if (sizeof(Word_t) > 4)
+        key = (key << 16 << 16) | g_random.integer();
+    return bits < (int) sizeof(Word_t) * 8 ? key & (((Word_t) 1 << bits) - 1) : key;
+}
+
+static void Insert(Pvoid_t& judy, Word_t key)
+{
+    PPvoid_t value = JudyLIns(&judy, key, PJE0);
+    *(Word_t*) value = key ^ 0x5a5a5a5a;
+}
+
+// Takes one step with the cursor and the same step without it, and compares them
+static bool Step(JudyLCursor_t& cursor, Pvoid_t judy, Word_t& index, bool& valid, bool forward, const char* context)
+{
+    Word_t expectedIndex = index;
+    Word_t cursorIndex = index;
+    PPvoid_t expected;
+    PPvoid_t actual;
+    if (forward)
+    {
+        expected = valid ? JudyLNext(judy, &expectedIndex, PJE0) : JudyLFirst(judy, &(expectedIndex = 0), PJE0);
+        actual = valid ? JudyLCursorNext(&cursor, judy, &cursorIndex, PJE0) : JudyLCursorFirst(&cursor, judy, &(cursorIndex = 0), PJE0);
+    }
+    else
+    {
+        expected = valid ? JudyLPrev(judy, &expectedIndex, PJE0) : JudyLLast(judy, &(expectedIndex = ~(Word_t) 0), PJE0);
+        actual = valid ? JudyLCursorPrev(&cursor, judy, &cursorIndex, PJE0) : JudyLCursorLast(&cursor, judy, &(cursorIndex = ~(Word_t) 0), PJE0);
+    }
+    if (actual != expected || (expected && cursorIndex != expectedIndex))
+    {
+        printf("%s: %s from %llx returned %p at %llx, expected %p at %llx\n",
+            context, forward ? "next" : "prev", (unsigned long long) index,
+            (void*) actual, (unsigned long long) cursorIndex, (void*) expected, (unsigned long long) expectedIndex);
+        return false;
+    }
+    if (expected && *(Word_t*) expected != (expectedIndex ^ 0x5a5a5a5a))
+    {
+        printf("%s: value at %llx is wrong\n", context, (unsigned long long) expectedIndex);
+        return false;
+    }
+    // Running off either end starts the next step over from the other end
+    valid = expected != NULL;
+    if (valid)
+        index = expectedIndex;
+    return true;
+}
+
+static bool WalkArray(int bits, int population, int steps)
+{
+    char context[64];
+    sprintf(context, "%d keys of %d bits", population, bits);
+
+    Pvoid_t judy = NULL;
+    Word_t* keys = new Word_t[population];
+    for (int i = 0; i < population; i++)
+    {
+        keys[i] = RandomKey(bits);
+        Insert(judy, keys[i]);
+    }
+
+    JudyLCursor_t cursor;
+    JudyLCursorInit(&cursor);
+    Word_t index = 0;
+    bool valid = false;
+    bool forward = true;
+    bool ok = true;
+    for (int s = 0; s < steps && ok; s++)
+    {
+        unsigned int r = g_random.integer() % 64;
+        if (r == 0)
+            forward = !forward;
+        else if (r == 1)
+            Insert(judy, RandomKey(bits));
+        else if (r == 2)
+            JudyLDel(&judy, keys[g_random.integer() % population], PJE0);
+        else if (r == 3 && valid)
+            JudyLDel(&judy, index, PJE0);   // Delete the Index the cursor is on
+        else if (r == 4 && valid)
+            Insert(judy, index + (forward ? 1 : -1));   // Insert right next to it
+        else if (r == 5)
+        {
+            // Jump somewhere the cursor hasn't been
+            index = RandomKey(bits);
+            valid = true;
+        }
+        ok = Step(cursor, judy, index, valid, forward, context);
+    }
+
+    JudyLFreeArray(&judy, PJE0);
+    delete[] keys;
+    return ok;
+}
+
+int main(int argc, const char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: ValidateJudyCursor <seed>\n");
+        return 2;
+    }
+    g_random.reseed(atoi(argv[1]));
+
+    static const int populations[] = { 1, 3, 10, 40, 300, 3000, 30000 };
+    int bitsList[] = { 8, 16, 24, 32, 48, (int) sizeof(Word_t) * 8 };
+    for (int b = 0; b < sizeof(bitsList) / sizeof(bitsList[0]); b++)
+    {
+        if (bitsList[b] > (int) sizeof(Word_t) * 8)
+            continue;
+        for (int p = 0; p < sizeof(populations) / sizeof(populations[0]); p++)
+        {
+            if (!WalkArray(bitsList[b], populations[p], 20000))
+                return 1;
+        }
+    }
+    return 0;
+}
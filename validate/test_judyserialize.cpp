@@ -0,0 +1,232 @@
+#include <config.h>
+#include <Judy.h>
+#include "../mersennetwister.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <vector>
+
+
+//----------------------------------------------
+//  Saves random JudyL arrays with JudyLSave, loads them back with JudyLLoad, and checks that the
+//  loaded array holds exactly the same Indexes and values, and saves to the same bytes. Keys are
+//  1 to 64 bits wide, so the deltas range from a single byte to a full-width varint, and populations
+//  go from empty through every size up to a few hundred, which JudyLInsArray builds into leaves of
+//  every fill, to hundreds of thousands. The loads read the stream in random-sized pieces. Streams
+//  cut short, with a byte too many, or saved through a Write that fails, must be rejected.
+//  Usage: ValidateJudySerialize <seed>. Prints the first mismatch and returns 1, or returns 0.
+//----------------------------------------------
+static MersenneTwister g_random;
+
+typedef std::map<Word_t, Word_t> Reference;
+
+static Word_t RandomWord(int bits)
+{
+    Word_t word = g_random.integer();
+    if (sizeof(Word_t) > 4)
+        word = (word << 16 << 16) | g_random.integer();
+    return bits < (int) sizeof(Word_t) * 8 ? word & (((Word_t) 1 << bits) - 1) : word;
+}
+
+// Write accepts everything, until limit bytes have been written
+struct WriteStream
+{
+    std::vector<unsigned char> bytes;
+    size_t limit;
+};
+
+static Word_t Write(const void* buf, Word_t bytes, void* context)
+{
+    WriteStream* stream = (WriteStream*) context;
+    if (stream->bytes.size() + bytes > stream->limit)
+        bytes = stream->limit - stream->bytes.size();
+    stream->bytes.insert(stream->bytes.end(), (const unsigned char*) buf, (const unsigned char*) buf + bytes);
+    return bytes;
+}
+
+// Read returns a random number of bytes each time, up to end
+struct ReadStream
+{
+    const unsigned char* pos;
+    const unsigned char* end;
+};
+
+static Word_t Read(void* buf, Word_t bytes, void* context)
+{
+    ReadStream* stream = (ReadStream*) context;
+    Word_t available = (Word_t) (stream->end - stream->pos);
+    Word_t count = 1 + g_random.integer() % bytes;
+    if (count > available)
+        count = available;
+    if (count == 0)
+        return 0;
+    memcpy(buf, stream->pos, count);
+    stream->pos += count;
+    return count;
+}
+
+static Word_t Load(Pvoid_t* judy, const unsigned char* bytes, size_t size, JError_t* error)
+{
+    ReadStream stream = { bytes, bytes + size };
+    return JudyLLoad(judy, Read, &stream, error);
+}
+
+static bool Matches(Pvoid_t judy, const Reference& reference, const char* context)
+{
+    Word_t index = 0;
+    PPvoid_t value = JudyLFirst(judy, &index, PJE0);
+    for (Reference::const_iterator it = reference.begin(); it != reference.end(); ++it)
+    {
+        if (!value || index != it->first || *(Word_t*) value != it->second)
+        {
+            printf("%s: expected %llx = %llx, loaded %s%llx\n", context, (unsigned long long) it->first, (unsigned long long) it->second,
+                value ? "" : "nothing after ", (unsigned long long) index);
+            return false;
+        }
+        value = JudyLNext(judy, &index, PJE0);
+    }
+    if (value)
+    {
+        printf("%s: loaded an extra Index %llx\n", context, (unsigned long long) index);
+        return false;
+    }
+    return true;
+}
+
+static bool RoundTrip(int bits, size_t population, int valueBits)
+{
+    char context[96];
+    sprintf(context, "%llu keys of %d bits, values of %d bits", (unsigned long long) population, bits, valueBits);
+
+    Pvoid_t judy = NULL;
+    Reference reference;
+    for (size_t i = 0; i < population; i++)
+    {
+        Word_t key = RandomWord(bits);
+        Word_t value = RandomWord(valueBits);
+        *(Word_t*) JudyLIns(&judy, key, PJE0) = value;
+        reference[key] = value;
+    }
+
+    WriteStream saved;
+    saved.limit = (size_t) -1;
+    Word_t written = JudyLSave(judy, Write, &saved, PJE0);
+    bool ok = true;
+    if (written != saved.bytes.size() || saved.bytes.size() < 7 || memcmp(&saved.bytes[0], "JLSV", 4) != 0)
+    {
+        printf("%s: JudyLSave returned %lld for %llu bytes\n", context, (long long) written, (unsigned long long) saved.bytes.size());
+        ok = false;
+    }
+
+    // Load, and save again
+    Pvoid_t loaded = NULL;
+    if (ok)
+    {
+        JError_t error;
+        Word_t count = Load(&loaded, &saved.bytes[0], saved.bytes.size(), &error);
+        if (count != reference.size())
+        {
+            printf("%s: JudyLLoad returned %lld, error %d\n", context, (long long) count, count == JERR ? (int) JU_ERRNO(&error) : 0);
+            ok = false;
+        }
+    }
+    ok = ok && Matches(loaded, reference, context);
+    if (ok)
+    {
+        WriteStream resaved;
+        resaved.limit = (size_t) -1;
+        JudyLSave(loaded, Write, &resaved, PJE0);
+        if (resaved.bytes != saved.bytes)
+        {
+            printf("%s: saving the loaded array wrote different bytes\n", context);
+            ok = false;
+        }
+    }
+
+    // Loading into a non-empty array is refused
+    if (ok && loaded)
+    {
+        JError_t error;
+        Pvoid_t before = loaded;
+        if (Load(&loaded, &saved.bytes[0], saved.bytes.size(), &error) != JERR || JU_ERRNO(&error) != JU_ERRNO_NONNULLPARRAY || loaded != before)
+        {
+            printf("%s: loaded into a non-empty array\n", context);
+            ok = false;
+        }
+    }
+
+    // Streams cut short anywhere, or with a byte too many, are bad
+    for (int t = 0; t < 4 && ok; t++)
+    {
+        size_t size = saved.bytes.size();
+        size_t cut = t == 0 ? size - 1 : t == 1 ? g_random.integer() % 7 : g_random.integer() % size;
+        std::vector<unsigned char> bytes(saved.bytes.begin(), saved.bytes.begin() + cut);
+        if (t == 3)
+        {
+            bytes = saved.bytes;
+            bytes.push_back((unsigned char) g_random.integer());
+        }
+        JError_t error;
+        Pvoid_t bad = NULL;
+        Word_t count = Load(&bad, bytes.empty() ? NULL : &bytes[0], bytes.size(), &error);
+        if (count != JERR || JU_ERRNO(&error) != JU_ERRNO_BADSTREAM || bad)
+        {
+            printf("%s: a stream of %llu of the %llu bytes loaded, returning %lld\n", context,
+                (unsigned long long) bytes.size(), (unsigned long long) size, (long long) count);
+            ok = false;
+        }
+        JudyLFreeArray(&bad, PJE0);
+    }
+
+    // A Write which stops accepting bytes fails the save
+    if (ok)
+    {
+        WriteStream failing;
+        failing.limit = g_random.integer() % saved.bytes.size();
+        JError_t error;
+        if (JudyLSave(judy, Write, &failing, &error) != JERR || JU_ERRNO(&error) != JU_ERRNO_IO)
+        {
+            printf("%s: JudyLSave succeeded after its Write failed\n", context);
+            ok = false;
+        }
+    }
+
+    JudyLFreeArray(&judy, PJE0);
+    JudyLFreeArray(&loaded, PJE0);
+    return ok;
+}
+
+int main(int argc, const char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: ValidateJudySerialize <seed>\n");
+        return 2;
+    }
+    g_random.reseed(atoi(argv[1]));
+    const int wordBits = (int) sizeof(Word_t) * 8;
+
+    // Every population up to a few hundred, with dense keys and with sparse ones
+    for (size_t population = 0; population <= 400; population++)
+    {
+        if (!RoundTrip(10, population, 8) || !RoundTrip(wordBits, population, wordBits))
+            return 1;
+    }
+
+    // Every key width, at a few sizes
+    static const size_t populations[] = { 1, 2, 31, 1000, 20000 };
+    for (int bits = 1; bits <= wordBits; bits++)
+    {
+        for (int p = 0; p < sizeof(populations) / sizeof(populations[0]); p++)
+        {
+            if (!RoundTrip(bits, populations[p], 1 + g_random.integer() % wordBits))
+                return 1;
+        }
+    }
+
+    // Large arrays, which take many buffers to save and load
+    if (!RoundTrip(24, 300000, 4) || !RoundTrip(wordBits, 200000, wordBits))
+        return 1;
+    return 0;
+}
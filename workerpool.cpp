@@ -0,0 +1,88 @@
+#include <config.h>
+#include <windows.h>
+#include "workerpool.h"
+#include <assert.h>
+
+
+//----------------------------------------------
+//  WorkerPool::WorkerPool
+//----------------------------------------------
+WorkerPool::WorkerPool(int threadCount)
+{
+    assert(threadCount >= 1);
+    m_threadCount = threadCount;
+    m_doneEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+    m_job = NULL;
+    m_arg = NULL;
+    m_pending = 0;
+    m_quit = 0;
+
+    // Worker 0 is the calling thread, so it has no thread or event of its own
+    m_workers = new Worker[threadCount];
+    for (int i = 1; i < threadCount; i++)
+    {
+        Worker& w = m_workers[i];
+        w.pool = this;
+        w.index = i;
+        w.startEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+        w.thread = CreateThread(NULL, 0, WorkerMain, &w, 0, NULL);
+    }
+}
+
+//----------------------------------------------
+//  WorkerPool::~WorkerPool
+//----------------------------------------------
+WorkerPool::~WorkerPool()
+{
+    InterlockedExchange(&m_quit, 1);
+    for (int i = 1; i < m_threadCount; i++)
+        SetEvent(m_workers[i].startEvent);
+    for (int i = 1; i < m_threadCount; i++)
+    {
+        WaitForSingleObject(m_workers[i].thread, INFINITE);
+        CloseHandle(m_workers[i].thread);
+        CloseHandle(m_workers[i].startEvent);
+    }
+    CloseHandle(m_doneEvent);
+    delete[] m_workers;
+}
+
+//----------------------------------------------
+//  WorkerPool::WorkerMain
+//----------------------------------------------
+DWORD WINAPI WorkerPool::WorkerMain(LPVOID param)
+{
+    Worker* w = (Worker*) param;
+    WorkerPool* pool = w->pool;
+    for (;;)
+    {
+        WaitForSingleObject(w->startEvent, INFINITE);
+        if (pool->m_quit)
+            return 0;
+        pool->m_job(w->index, pool->m_threadCount, pool->m_arg);
+
+        // The last worker to finish wakes the calling thread
+        if (InterlockedDecrement(&pool->m_pending) == 0)
+            SetEvent(pool->m_doneEvent);
+    }
+}
+
+//----------------------------------------------
+//  WorkerPool::Run
+//----------------------------------------------
+void WorkerPool::Run(Job job, void* arg)
+{
+    m_job = job;
+    m_arg = arg;
+    if (m_threadCount > 1)
+    {
+        m_pending = m_threadCount - 1;
+        for (int i = 1; i < m_threadCount; i++)
+            SetEvent(m_workers[i].startEvent);
+    }
+
+    job(0, m_threadCount, arg);
+
+    if (m_threadCount > 1)
+        WaitForSingleObject(m_doneEvent, INFINITE);
+}
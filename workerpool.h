@@ -0,0 +1,42 @@
+#pragma once
+
+
+//----------------------------------------------
+//  WorkerPool
+//
+//  Runs a job on a fixed number of threads at once: the calling thread plus threadCount - 1
+//  workers. The workers are created once and sleep on an event between jobs, so that
+//  experiments can time many short jobs without paying for thread creation each time.
+//  Each thread is passed its index, 0 being the calling thread, so the job can divide up the work.
+//----------------------------------------------
+class WorkerPool
+{
+public:
+    typedef void (*Job)(int thread, int threadCount, void* arg);
+
+private:
+    struct Worker
+    {
+        WorkerPool* pool;
+        int index;
+        HANDLE thread;
+        HANDLE startEvent;
+    };
+
+    int m_threadCount;
+    Worker* m_workers;
+    HANDLE m_doneEvent;
+    Job m_job;
+    void* m_arg;
+    volatile LONG m_pending;
+    volatile LONG m_quit;
+
+    static DWORD WINAPI WorkerMain(LPVOID param);
+
+public:
+    WorkerPool(int threadCount);
+    ~WorkerPool();
+
+    int ThreadCount() const { return m_threadCount; }
+    void Run(Job job, void* arg);
+};
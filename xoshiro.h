@@ -0,0 +1,64 @@
+#pragma once
+
+#include <math.h>
+
+
+//-------------------------------------
+//  Xoshiro256
+//  xoshiro256++, by Blackman and Vigna. Four words of state, and a few
+//  shifts, rotates and adds per number, with no buffer to regenerate,
+//  so every call takes the same short time. Seeded through SplitMix64,
+//  as its authors recommend.
+//-------------------------------------
+class Xoshiro256
+{
+    unsigned long long m_state[4];
+
+    static unsigned long long rotl(unsigned long long x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+    Xoshiro256(unsigned int seed = 0)
+    {
+        reseed(seed);
+    }
+
+    void reseed(unsigned int seed)
+    {
+        unsigned long long x = seed;
+        for (int i = 0; i < 4; i++)
+        {
+            unsigned long long z = (x += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            m_state[i] = z ^ (z >> 31);
+        }
+    }
+
+    unsigned long long next64()
+    {
+        unsigned long long* s = m_state;
+        unsigned long long result = rotl(s[0] + s[3], 23) + s[0];
+        unsigned long long t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    unsigned int integer()
+    {
+        // The high bits are the strongest
+        return (unsigned int) (next64() >> 32);
+    }
+
+    float expoVariate(float ooRateParameter)
+    {
+        return -logf(1.0f - integer() / 4294967296.0f) * ooRateParameter;
+    }
+};